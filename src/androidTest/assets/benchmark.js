@@ -0,0 +1,2 @@
+// main script of the engine used by the instrumentation tests and benchmarks; they set up everything else with runScript
+module.exports = {};
@@ -0,0 +1,101 @@
+/**
+ * JNIEnvBenchmark
+ * Measures JNIWrapper::getEnvironment on several threads at once.
+ * Only built when the CMake option BGJS_BENCHMARKS is enabled; used by the instrumentation benchmarks.
+ */
+
+#include <jni.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+#include "../../main/cpp/jni/JNIWrapper.h"
+
+namespace {
+    struct BenchmarkRun {
+        std::atomic<int> threads;
+        int iterations;
+        std::atomic<int> attached;
+        std::atomic<uintptr_t> sink;
+    };
+
+    struct ThreadResult {
+        BenchmarkRun *run;
+        int64_t durationNs;
+    };
+
+    int64_t now() {
+        timespec time;
+        clock_gettime(CLOCK_MONOTONIC, &time);
+        return (int64_t)time.tv_sec * 1000000000LL + time.tv_nsec;
+    }
+
+    void* measureThread(void *data) {
+        ThreadResult *result = (ThreadResult*)data;
+        BenchmarkRun *run = result->run;
+
+        // the first call attaches the thread; that is not part of the measurement
+        JNIWrapper::getEnvironment();
+        run->attached++;
+        while(run->attached.load() < run->threads) {
+            sched_yield();
+        }
+
+        uintptr_t sink = 0;
+        const int64_t start = now();
+        for(int i = 0; i < run->iterations; i++) {
+            sink ^= (uintptr_t)JNIWrapper::getEnvironment();
+        }
+        result->durationNs = now() - start;
+        run->sink ^= sink;
+
+        // the thread is detached by JNIWrapper when it exits
+        return nullptr;
+    }
+}
+
+extern "C" {
+
+/**
+ * calls getEnvironment iterations times on each of the given number of new native threads, all running at once
+ * @return the average duration of one call in nanoseconds
+ */
+JNIEXPORT jdouble JNICALL Java_ag_boersego_bgjs_JNIEnvBenchmark_measureGetEnvironment(JNIEnv *env, jclass clazz,
+                                                                                       jint threads, jint iterations) {
+    BenchmarkRun run;
+    run.threads = threads;
+    run.iterations = iterations;
+    run.attached = 0;
+    run.sink = 0;
+
+    std::vector<ThreadResult> results((size_t)threads, ThreadResult{&run, 0});
+    std::vector<pthread_t> handles((size_t)threads);
+    int started = 0;
+    for(; started < threads; started++) {
+        if(pthread_create(&handles[started], nullptr, measureThread, &results[started]) != 0) {
+            break;
+        }
+    }
+    if(started < threads) {
+        // let the threads that did start finish their barrier, then report the failure
+        run.threads = started;
+    }
+    for(int i = 0; i < started; i++) {
+        pthread_join(handles[i], nullptr);
+    }
+    if(started < threads) {
+        env->ThrowNew(env->FindClass("java/lang/IllegalStateException"), "Failed to start benchmark threads");
+        return 0;
+    }
+
+    int64_t totalNs = 0;
+    for(const ThreadResult &result : results) {
+        totalNs += result.durationNs;
+    }
+    return (jdouble)totalNs / ((jdouble)threads * iterations);
+}
+
+}
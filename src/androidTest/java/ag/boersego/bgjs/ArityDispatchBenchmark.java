@@ -0,0 +1,54 @@
+package ag.boersego.bgjs;
+
+import android.support.test.runner.AndroidJUnit4;
+
+import org.junit.Before;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+/**
+ * Measures the overhead of calling annotated java methods from javascript: overloads of 0, 1, 2 and 4 arguments
+ * that are picked by arity, a method with object arguments and a generic Object[] method.
+ * The loop runs in javascript, so each iteration is one javascript to java call plus the loop itself.
+ */
+@RunWith(AndroidJUnit4.class)
+public class ArityDispatchBenchmark {
+    private static final int CALLS = 100000;
+
+    private static boolean sRegistered;
+
+    private V8Engine engine;
+    private ArityDispatchTarget target;
+
+    @Before
+    public void setUp() throws Exception {
+        engine = TestEngine.get();
+        synchronized (ArityDispatchBenchmark.class) {
+            if (!sRegistered) {
+                JNIV8Object.RegisterV8Class(ArityDispatchTarget.class);
+                sRegistered = true;
+            }
+        }
+        target = new ArityDispatchTarget(engine);
+    }
+
+    @Test
+    public void callOverhead() {
+        measure("add()", "t.add()");
+        measure("add(a)", "t.add(1)");
+        measure("add(a, b)", "t.add(1, 2)");
+        measure("add(a, b, c, d)", "t.add(1, 2, 3, 4)");
+        measure("concat(a, b)", "t.concat('a', 'b')");
+        measure("generic(a, b)", "t.generic(1, 'b')");
+    }
+
+    private void measure(final String name, final String call) {
+        final JNIV8Function loop = (JNIV8Function) engine.runScript(
+                "(function(t, count) { for (var i = 0; i < count; i++) { " + call + "; } })", "arityDispatchBenchmark");
+        // warm up
+        loop.callAsV8Function(target, CALLS / 10);
+        final long start = System.nanoTime();
+        loop.callAsV8Function(target, CALLS);
+        Benchmark.report("call " + name, (System.nanoTime() - start) / (double) CALLS, CALLS);
+    }
+}
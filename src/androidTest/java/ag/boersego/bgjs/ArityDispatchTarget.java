@@ -0,0 +1,45 @@
+package ag.boersego.bgjs;
+
+import ag.boersego.v8annotations.V8Class;
+import ag.boersego.v8annotations.V8ClassCreationPolicy;
+import ag.boersego.v8annotations.V8Function;
+
+/**
+ * Exposes overloads of different arity and a generic method; see ArityDispatchBenchmark
+ */
+@V8Class(creationPolicy = V8ClassCreationPolicy.JAVA_ONLY)
+public class ArityDispatchTarget extends JNIV8Object {
+    public ArityDispatchTarget(V8Engine engine) {
+        super(engine);
+    }
+
+    @V8Function
+    public double add() {
+        return 0;
+    }
+
+    @V8Function
+    public double add(double a) {
+        return a;
+    }
+
+    @V8Function
+    public double add(double a, double b) {
+        return a + b;
+    }
+
+    @V8Function
+    public double add(double a, double b, double c, double d) {
+        return a + b + c + d;
+    }
+
+    @V8Function
+    public String concat(String a, String b) {
+        return a;
+    }
+
+    @V8Function
+    public Object generic(Object[] arguments) {
+        return arguments.length;
+    }
+}
@@ -0,0 +1,36 @@
+package ag.boersego.bgjs;
+
+import android.util.Log;
+
+import java.util.Locale;
+
+/**
+ * Minimal timing loop for the benchmarks in this source set.
+ * Results are written to logcat with the tag BGJSBenchmark, e.g. "adb logcat -s BGJSBenchmark".
+ */
+final class Benchmark {
+    static final String TAG = "BGJSBenchmark";
+
+    private Benchmark() {}
+
+    /**
+     * runs the block a tenth of the iterations to warm up the JIT and the lazily resolved JNI caches, then measures it
+     * @return the average duration of one run in nanoseconds
+     */
+    static double measure(final String name, final int iterations, final Runnable block) {
+        for (int i = 0; i < Math.max(1, iterations / 10); i++) {
+            block.run();
+        }
+        final long start = System.nanoTime();
+        for (int i = 0; i < iterations; i++) {
+            block.run();
+        }
+        final double nsPerRun = (System.nanoTime() - start) / (double) iterations;
+        report(name, nsPerRun, iterations);
+        return nsPerRun;
+    }
+
+    static void report(final String name, final double nsPerRun, final int iterations) {
+        Log.i(TAG, String.format(Locale.US, "%s: %.1f ns per run (%d runs)", name, nsPerRun, iterations));
+    }
+}
@@ -0,0 +1,38 @@
+package ag.boersego.bgjs;
+
+import android.support.test.runner.AndroidJUnit4;
+
+import org.junit.Assume;
+import org.junit.Before;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+/**
+ * Measures JNIWrapper::getEnvironment with 1, 2 and 8 threads calling it at the same time.
+ * The native part lives in the library bgjsbenchmark, which is only built with "./gradlew -PbgjsBenchmarks ...";
+ * without it the benchmark is skipped.
+ */
+@RunWith(AndroidJUnit4.class)
+public class JNIEnvBenchmark {
+    private static final int ITERATIONS = 1000000;
+
+    private static native double measureGetEnvironment(int threads, int iterations);
+
+    @Before
+    public void setUp() throws Exception {
+        // loads and initializes libbgjs, which the benchmark library links against
+        TestEngine.get();
+        try {
+            System.loadLibrary("bgjsbenchmark");
+        } catch (UnsatisfiedLinkError e) {
+            Assume.assumeNoException("Built without -PbgjsBenchmarks", e);
+        }
+    }
+
+    @Test
+    public void getEnvironment() {
+        for (int threads : new int[] { 1, 2, 8 }) {
+            Benchmark.report("getEnvironment, " + threads + " threads", measureGetEnvironment(threads, ITERATIONS), ITERATIONS);
+        }
+    }
+}
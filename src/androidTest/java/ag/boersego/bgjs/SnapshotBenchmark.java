@@ -0,0 +1,89 @@
+package ag.boersego.bgjs;
+
+import android.support.test.runner.AndroidJUnit4;
+
+import org.junit.Before;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+import java.util.LinkedHashMap;
+import java.util.Map;
+
+import static org.junit.Assert.assertEquals;
+
+/**
+ * Moves a snapshot of 1000 quotes with 10 fields each (10000 fields) between java and javascript,
+ * once with one JNI call per field and once as a single ValueSerializer byte array.
+ */
+@RunWith(AndroidJUnit4.class)
+public class SnapshotBenchmark {
+    private static final int QUOTES = 1000;
+    private static final int ITERATIONS = 20;
+
+    private V8Engine engine;
+    private Map<String, Object> snapshot;
+
+    @Before
+    public void setUp() throws Exception {
+        engine = TestEngine.get();
+        snapshot = new LinkedHashMap<>();
+        for (int i = 0; i < QUOTES; i++) {
+            final Map<String, Object> quote = new LinkedHashMap<>();
+            quote.put("isin", "DE000000" + i);
+            quote.put("name", "Instrument " + i);
+            quote.put("currency", "EUR");
+            quote.put("bid", 100.0 + i * 0.01);
+            quote.put("ask", 100.05 + i * 0.01);
+            quote.put("last", 100.02 + i * 0.01);
+            quote.put("volume", i * 100);
+            quote.put("change", -0.25);
+            quote.put("time", 1500000000000.0 + i);
+            quote.put("tradable", i % 3 != 0);
+            snapshot.put("quote" + i, quote);
+        }
+    }
+
+    @Test
+    public void setFields() {
+        Benchmark.measure("snapshot set, one call per field", ITERATIONS, new Runnable() {
+            @Override
+            public void run() {
+                final JNIV8GenericObject root = JNIV8GenericObject.Create(engine);
+                for (Map.Entry<String, Object> entry : snapshot.entrySet()) {
+                    @SuppressWarnings("unchecked")
+                    final Map<String, Object> quote = (Map<String, Object>) entry.getValue();
+                    root.setV8Field(entry.getKey(), JNIV8GenericObject.fromMap(engine, quote));
+                }
+            }
+        });
+        Benchmark.measure("snapshot set, serialized", ITERATIONS, new Runnable() {
+            @Override
+            public void run() {
+                JNIV8GenericObject.Create(engine).setV8FieldsDeep(snapshot);
+            }
+        });
+    }
+
+    @Test
+    public void getFields() {
+        final JNIV8GenericObject root = JNIV8GenericObject.Create(engine);
+        root.setV8FieldsDeep(snapshot);
+        assertEquals(QUOTES, root.getV8FieldsDeep().size());
+
+        Benchmark.measure("snapshot get, one call per field", ITERATIONS, new Runnable() {
+            @Override
+            public void run() {
+                final Map<String, Object> result = new LinkedHashMap<>();
+                for (Map.Entry<String, Object> entry : root.getV8Fields().entrySet()) {
+                    result.put(entry.getKey(), ((JNIV8Object) entry.getValue()).getV8Fields());
+                }
+            }
+        });
+        Benchmark.measure("snapshot get, serialized", ITERATIONS, new Runnable() {
+            @Override
+            public void run() {
+                root.getV8FieldsDeep();
+            }
+        });
+    }
+}
@@ -0,0 +1,79 @@
+package ag.boersego.bgjs;
+
+import android.support.test.runner.AndroidJUnit4;
+
+import org.junit.Before;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+import static org.junit.Assert.assertEquals;
+
+/**
+ * Passes strings of typical lengths between java and javascript through a single field, in both directions.
+ * Each length is measured with ascii, latin-1 and two-byte content, which take different paths in JNIStringCoding.
+ */
+@RunWith(AndroidJUnit4.class)
+public class StringTranscodingBenchmark {
+    private static final int[] LENGTHS = { 8, 64, 1024, 65536 };
+    private static final char[] CHARACTERS = { 'a', '\u00e4', '\u20ac' };
+    private static final String[] CONTENT = { "ascii", "latin-1", "two-byte" };
+
+    private JNIV8GenericObject object;
+    private V8Key key;
+
+    @Before
+    public void setUp() throws Exception {
+        final V8Engine engine = TestEngine.get();
+        object = JNIV8GenericObject.Create(engine);
+        // a key instead of a field name, so that only the value is transcoded
+        key = engine.getV8Key("value");
+    }
+
+    @Test
+    public void javaToJavascript() {
+        for (int length : LENGTHS) {
+            for (int i = 0; i < CHARACTERS.length; i++) {
+                final String value = createString(length, CHARACTERS[i]);
+                Benchmark.measure("string to javascript, " + CONTENT[i] + ", " + length + " chars", iterations(length), new Runnable() {
+                    @Override
+                    public void run() {
+                        object.setV8Field(key, value);
+                    }
+                });
+            }
+        }
+    }
+
+    @Test
+    public void javascriptToJava() {
+        for (int length : LENGTHS) {
+            for (int i = 0; i < CHARACTERS.length; i++) {
+                final String value = createString(length, CHARACTERS[i]);
+                object.setV8Field(key, value);
+                assertEquals(value, object.getV8Field(key));
+                Benchmark.measure("string to java, " + CONTENT[i] + ", " + length + " chars", iterations(length), new Runnable() {
+                    @Override
+                    public void run() {
+                        object.getV8Field(key);
+                    }
+                });
+            }
+        }
+    }
+
+    /**
+     * a string of the given length that starts with ascii text and ends with the given character,
+     * so that content detection has to look at every character
+     */
+    private static String createString(final int length, final char last) {
+        final StringBuilder builder = new StringBuilder(length);
+        for (int i = 0; i < length - 1; i++) {
+            builder.append((char) ('a' + i % 26));
+        }
+        return builder.append(last).toString();
+    }
+
+    private static int iterations(final int length) {
+        return Math.max(100, 1000000 / length);
+    }
+}
@@ -0,0 +1,39 @@
+package ag.boersego.bgjs;
+
+import android.app.Application;
+import android.support.test.InstrumentationRegistry;
+
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * Provides the engine shared by all instrumentation tests and benchmarks of the library.
+ * Starting an engine takes a while, so it is created once and never shut down.
+ */
+final class TestEngine {
+    private static V8Engine sEngine;
+
+    private TestEngine() {}
+
+    /**
+     * @return the shared engine, after it became ready
+     */
+    static synchronized V8Engine get() throws InterruptedException {
+        if (sEngine == null) {
+            final Application application = (Application) InstrumentationRegistry.getTargetContext().getApplicationContext();
+            final V8Engine engine = new V8Engine(application, "benchmark.js");
+            final CountDownLatch ready = new CountDownLatch(1);
+            engine.addStatusHandler(new V8Engine.V8EngineHandler() {
+                @Override
+                public void onReady() {
+                    ready.countDown();
+                }
+            });
+            if (!ready.await(30, TimeUnit.SECONDS)) {
+                throw new IllegalStateException("Engine did not become ready");
+            }
+            sEngine = engine;
+        }
+        return sEngine;
+    }
+}
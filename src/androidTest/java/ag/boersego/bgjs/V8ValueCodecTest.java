@@ -0,0 +1,142 @@
+package ag.boersego.bgjs;
+
+import android.support.test.runner.AndroidJUnit4;
+
+import org.junit.Before;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.Iterator;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertSame;
+import static org.junit.Assert.assertTrue;
+
+/**
+ * Round-trips values of every supported type through the engine: encode, V8Engine.deserialize,
+ * JNIV8Object.serialize and decode. A failure means the codec and the v8 version in use disagree on the format.
+ */
+@RunWith(AndroidJUnit4.class)
+public class V8ValueCodecTest {
+    private V8Engine engine;
+
+    @Before
+    public void setUp() throws Exception {
+        engine = TestEngine.get();
+    }
+
+    @Test
+    public void roundTripsEverySupportedType() {
+        final Map<String, Object> nested = new LinkedHashMap<>();
+        nested.put("number", 1);
+        nested.put("object", Collections.singletonMap("key", "value"));
+        final Map<String, Object> nestedResult = new LinkedHashMap<>();
+        nestedResult.put("number", 1.0);
+        nestedResult.put("object", Collections.singletonMap("key", "value"));
+
+        // pairs of the value that is encoded and the value that decode is expected to return
+        final Object[] samples = {
+                null, null,
+                JNIV8Undefined.GetInstance(), JNIV8Undefined.GetInstance(),
+                true, true,
+                false, false,
+                42, 42.0,
+                (short) -7, -7.0,
+                (byte) 3, 3.0,
+                1L << 40, (double) (1L << 40),
+                0.5f, 0.5,
+                -3.25, -3.25,
+                Double.NaN, Double.NaN,
+                'x', "x",
+                "", "",
+                "latin-1 \u00e4\u00f6\u00fc", "latin-1 \u00e4\u00f6\u00fc",
+                "two byte \u20ac", "two byte \u20ac",
+                nested, nestedResult,
+                Arrays.asList(1, "two", null), Arrays.asList(1.0, "two", null),
+                new Object[] { true, 2.5 }, Arrays.asList(true, 2.5),
+                new byte[] { 1, 2, 3 }, new byte[] { 1, 2, 3 },
+        };
+        for (int i = 0; i < samples.length; i += 2) {
+            final Object result = roundTrip(engine, samples[i]);
+            assertTrue("Round trip of " + describe(samples[i]) + " returned " + describe(result),
+                    deepEquals(samples[i + 1], result));
+        }
+    }
+
+    @Test
+    public void keepsIdentityOfCyclicObjects() {
+        final Map<String, Object> cycle = new LinkedHashMap<>();
+        cycle.put("self", cycle);
+        final Object result = roundTrip(engine, cycle);
+        assertTrue(result instanceof Map);
+        assertSame(result, ((Map<?, ?>) result).get("self"));
+    }
+
+    @Test
+    public void roundTripsObjectWith10000Fields() {
+        final Map<String, Object> fields = new LinkedHashMap<>();
+        for (int i = 0; i < 10000; i++) {
+            fields.put("field" + i, i % 2 == 0 ? (Object) i : "value" + i);
+        }
+        final Object result = roundTrip(engine, fields);
+        assertTrue(result instanceof Map);
+        assertEquals(fields.size(), ((Map<?, ?>) result).size());
+    }
+
+    /**
+     * passes a value through the engine as the only field of an object, because only objects can be serialized
+     */
+    static Object roundTrip(final V8Engine engine, final Object value) {
+        final Map<String, Object> root = Collections.singletonMap("value", value);
+        final JNIV8Object object = (JNIV8Object) engine.deserialize(V8ValueCodec.encode(root));
+        final Object result = V8ValueCodec.decode(object.serialize());
+        assertTrue("Round trip of an object returned " + describe(result), result instanceof Map);
+        return ((Map<?, ?>) result).get("value");
+    }
+
+    private static boolean deepEquals(final Object expected, final Object actual) {
+        if (expected == null || actual == null) {
+            return expected == actual;
+        } else if (expected instanceof byte[]) {
+            return actual instanceof byte[] && Arrays.equals((byte[]) expected, (byte[]) actual);
+        } else if (expected instanceof List) {
+            if (!(actual instanceof List) || ((List<?>) expected).size() != ((List<?>) actual).size()) {
+                return false;
+            }
+            final Iterator<?> it = ((List<?>) actual).iterator();
+            for (Object element : (List<?>) expected) {
+                if (!deepEquals(element, it.next())) {
+                    return false;
+                }
+            }
+            return true;
+        } else if (expected instanceof Map) {
+            if (!(actual instanceof Map) || ((Map<?, ?>) expected).size() != ((Map<?, ?>) actual).size()) {
+                return false;
+            }
+            for (Map.Entry<?, ?> entry : ((Map<?, ?>) expected).entrySet()) {
+                if (!deepEquals(entry.getValue(), ((Map<?, ?>) actual).get(entry.getKey()))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        return expected.equals(actual);
+    }
+
+    private static String describe(final Object value) {
+        if (value == null) {
+            return "null";
+        } else if (value instanceof byte[]) {
+            return "byte[] " + Arrays.toString((byte[]) value);
+        } else if (value instanceof Object[]) {
+            return "Object[] " + Arrays.toString((Object[]) value);
+        }
+        return value.getClass().getSimpleName() + " " + value;
+    }
+}
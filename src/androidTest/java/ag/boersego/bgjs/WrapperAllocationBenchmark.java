@@ -0,0 +1,73 @@
+package ag.boersego.bgjs;
+
+import android.support.test.runner.AndroidJUnit4;
+import android.util.Log;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+import static org.junit.Assert.assertEquals;
+
+/**
+ * Reads all elements of a javascript array of 10000 objects twice and counts the wrappers created for them,
+ * with wrapper caching disabled (the default) and enabled.
+ */
+@RunWith(AndroidJUnit4.class)
+public class WrapperAllocationBenchmark {
+    private static final int ELEMENTS = 10000;
+
+    private V8Engine engine;
+    private boolean cachingWasEnabled;
+
+    @Before
+    public void setUp() throws Exception {
+        engine = TestEngine.get();
+        cachingWasEnabled = JNIV8Object.isWrapperCachingEnabled();
+    }
+
+    @After
+    public void tearDown() {
+        JNIV8Object.setWrapperCaching(cachingWasEnabled);
+    }
+
+    @Test
+    public void withoutCache() {
+        JNIV8Object.setWrapperCaching(false);
+        final long[] counts = readTwice();
+        assertEquals(2 * ELEMENTS, counts[0]);
+        assertEquals(0, counts[1]);
+    }
+
+    @Test
+    public void withCache() {
+        JNIV8Object.setWrapperCaching(true);
+        final long[] counts = readTwice();
+        assertEquals(ELEMENTS, counts[0]);
+        assertEquals(ELEMENTS, counts[1]);
+    }
+
+    /**
+     * @return the number of wrappers created and reused while reading the array twice
+     */
+    private long[] readTwice() {
+        final JNIV8Array array = (JNIV8Array) engine.runScript(
+                "(function() { var a = []; for (var i = 0; i < " + ELEMENTS + "; i++) { a.push({ index: i }); } return a; })()",
+                "wrapperAllocationBenchmark");
+        final long[] before = JNIV8Object.getWrapperStats();
+        final long start = System.nanoTime();
+        // the first result stays referenced, so that its wrappers are still alive during the second read
+        final Object[] first = array.getV8Elements();
+        final Object[] second = array.getV8Elements();
+        final long duration = System.nanoTime() - start;
+        final long[] after = JNIV8Object.getWrapperStats();
+
+        final long[] counts = { after[0] - before[0], after[1] - before[1] };
+        Log.i(Benchmark.TAG, "wrappers for 2 x " + ELEMENTS + " elements, caching "
+                + (JNIV8Object.isWrapperCachingEnabled() ? "on" : "off") + ": " + counts[0] + " created, "
+                + counts[1] + " reused, " + (duration / 1000) + "us");
+        assertEquals(first.length, second.length);
+        return counts;
+    }
+}
@@ -0,0 +1,132 @@
+#include "BGJSFinalizationQueue.h"
+#include "../jni/jni.h"
+
+#include <string.h>
+
+/**
+ * BGJSFinalizationQueue
+ * Releases java references that became unused inside v8 weak callbacks in batches.
+ *
+ * Copyright 2014 Kevin Read <me@kevin-read.com> and BörseGo AG (https://github.com/godmodelabs/ejecta-v8/)
+ * Licensed under the MIT license.
+ */
+
+// entries are released outside of the lock; this many are taken from the queue at a time
+#define DRAIN_CHUNK_SIZE 32
+
+BGJSFinalizationQueue::BGJSFinalizationQueue() {
+	pthread_mutex_init(&_mutex, NULL);
+	_head = 0;
+	_listener = nullptr;
+	_listenerData = nullptr;
+	memset(&_stats, 0, sizeof(BGJSFinalizationStats));
+}
+
+BGJSFinalizationQueue::~BGJSFinalizationQueue() {
+	pthread_mutex_destroy(&_mutex);
+}
+
+void BGJSFinalizationQueue::setListener(BGJSFinalizationListener listener, void *data) {
+	pthread_mutex_lock(&_mutex);
+	_listener = listener;
+	_listenerData = data;
+	pthread_mutex_unlock(&_mutex);
+}
+
+void BGJSFinalizationQueue::enqueue(const Entry &entry) {
+	pthread_mutex_lock(&_mutex);
+	const bool wasEmpty = _entries.size() == _head;
+	_entries.push_back(entry);
+	_stats.enqueued++;
+	const uint32_t depth = (uint32_t)(_entries.size() - _head);
+	if (depth > _stats.peakDepth) {
+		_stats.peakDepth = depth;
+	}
+	// entries are otherwise only released when js runs; an idle engine would keep them forever
+	// the listener is called under the lock, so that setListener(nullptr) guarantees it is no longer running
+	if (wasEmpty && _listener) {
+		_listener(_listenerData);
+	}
+	pthread_mutex_unlock(&_mutex);
+}
+
+void BGJSFinalizationQueue::enqueueRelease(JNIObject *object) {
+	enqueue({ object, { nullptr, JNIHandleTable::kInvalidHandle } });
+}
+
+void BGJSFinalizationQueue::enqueueGlobalRef(jobject globalRef) {
+	enqueue({ nullptr, { globalRef, JNIHandleTable::kInvalidHandle } });
+}
+
+void BGJSFinalizationQueue::enqueueStrongRef(const JNIStrongRef &ref) {
+	enqueue({ nullptr, ref });
+}
+
+size_t BGJSFinalizationQueue::drain(size_t maxEntries) {
+	JNIEnv *env = nullptr;
+	Entry chunk[DRAIN_CHUNK_SIZE];
+	size_t released = 0;
+
+	while (released < maxEntries) {
+		size_t count = maxEntries - released;
+		if (count > DRAIN_CHUNK_SIZE) {
+			count = DRAIN_CHUNK_SIZE;
+		}
+
+		pthread_mutex_lock(&_mutex);
+		const size_t available = _entries.size() - _head;
+		if (count > available) {
+			count = available;
+		}
+		if (count) {
+			memcpy(chunk, &_entries[_head], count * sizeof(Entry));
+			_head += count;
+		}
+		// compact once everything was taken, or once the taken part dominates the buffer
+		if (_head == _entries.size()) {
+			_entries.clear();
+			_head = 0;
+		} else if (_head > DRAIN_CHUNK_SIZE && _head * 2 > _entries.size()) {
+			_entries.erase(_entries.begin(), _entries.begin() + _head);
+			_head = 0;
+		}
+		pthread_mutex_unlock(&_mutex);
+
+		if (!count) break;
+
+		// jni calls happen outside of the lock, so that enqueueing from weak callbacks never waits for them
+		// NOTE: a released object might be deleted by the java finalizer thread right away
+		for (size_t i = 0; i < count; i++) {
+			if (chunk[i].object) {
+				chunk[i].object->releaseJObject();
+			} else {
+				if (!env) env = JNIWrapper::getEnvironment();
+				chunk[i].ref.reset(env);
+			}
+		}
+		released += count;
+	}
+
+	if (released) {
+		pthread_mutex_lock(&_mutex);
+		_stats.released += released;
+		_stats.drains++;
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	return released;
+}
+
+size_t BGJSFinalizationQueue::depth() {
+	pthread_mutex_lock(&_mutex);
+	const size_t depth = _entries.size() - _head;
+	pthread_mutex_unlock(&_mutex);
+	return depth;
+}
+
+void BGJSFinalizationQueue::getStats(BGJSFinalizationStats *stats) {
+	pthread_mutex_lock(&_mutex);
+	*stats = _stats;
+	stats->depth = (uint32_t)(_entries.size() - _head);
+	pthread_mutex_unlock(&_mutex);
+}
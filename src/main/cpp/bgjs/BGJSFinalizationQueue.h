@@ -0,0 +1,97 @@
+#ifndef __BGJSFINALIZATIONQUEUE_H
+#define __BGJSFINALIZATIONQUEUE_H	1
+
+#include <jni.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "../jni/JNIHandleTable.h"
+
+/**
+ * BGJSFinalizationQueue
+ * Collects java references that became unused inside v8 weak callbacks, so that they can be released in batches
+ * at idle points of the engine thread instead of in the middle of a garbage collection.
+ * Weak callbacks only enqueue; the engine drains a bounded number of entries at a time.
+ *
+ * All methods are thread safe.
+ *
+ * Copyright 2014 Kevin Read <me@kevin-read.com> and BörseGo AG (https://github.com/godmodelabs/ejecta-v8/)
+ * Licensed under the MIT license.
+ */
+
+class JNIObject;
+
+struct BGJSFinalizationStats {
+	// entries currently waiting to be released
+	uint32_t depth;
+	// highest depth the queue ever had
+	uint32_t peakDepth;
+	uint64_t enqueued;
+	uint64_t released;
+	uint64_t drains;
+};
+
+typedef void (*BGJSFinalizationListener)(void *data);
+
+class BGJSFinalizationQueue {
+public:
+	BGJSFinalizationQueue();
+	~BGJSFinalizationQueue();
+
+	/**
+	 * sets a function that is called whenever an entry is added to the empty queue, so that the owner can schedule a drain
+	 * the listener is called on the enqueueing thread - possibly from inside a weak callback - and must not block
+	 * it is called while the queue is locked and must not use the queue; once this returns, the previous listener
+	 * is no longer running
+	 */
+	void setListener(BGJSFinalizationListener listener, void *data);
+
+	/**
+	 * releases the strong java reference held by the object (see JNIObject::releaseJObject) on the next drain
+	 * the object has to be retained until then
+	 */
+	void enqueueRelease(JNIObject *object);
+
+	/**
+	 * deletes the global reference on the next drain
+	 */
+	void enqueueGlobalRef(jobject globalRef);
+
+	/**
+	 * resets the reference - a global reference or an entry of the handle table - on the next drain
+	 */
+	void enqueueStrongRef(const JNIStrongRef &ref);
+
+	/**
+	 * releases up to maxEntries entries, oldest first, and returns the number of released entries
+	 * must be called on a thread that is attached to the jvm
+	 */
+	size_t drain(size_t maxEntries);
+
+	/**
+	 * returns the number of entries waiting to be released
+	 */
+	size_t depth();
+
+	void getStats(BGJSFinalizationStats *stats);
+
+private:
+	struct Entry {
+		JNIObject *object;
+		JNIStrongRef ref;
+	};
+
+	void enqueue(const Entry &entry);
+
+	pthread_mutex_t _mutex;
+	BGJSFinalizationListener _listener;
+	void *_listenerData;
+	// entries before _head were already taken by a drain
+	std::vector<Entry> _entries;
+	size_t _head;
+	BGJSFinalizationStats _stats;
+};
+
+#endif
@@ -0,0 +1,127 @@
+#include "BGJSFrameScheduler.h"
+
+#include <string.h>
+#include <time.h>
+
+/**
+ * BGJSFrameScheduler
+ * Paces work that reaches the JS thread from java against the animation frames of an isolate.
+ *
+ * Copyright 2014 Kevin Read <me@kevin-read.com> and BörseGo AG (https://github.com/godmodelabs/ejecta-v8/)
+ * Licensed under the MIT license.
+ */
+
+// budget for deferrable work per frame; the rest of a 60fps frame is left for rendering
+#define DEFAULT_BUDGET_MS 8.0
+#define DEFAULT_FRAME_INTERVAL_MS (1000.0 / 60.0)
+// if no frame was started for this long, nothing is animating and there is nothing to pace
+#define FRAME_TIMEOUT_MS 100.0
+
+// share of the budget a class of work may start in; lower priorities give up earlier
+static const double kBudgetShare[(int)BGJSWorkClass::kCount] = {
+		0,		// kInput (never deferred)
+		0,		// kAnimationFrame (never deferred)
+		0,		// kMicrotask (never deferred)
+		1.0,	// kTimer
+		0.75,	// kNetwork
+		0.25	// kIdle
+};
+
+BGJSFrameScheduler::BGJSFrameScheduler() {
+	pthread_mutex_init(&_mutex, NULL);
+	_budgetMs = DEFAULT_BUDGET_MS;
+	_frameStart = 0;
+	_frameIntervalMs = DEFAULT_FRAME_INTERVAL_MS;
+	_deferrableMs = 0;
+	memset(&_current, 0, sizeof(BGJSFrameStats));
+	memset(&_last, 0, sizeof(BGJSFrameStats));
+	memset(&_total, 0, sizeof(BGJSFrameStats));
+}
+
+BGJSFrameScheduler::~BGJSFrameScheduler() {
+	pthread_mutex_destroy(&_mutex);
+}
+
+double BGJSFrameScheduler::now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+void BGJSFrameScheduler::beginFrame() {
+	const double time = now();
+
+	pthread_mutex_lock(&_mutex);
+
+	// estimate the frame interval from consecutive frames; long gaps mean that animations were paused
+	if (_frameStart > 0) {
+		const double interval = time - _frameStart;
+		if (interval < FRAME_TIMEOUT_MS) {
+			_frameIntervalMs = _frameIntervalMs * 0.9 + interval * 0.1;
+		}
+	}
+	_frameStart = time;
+
+	_current.frameIntervalMs = _frameIntervalMs;
+	_last = _current;
+
+	_total.frames++;
+	_total.frameIntervalMs = _frameIntervalMs;
+	for (int i = 0; i < (int)BGJSWorkClass::kCount; i++) {
+		_total.timeMs[i] += _current.timeMs[i];
+		_total.deferred[i] += _current.deferred[i];
+	}
+
+	memset(&_current, 0, sizeof(BGJSFrameStats));
+	_current.frames = _total.frames;
+	_deferrableMs = 0;
+
+	pthread_mutex_unlock(&_mutex);
+}
+
+bool BGJSFrameScheduler::shouldDefer(BGJSWorkClass workClass) {
+	const double share = kBudgetShare[(int)workClass];
+	if (share <= 0) {
+		return false;
+	}
+
+	const double time = now();
+	bool defer = false;
+
+	pthread_mutex_lock(&_mutex);
+	if (_frameStart > 0 && time - _frameStart < FRAME_TIMEOUT_MS) {
+		defer = _deferrableMs >= _budgetMs * share;
+		if (defer) {
+			_current.deferred[(int)workClass]++;
+		}
+	}
+	pthread_mutex_unlock(&_mutex);
+
+	return defer;
+}
+
+void BGJSFrameScheduler::account(BGJSWorkClass workClass, double ms) {
+	pthread_mutex_lock(&_mutex);
+	_current.timeMs[(int)workClass] += ms;
+	if (kBudgetShare[(int)workClass] > 0) {
+		_deferrableMs += ms;
+	}
+	pthread_mutex_unlock(&_mutex);
+}
+
+void BGJSFrameScheduler::setBudget(double ms) {
+	pthread_mutex_lock(&_mutex);
+	_budgetMs = ms;
+	pthread_mutex_unlock(&_mutex);
+}
+
+void BGJSFrameScheduler::getStats(BGJSFrameStats *lastFrame, BGJSFrameStats *total) {
+	pthread_mutex_lock(&_mutex);
+	if (lastFrame) {
+		*lastFrame = _last;
+	}
+	if (total) {
+		*total = _total;
+	}
+	pthread_mutex_unlock(&_mutex);
+}
@@ -0,0 +1,84 @@
+#ifndef __BGJSFRAMESCHEDULER_H
+#define __BGJSFRAMESCHEDULER_H	1
+
+#include <pthread.h>
+#include <stdint.h>
+
+/**
+ * BGJSFrameScheduler
+ * Paces work that reaches the JS thread from java against the animation frames of an isolate.
+ * While frames are being rendered, timers, network callbacks and idle work share a per-frame time budget;
+ * once it is used up they are deferred to the next frame so that they can not push requestAnimationFrame
+ * callbacks past their deadline. Input, animation frames and microtasks are never deferred.
+ *
+ * All methods are thread safe; frames are driven by the render thread, other work runs on the engine thread.
+ *
+ * Copyright 2014 Kevin Read <me@kevin-read.com> and BörseGo AG (https://github.com/godmodelabs/ejecta-v8/)
+ * Licensed under the MIT license.
+ */
+
+enum class BGJSWorkClass : int {
+	kInput = 0,
+	kAnimationFrame,
+	kMicrotask,
+	kTimer,
+	kNetwork,
+	kIdle,
+	kCount
+};
+
+struct BGJSFrameStats {
+	uint64_t frames;
+	double frameIntervalMs;
+	double timeMs[(int)BGJSWorkClass::kCount];
+	uint32_t deferred[(int)BGJSWorkClass::kCount];
+};
+
+class BGJSFrameScheduler {
+public:
+	BGJSFrameScheduler();
+	~BGJSFrameScheduler();
+
+	/**
+	 * milliseconds on a monotonic clock
+	 */
+	static double now();
+
+	/**
+	 * called when the callbacks of a new animation frame are dispatched
+	 * closes the accounting of the previous frame and resets the budget
+	 */
+	void beginFrame();
+
+	/**
+	 * returns true if work of the specified class should wait for the next frame
+	 * deferrals are counted in the frame statistics
+	 */
+	bool shouldDefer(BGJSWorkClass workClass);
+
+	/**
+	 * adds the time spent on work of the specified class to the current frame
+	 */
+	void account(BGJSWorkClass workClass, double ms);
+
+	/**
+	 * sets the time per frame that may be spent on deferrable work
+	 */
+	void setBudget(double ms);
+
+	/**
+	 * copies the accounting of the last completed frame and the totals since the scheduler was created
+	 */
+	void getStats(BGJSFrameStats *lastFrame, BGJSFrameStats *total);
+
+private:
+	pthread_mutex_t _mutex;
+	double _budgetMs;
+	double _frameStart;
+	double _frameIntervalMs;
+	double _deferrableMs;
+
+	BGJSFrameStats _current, _last, _total;
+};
+
+#endif
@@ -47,8 +47,7 @@ static void checkGlError(const char* op) {
 BGJSGLView::BGJSGLView(BGJSV8Engine *engine, float pixelRatio, bool doNoClearOnFlip, int width, int height) :
 		BGJSView(engine, pixelRatio, doNoClearOnFlip) {
 
-	_firstFrameRequest = 0;
-	_nextFrameRequest = 0;
+	_frameCount = 0;
 	noFlushOnRedraw = false;
 
 	const char* eglVersion = eglQueryString(eglGetCurrentDisplay(), EGL_VERSION);
@@ -57,6 +56,7 @@ BGJSGLView::BGJSGLView(BGJSV8Engine *engine, float pixelRatio, bool doNoClearOnF
 
 	context2d = new BGJSCanvasContext(width, height);
 	context2d->backingStoreRatio = pixelRatio;
+	context2d->externalMemory = engine->getExternalMemory();
 #ifdef DEBUG
 	LOGI("pixel Ratio %f", pixelRatio);
 #endif
@@ -64,6 +64,7 @@ BGJSGLView::BGJSGLView(BGJSV8Engine *engine, float pixelRatio, bool doNoClearOnF
 }
 
 BGJSGLView::~BGJSGLView() {
+	clearAnimationFrameRequests();
 	if (context2d) {
 		delete (context2d);
 	}
@@ -155,13 +156,7 @@ void BGJSGLView::resize(int widthp, int heightp, bool resizeOnly) {
 void BGJSGLView::close() {
 
 	// Invalidate all refresh requests
-	for (int i = 0; i < MAX_FRAME_REQUESTS; i++) {
-		if (_frameRequests[i].valid && _frameRequests[i].view != NULL) {
-			_frameRequests[i].valid = false;
-			BGJS_CLEAR_PERSISTENT(_frameRequests[i].callback);
-			_frameRequests[i].view = NULL;
-		}
-	}
+	clearAnimationFrameRequests();
 
 	LOGD("BGJSGLView close");
 
@@ -186,30 +181,57 @@ void BGJSGLView::requestRefresh() {
 int BGJSGLView::requestAnimationFrameForView(Handle<Object> cb, Handle<Object> thisObj, int id) {
     Isolate* isolate = _engine->getIsolate();
     HandleScope scope(isolate);
-	// make sure there is still room in the buffer
 #ifdef DEBUG
-	LOGD("requestAnimation %d %d", _firstFrameRequest, _nextFrameRequest);
+	LOGD("requestAnimation %d pending %d", id, (int)_frameRequests.size());
 #endif
 
-	if (_nextFrameRequest >= MAX_FRAME_REQUESTS) {
-		return -1;
-	}
-
-	// schedule request
-
-	AnimationFrameRequest *request = &_frameRequests[_nextFrameRequest];
+	// schedule request; the queue grows as needed so requests are never dropped
+	AnimationFrameRequest *request = new AnimationFrameRequest();
 	BGJS_RESET_PERSISTENT(isolate, request->callback, cb);
 	request->view = this;
 	request->valid = true;
 	BGJS_RESET_PERSISTENT(isolate, request->thisObj, thisObj);
 	request->requestId = id;
-	_nextFrameRequest = (_nextFrameRequest + 1) % MAX_FRAME_REQUESTS;
+
+	_frameRequests.push_back(request);
+	_frameRequestIndex[id] = request;
 
 #ifdef DEBUG
 	LOGD("requestAnimation new id %d", request->requestId);
 #endif
 
-	requestRefresh();
+	// only the first request of a frame needs to ask for a redraw
+	if (_frameRequests.size() == 1) {
+		requestRefresh();
+	}
 
 	return request->requestId;
 }
+
+bool BGJSGLView::cancelAnimationFrameForView(int id) {
+	auto it = _frameRequestIndex.find(id);
+	if (it == _frameRequestIndex.end()) {
+		return false;
+	}
+
+	// the request stays in the queue but is skipped once the frame is dispatched
+	AnimationFrameRequest *request = it->second;
+	request->valid = false;
+	BGJS_CLEAR_PERSISTENT(request->callback);
+	BGJS_CLEAR_PERSISTENT(request->thisObj);
+	_frameRequestIndex.erase(it);
+
+	return true;
+}
+
+void BGJSGLView::clearAnimationFrameRequests() {
+	for (AnimationFrameRequest *request : _frameRequests) {
+		if (request->valid) {
+			BGJS_CLEAR_PERSISTENT(request->callback);
+			BGJS_CLEAR_PERSISTENT(request->thisObj);
+		}
+		delete request;
+	}
+	_frameRequests.clear();
+	_frameRequestIndex.clear();
+}
@@ -6,6 +6,9 @@
 #include "BGJSV8Engine.h"
 #include "os-android.h"
 
+#include <vector>
+#include <unordered_map>
+
 /**
  * BGJSGLView
  * Wrapper class around native windows that expose OpenGL operations
@@ -35,15 +38,20 @@ public:
 	void close ();
 	void requestRefresh();
 	int requestAnimationFrameForView(v8::Handle<v8::Object> cb, v8::Handle<v8::Object> thisObj, int id);
+	bool cancelAnimationFrameForView(int id);
+	void clearAnimationFrameRequests();
 #ifdef ANDROID
 	void setJavaGl(JNIEnv* env, jobject javaGlView);
 #endif
 
 	BGJSCanvasContext *context2d;
 
-	AnimationFrameRequest _frameRequests[MAX_FRAME_REQUESTS];
-	int _firstFrameRequest;
-	int _nextFrameRequest;
+	// pending requests in the order they were made; grows as needed, requests are never dropped
+	std::vector<AnimationFrameRequest*> _frameRequests;
+	// request id => pending request, used for O(1) cancellation
+	std::unordered_map<int, AnimationFrameRequest*> _frameRequestIndex;
+	// number of frames that dispatched at least one animation frame request
+	uint64_t _frameCount;
 
 protected:
     bool noFlushOnRedraw = false;
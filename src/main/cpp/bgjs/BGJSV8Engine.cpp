@@ -9,21 +9,35 @@
 #include <libplatform/libplatform.h>
 #include "BGJSV8Engine.h"
 #include "../jni/JNIWrapper.h"
+#include "../jni/JNIHandleTable.h"
 #include "../v8/JNIV8Wrapper.h"
 #include "../v8/JNIV8GenericObject.h"
 #include "../v8/JNIV8Function.h"
+#include "../v8/JNIV8ArrayBuffer.h"
 
 #include <android/asset_manager.h>
 #include <android/asset_manager_jni.h>
 
 #include "mallocdebug.h"
 #include <assert.h>
+#include <algorithm>
+#include <functional>
 #include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "BGJSGLView.h"
+#include "EJExternalMemory.h"
 
 #define LOG_TAG	"BGJSV8Engine-jni"
 
+// references released by weak callbacks per idle point
+#define FINALIZATION_BATCH_SIZE 256
+// beyond this many queued references a batch is released even if the current frame is out of budget
+#define FINALIZATION_QUEUE_LIMIT 4096
+
 using namespace v8;
 
 BGJS_JNI_LINK(BGJSV8Engine, "ag/boersego/bgjs/V8Engine")
@@ -184,14 +198,15 @@ decltype(BGJSV8Engine::_jniV8Engine) BGJSV8Engine::_jniV8Engine = {0};
  */
 struct BGJSV8EngineJavaErrorHolder {
     v8::Persistent<v8::Object> persistent;
-    jthrowable throwable;
+    JNIStrongRef throwable;
+    BGJSFinalizationQueue *finalizationQueue;
 };
 
 void BGJSV8EngineJavaErrorHolderWeakPersistentCallback(const v8::WeakCallbackInfo<void>& data) {
-    JNIEnv *env = JNIWrapper::getEnvironment();
-
     BGJSV8EngineJavaErrorHolder *holder = reinterpret_cast<BGJSV8EngineJavaErrorHolder*>(data.GetParameter());
-    env->DeleteGlobalRef(holder->throwable);
+
+    // the throwable is released with the next batch instead of in the middle of the gc
+    holder->finalizationQueue->enqueueStrongRef(holder->throwable);
 
     holder->persistent.Reset();
     delete holder;
@@ -204,6 +219,129 @@ BGJSV8Engine* BGJSV8Engine::GetInstance(v8::Isolate *isolate) {
     return reinterpret_cast<BGJSV8Engine*>(isolate->GetCurrentContext()->GetAlignedPointerFromEmbedderData(EBGJSV8EngineEmbedderData::kContext));
 }
 
+BGJSV8Engine* BGJSV8Engine::getIsolateHost() {
+    return _isolateHost ? _isolateHost : this;
+}
+
+const BGJSV8Engine* BGJSV8Engine::getIsolateHost() const {
+    return _isolateHost ? _isolateHost : this;
+}
+
+BGJSIsolateOwner* BGJSV8Engine::getIsolateOwner() {
+    return getIsolateHost()->_isolateOwner;
+}
+
+BGJSIsolateOwner::BGJSIsolateOwner(v8::Isolate *isolate, v8::ArrayBuffer::Allocator *allocator) :
+		_refCount(1), _isolate(isolate), _allocator(allocator) {
+}
+
+BGJSIsolateOwner::~BGJSIsolateOwner() {
+	_isolate->Dispose();
+	delete _allocator;
+}
+
+void BGJSIsolateOwner::retain() {
+	_refCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BGJSIsolateOwner::release() {
+	if (_refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		delete this;
+	}
+}
+
+BGJSFrameScheduler* BGJSV8Engine::getFrameScheduler() {
+	// frames and all other work compete for the same isolate lock, so they are paced per isolate
+	return &getIsolateHost()->_frameScheduler;
+}
+
+BGJSFinalizationQueue* BGJSV8Engine::getFinalizationQueue() const {
+	// weak callbacks run for the whole isolate, so the queue is shared like the scheduler
+	return &getIsolateHost()->_finalizationQueue;
+}
+
+/**
+ * called when references are added to the empty finalization queue of the isolate
+ * asks the java side to run the idle work on the engine thread, so that the queue is drained even if no js runs
+ */
+void BGJSV8Engine::FinalizationQueueListener(void *data) {
+	BGJSV8Engine *engine = reinterpret_cast<BGJSV8Engine*>(data);
+	JNIEnv *env = JNIWrapper::getEnvironment();
+
+	// weak callbacks can run while a java exception is pending; it has to survive the call
+	jthrowable exc = nullptr;
+	if (env->ExceptionCheck()) {
+		exc = env->ExceptionOccurred();
+		env->ExceptionClear();
+	}
+
+	env->CallVoidMethod(engine->getJObject(), _jniV8Engine.requestIdleWorkId);
+
+	if (exc) env->Throw(exc);
+}
+
+EJExternalMemory* BGJSV8Engine::getExternalMemory() {
+	return &_externalMemory;
+}
+
+void BGJSV8Engine::runIdleWork() {
+	// textures, image data and fonts are held by small js objects; without this the gc would not see their size
+	const int64_t externalMemory = _externalMemory.takeUnreported();
+	if (externalMemory) {
+		_isolate->AdjustAmountOfExternalAllocatedMemory(externalMemory);
+	}
+
+	// memory handed to java with JNIV8ArrayBuffer.getByteBuffer stays alive until java dropped the ByteBuffer
+	JNIV8ArrayBuffer::releaseByteBuffers(_isolate, false);
+
+	BGJSFinalizationQueue *queue = getFinalizationQueue();
+	const size_t depth = queue->depth();
+	if (!depth) return;
+
+	BGJSFrameScheduler *scheduler = getFrameScheduler();
+	if (depth < FINALIZATION_QUEUE_LIMIT && scheduler->shouldDefer(BGJSWorkClass::kIdle)) {
+		return;
+	}
+
+	const double start = BGJSFrameScheduler::now();
+	queue->drain(FINALIZATION_BATCH_SIZE);
+	scheduler->account(BGJSWorkClass::kIdle, BGJSFrameScheduler::now() - start);
+}
+
+v8::Local<v8::Private> BGJSV8Engine::getWrapperCacheKey() {
+	// privates are per isolate, so all contexts share the key of the host
+	BGJSV8Engine *host = getIsolateHost();
+	if(host->_wrapperCacheKey.IsEmpty()) {
+		host->_wrapperCacheKey.Set(_isolate, Private::New(_isolate, String::NewFromUtf8(_isolate, "JNIV8WrapperCache")));
+	}
+	return host->_wrapperCacheKey.Get(_isolate);
+}
+
+int BGJSV8Engine::createPropertyKey(const std::string& name) {
+	// eternals are only freed with the isolate; sharing the table with the host keeps it from growing with every context
+	// the table is only accessed with the isolate locked
+	BGJSV8Engine *host = getIsolateHost();
+	auto it = host->_propertyKeyIndices.find(name);
+	if(it != host->_propertyKeyIndices.end()) {
+		return it->second;
+	}
+
+	// internalized strings are looked up by identity, so v8 can skip hashing and comparing them on every access
+	Local<String> key = String::NewFromUtf8(_isolate, name.c_str(), NewStringType::kInternalized, (int)name.length()).ToLocalChecked();
+	int index = (int)host->_propertyKeys.size();
+	host->_propertyKeys.emplace_back(_isolate, key);
+	host->_propertyKeyIndices[name] = index;
+	return index;
+}
+
+v8::Local<v8::String> BGJSV8Engine::getPropertyKey(int index) {
+	BGJSV8Engine *host = getIsolateHost();
+	if(index < 0 || index >= (int)host->_propertyKeys.size()) {
+		return v8::Local<v8::String>();
+	}
+	return host->_propertyKeys[index].Get(_isolate);
+}
+
 bool BGJSV8Engine::forwardJNIExceptionToV8() const {
     JNIEnv *env = JNIWrapper::getEnvironment();
     jthrowable e = env->ExceptionOccurred();
@@ -227,7 +365,8 @@ bool BGJSV8Engine::forwardJNIExceptionToV8() const {
 	auto privateKey = v8::Private::ForApi(_isolate, v8::String::NewFromUtf8(_isolate, "JavaErrorExternal"));
 	result->SetPrivate(context, privateKey, External::New(_isolate, holder));
 
-	holder->throwable = (jthrowable)env->NewGlobalRef(e);
+	holder->throwable.set(env, e);
+    holder->finalizationQueue = getFinalizationQueue();
     holder->persistent.Reset(_isolate, result);
     holder->persistent.SetWeak((void*)holder, BGJSV8EngineJavaErrorHolderWeakPersistentCallback, v8::WeakCallbackType::kParameter);
 
@@ -274,14 +413,15 @@ bool BGJSV8Engine::forwardV8ExceptionToJNI(v8::TryCatch* try_catch) const {
         maybeValue = exceptionObj->GetPrivate(context, privateKey);
         if (maybeValue.ToLocal(&value) && value->IsExternal()) {
             BGJSV8EngineJavaErrorHolder *holder = static_cast<BGJSV8EngineJavaErrorHolder *>(value.As<External>()->Value());
+            JNIStrongRefScope throwable(env, holder->throwable);
 
-            if(!env->IsInstanceOf(holder->throwable, _jniV8Exception.clazz)) {
+            if(!env->IsInstanceOf(throwable.get(), _jniV8Exception.clazz)) {
                 // if the wrapped java exception was not of type V8Exception
                 // then we need to wrap it to preserve the v8 call stack
-                causeException = env->NewLocalRef(holder->throwable);
+                causeException = env->NewLocalRef(throwable.get());
             } else {
                 // otherwise we can reuse the embedded V8Exception!
-                env->Throw((jthrowable) env->NewLocalRef(holder->throwable));
+                env->Throw((jthrowable) env->NewLocalRef(throwable.get()));
                 return true;
             }
         }
@@ -494,6 +634,32 @@ Handle<Value> BGJSV8Engine::stringifyJSON(Handle<Object> source) const {
 	return scope.Escape(result);
 }
 
+bool BGJSV8Engine::serialize(Local<Value> value, std::vector<uint8_t> *target) const {
+	ValueSerializer serializer(_isolate);
+	serializer.WriteHeader();
+	if (!serializer.WriteValue(getContext(), value).FromMaybe(false)) {
+		return false;
+	}
+
+	// without a delegate the buffer is allocated with realloc
+	std::pair<uint8_t*, size_t> buffer = serializer.Release();
+	target->assign(buffer.first, buffer.first + buffer.second);
+	free(buffer.first);
+	return true;
+}
+
+MaybeLocal<Value> BGJSV8Engine::deserialize(const uint8_t *data, size_t length) const {
+	EscapableHandleScope scope(_isolate);
+	Local<Context> context = getContext();
+
+	ValueDeserializer deserializer(_isolate, data, length);
+	Local<Value> result;
+	if (!deserializer.ReadHeader(context).FromMaybe(false) || !deserializer.ReadValue(context).ToLocal(&result)) {
+		return MaybeLocal<Value>();
+	}
+	return scope.Escape(result);
+}
+
 Handle<Value> BGJSV8Engine::callFunction(Isolate* isolate, Handle<Object> recv, const char* name,
 		int argc, Handle<Value> argv[]) const {
 	v8::Locker l(isolate);
@@ -580,6 +746,16 @@ MaybeLocal<Value> BGJSV8Engine::require(std::string baseNameStr){
         _moduleCache[baseNameStr].Reset(_isolate, result);
         return handle_scope.Escape(result);
     }
+
+    // WebAssembly modules are compiled and instantiated; their exports are the module
+    if (baseNameStr.length() > 5 && baseNameStr.compare(baseNameStr.length() - 5, 5, ".wasm") == 0) {
+        if (!requireWasm(baseNameStr).ToLocal(&result)) {
+            return MaybeLocal<Value>();
+        }
+        _moduleCache[baseNameStr].Reset(_isolate, result);
+        return handle_scope.Escape(result);
+    }
+
     std::string fileName, pathName;
 
     fileName = baseNameStr;
@@ -709,6 +885,123 @@ MaybeLocal<Value> BGJSV8Engine::require(std::string baseNameStr){
     return maybeLocal;
 }
 
+/**
+ * compiles and instantiates a WebAssembly module from the assets and returns its exports
+ * compiled code is stored in the code cache directory so that later starts only have to deserialize it;
+ * the cache file is keyed by the wire bytes and the v8 version because serialized code is only valid for both
+ */
+MaybeLocal<Value> BGJSV8Engine::requireWasm(const std::string& fileName) {
+    Local<Context> context = _isolate->GetCurrentContext();
+    EscapableHandleScope handle_scope(_isolate);
+
+    unsigned int length = 0;
+    char *wireBytes = loadFile(fileName.c_str(), &length);
+    if (!wireBytes) {
+        _isolate->ThrowException(v8::Exception::Error(String::NewFromUtf8(_isolate, ("Cannot find module '" + fileName + "'").c_str())));
+        return MaybeLocal<Value>();
+    }
+
+    const double start = BGJSFrameScheduler::now();
+
+    std::string cachePath;
+    std::vector<uint8_t> cached;
+    if (!_codeCacheDir.empty()) {
+        std::string flatName = fileName;
+        std::replace(flatName.begin(), flatName.end(), '/', '_');
+        std::stringstream path;
+        path << _codeCacheDir << "/" << flatName << "-" << std::hex
+             << std::hash<std::string>()(std::string(V8::GetVersion()) + std::string(wireBytes, length)) << ".cache";
+        cachePath = path.str();
+
+        FILE *file = fopen(cachePath.c_str(), "rb");
+        if (file) {
+            fseek(file, 0, SEEK_END);
+            const long size = ftell(file);
+            fseek(file, 0, SEEK_SET);
+            if (size > 0) {
+                cached.resize((size_t)size);
+                if (fread(&cached[0], 1, (size_t)size, file) != (size_t)size) {
+                    cached.clear();
+                }
+            }
+            fclose(file);
+        }
+    }
+
+    // v8 falls back to compiling the wire bytes if there is no cached code or it was rejected
+    TryCatch tryCatch(_isolate);
+    Local<WasmCompiledModule> module;
+    const bool compiled = WasmCompiledModule::DeserializeOrCompile(_isolate,
+            WasmCompiledModule::CallerOwnedBuffer(cached.empty() ? nullptr : &cached[0], cached.size()),
+            WasmCompiledModule::CallerOwnedBuffer((const uint8_t*)wireBytes, length)).ToLocal(&module);
+    free((void*) wireBytes);
+
+    if (!compiled) {
+        if (tryCatch.HasCaught()) {
+            tryCatch.ReThrow();
+        } else {
+            _isolate->ThrowException(v8::Exception::Error(String::NewFromUtf8(_isolate, ("Failed to compile WebAssembly module '" + fileName + "'").c_str())));
+        }
+        return MaybeLocal<Value>();
+    }
+
+    if (!cachePath.empty()) {
+        WasmCompiledModule::SerializedModule serialized = module->Serialize();
+        // v8 does not report whether it used the cached code; a rejected cache (different flags or cpu features,
+        // corruption) was compiled from the wire bytes and serializes differently, so it is replaced
+        const bool valid = !cached.empty() && serialized.second == cached.size() &&
+                           memcmp(serialized.first.get(), &cached[0], cached.size()) == 0;
+        if (!valid) {
+            if (!cached.empty()) {
+                LOGI("Code cache %s was rejected", cachePath.c_str());
+            }
+            // write to a unique temporary file first so that neither an interrupted write nor another engine
+            // writing the same module at the same time can leave a truncated cache behind
+            std::vector<char> tmpPath(cachePath.begin(), cachePath.end());
+            const char suffix[] = ".XXXXXX";
+            tmpPath.insert(tmpPath.end(), suffix, suffix + sizeof(suffix));
+            const int fd = mkstemp(&tmpPath[0]);
+            FILE *file = fd != -1 ? fdopen(fd, "wb") : nullptr;
+            if (file) {
+                bool written = fwrite(serialized.first.get(), 1, serialized.second, file) == serialized.second;
+                written = (fclose(file) == 0) && written;
+                if (!written || rename(&tmpPath[0], cachePath.c_str()) != 0) {
+                    unlink(&tmpPath[0]);
+                }
+            } else {
+                if (fd != -1) {
+                    close(fd);
+                    unlink(&tmpPath[0]);
+                }
+                LOGI("Cannot write code cache %s", cachePath.c_str());
+            }
+        }
+    }
+
+    // there is no embedder API for instantiation in this v8 version, so the module is instantiated through the JS API
+    Local<Value> wasm, instanceFn, exports;
+    Local<Object> instance;
+    if (!context->Global()->Get(context, String::NewFromUtf8(_isolate, "WebAssembly")).ToLocal(&wasm) || !wasm->IsObject() ||
+            !wasm.As<Object>()->Get(context, String::NewFromUtf8(_isolate, "Instance")).ToLocal(&instanceFn) || !instanceFn->IsFunction()) {
+        tryCatch.Reset();
+        _isolate->ThrowException(v8::Exception::Error(String::NewFromUtf8(_isolate, "WebAssembly is not supported")));
+        return MaybeLocal<Value>();
+    }
+    Local<Value> args[] = { module, Object::New(_isolate) };
+    if (!instanceFn.As<Function>()->NewInstance(context, 2, args).ToLocal(&instance) ||
+            !instance->Get(context, String::NewFromUtf8(_isolate, "exports")).ToLocal(&exports)) {
+        tryCatch.ReThrow();
+        return MaybeLocal<Value>();
+    }
+
+    if (_debug) {
+        LOGD("required wasm module %s in %.3fms (%zu bytes of cached code)", fileName.c_str(),
+             BGJSFrameScheduler::now() - start, cached.size());
+    }
+
+    return handle_scope.Escape(exports);
+}
+
 v8::Isolate* BGJSV8Engine::getIsolate() const {
     return this->_isolate;
 }
@@ -721,17 +1014,8 @@ v8::Local<v8::Context> BGJSV8Engine::getContext() const {
 void BGJSV8Engine::cancelAnimationFrame(int id) {
 	for (std::set<BGJSGLView*>::iterator it = _glViews.begin();
 			it != _glViews.end(); ++it) {
-		int i = 0;
-		while (i < MAX_FRAME_REQUESTS) {
-			AnimationFrameRequest *request = &((*it)->_frameRequests[i]);
-			if (request->requestId == id && request->valid
-					&& request->view != NULL) {
-				request->valid = false;
-				BGJS_CLEAR_PERSISTENT(request->callback);
-				BGJS_CLEAR_PERSISTENT(request->thisObj);
-				break;
-			}
-			i++;
+		if ((*it)->cancelAnimationFrameForView(id)) {
+			break;
 		}
 	}
 }
@@ -748,47 +1032,73 @@ bool BGJSV8Engine::runAnimationRequests(BGJSGLView* view)  {
 	v8::Locker l(_isolate);
     Isolate::Scope isolateScope(_isolate);
 	HandleScope scope(_isolate);
+	Context::Scope context_scope(getContext());
 
 	TryCatch trycatch;
 	bool didDraw = false;
 
-	AnimationFrameRequest *request;
-	int index = view->_firstFrameRequest, nextIndex = view->_nextFrameRequest,
-			startFrame = view->_firstFrameRequest;
-	while (index != nextIndex) {
-		request = &(view->_frameRequests[index]);
+	BGJSFrameScheduler *scheduler = getFrameScheduler();
+	scheduler->beginFrame();
+	const double frameStart = BGJSFrameScheduler::now();
 
-		if (request->valid) {
-			didDraw = true;
-			request->view->prepareRedraw();
-			Handle<Value> args[0];
+	// take all requests queued so far; requests made by the callbacks are run on the next frame
+	std::vector<AnimationFrameRequest*> requests;
+	requests.swap(view->_frameRequests);
 
-			Handle<Value> result = Local<Object>::New(_isolate, request->callback)->CallAsFunction(
-					Local<Object>::New(_isolate, request->thisObj), 0, args);
+	// DOMHighResTimeStamp: milliseconds on a monotonic clock
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	Handle<Value> args[] = { Number::New(_isolate, now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0) };
 
-			if (result.IsEmpty()) {
-                forwardV8ExceptionToJNI(&trycatch);
-                return false;
-			}
+	size_t index = 0;
+	for (; index < requests.size(); index++) {
+		AnimationFrameRequest *request = requests[index];
 
-			String::Utf8Value fnName(Local<Object>::New(_isolate, request->callback)->ToString());
-			BGJS_CLEAR_PERSISTENT(request->callback);
-			BGJS_CLEAR_PERSISTENT(request->thisObj);
+		if (!request->valid) {
+			delete request;
+			continue;
+		}
 
-			request->view->endRedraw();
-			request->valid = false;
-			request->view = NULL;
+		// all callbacks of one frame draw into the same buffer
+		if (!didDraw) {
+			didDraw = true;
+			view->_frameCount++;
+			view->prepareRedraw();
 		}
 
-		index = (index + 1) % MAX_FRAME_REQUESTS;
+		view->_frameRequestIndex.erase(request->requestId);
+		request->valid = false;
+
+		Local<Object> callback = Local<Object>::New(_isolate, request->callback);
+		Local<Object> thisObj = Local<Object>::New(_isolate, request->thisObj);
+		BGJS_CLEAR_PERSISTENT(request->callback);
+		BGJS_CLEAR_PERSISTENT(request->thisObj);
+		delete request;
+
+		Handle<Value> result = callback->CallAsFunction(thisObj, 1, args);
+
+		if (result.IsEmpty()) {
+			// requests that did not run yet are kept for the next frame
+			index++;
+			view->_frameRequests.insert(view->_frameRequests.begin(), requests.begin() + index, requests.end());
+			view->endRedraw();
+			if (!view->_frameRequests.empty()) {
+				view->requestRefresh();
+			}
+			scheduler->account(BGJSWorkClass::kAnimationFrame, BGJSFrameScheduler::now() - frameStart);
+			forwardV8ExceptionToJNI(&trycatch);
+			return false;
+		}
 	}
-	while (index != nextIndex)
-		;
+	scheduler->account(BGJSWorkClass::kAnimationFrame, BGJSFrameScheduler::now() - frameStart);
 
-	view->_firstFrameRequest = nextIndex;
+	// whatever is left of the frame budget can be used for releasing collected objects
+	runIdleWork();
 
-	// If we couldn't draw anything, request that we can the next time
-	if (!didDraw) {
+	if (didDraw) {
+		view->endRedraw();
+	} else {
+		// If we couldn't draw anything, request that we can the next time
 		view->call(view->_cbRedraw);
 	}
 	return didDraw;
@@ -915,6 +1225,7 @@ void BGJSV8Engine::setTimeoutInt(const v8::FunctionCallbackInfo<v8::Value>& args
 
 		WrapPersistentFunc* ws = new WrapPersistentFunc();
 		BGJS_RESET_PERSISTENT(ctx->getIsolate(), ws->callbackFunc, callback);
+		ws->cancelled = false;
 		WrapPersistentObj* wo = new WrapPersistentObj();
 		BGJS_RESET_PERSISTENT(ctx->getIsolate(), wo->obj, args.This());
 
@@ -929,7 +1240,7 @@ void BGJSV8Engine::setTimeoutInt(const v8::FunctionCallbackInfo<v8::Value>& args
 
 		assert(ctx->_jniV8Engine.setTimeoutId);
 		assert(ctx->_jniV8Engine.clazz);
-		int subId = env->CallStaticIntMethod(ctx->_jniV8Engine.clazz, ctx->_jniV8Engine.setTimeoutId, (jlong) ws,
+		int subId = env->CallIntMethod(ctx->getJObject(), ctx->_jniV8Engine.setTimeoutId, (jlong) ws,
 				(jlong) wo, timeout, (jboolean) recurring);
         args.GetReturnValue().Set(subId);
 	} else {
@@ -969,7 +1280,11 @@ void BGJSV8Engine::clearTimeoutInt(const v8::FunctionCallbackInfo<v8::Value>& ar
 			return;
 		}
 
-		env->CallStaticVoidMethod(ctx->_jniV8Engine.clazz, ctx->_jniV8Engine.removeTimeoutId, (jint) id);
+		// the callback is only released by the next cleanup of the java side, so it is still valid here
+		WrapPersistentFunc* ws = (WrapPersistentFunc*)env->CallLongMethod(ctx->getJObject(), ctx->_jniV8Engine.removeTimeoutId, (jint) id);
+		if (ws) {
+			ws->cancelled = true;
+		}
 	} else {
         ctx->getIsolate()->ThrowException(
     				v8::Exception::ReferenceError(
@@ -1000,10 +1315,14 @@ void BGJSV8Engine::initJNICache() {
     _jniV8Engine.clazz = (jclass)env->NewGlobalRef(env->FindClass("ag/boersego/bgjs/V8Engine"));
     _jniV8Engine.enqueueOnNextTick = env->GetMethodID(_jniV8Engine.clazz, "enqueueOnNextTick",
                                             "(Lag/boersego/bgjs/JNIV8Function;)Z");
-    _jniV8Engine.setTimeoutId = env->GetStaticMethodID(_jniV8Engine.clazz, "setTimeout",
-                                                       "(JJJZ)I");
-    _jniV8Engine.removeTimeoutId = env->GetStaticMethodID(_jniV8Engine.clazz, "removeTimeout",
-                                                          "(I)V");
+    _jniV8Engine.setTimeoutId = env->GetMethodID(_jniV8Engine.clazz, "setTimeoutInst",
+                                                 "(JJJZ)I");
+    _jniV8Engine.removeTimeoutId = env->GetMethodID(_jniV8Engine.clazz, "removeTimeoutInst",
+                                                    "(I)J");
+    _jniV8Engine.doAjaxRequestId = env->GetMethodID(_jniV8Engine.clazz, "doAjaxRequestInst",
+                                                    "(Ljava/lang/String;JJJLjava/lang/String;Ljava/lang/String;Z)V");
+    _jniV8Engine.runAsyncJavaCallId = env->GetMethodID(_jniV8Engine.clazz, "runAsyncJavaCall", "(J)V");
+    _jniV8Engine.requestIdleWorkId = env->GetMethodID(_jniV8Engine.clazz, "requestIdleWork", "()V");
 }
 
 BGJSV8Engine::BGJSV8Engine(jobject obj, JNIClassInfo *info) : JNIObject(obj, info) {
@@ -1012,6 +1331,9 @@ BGJSV8Engine::BGJSV8Engine(jobject obj, JNIClassInfo *info) : JNIObject(obj, inf
     _nextEmbedderDataIndex = EBGJSV8EngineEmbedderData::FIRST_UNUSED;
     _javaAssetManager = nullptr;
     _isolate = NULL;
+    _isolateHost = nullptr;
+    _isolateOwner = nullptr;
+    pthread_mutex_init(&_asyncJavaCallsMutex, NULL);
 }
 
 void BGJSV8Engine::initializeJNIBindings(JNIClassInfo *info, bool isReload) {
@@ -1023,29 +1345,8 @@ void BGJSV8Engine::setAssetManager(jobject jAssetManager) {
     _javaAssetManager = env->NewGlobalRef(jAssetManager);
 }
 
-void BGJSV8Engine::createContext() {
-	static bool isPlatformInitialized = false;
-
-	if(!isPlatformInitialized) {
-		isPlatformInitialized = true;
-		LOGI("Creating default platform");
-		v8::Platform *platform = v8::platform::CreateDefaultPlatform();
-		LOGD("Created default platform %p", platform);
-		v8::V8::InitializePlatform(platform);
-		LOGD("Initialized platform");
-		v8::V8::Initialize();
-		LOGD("Initialized v8: %s", v8::V8::GetVersion());
-	}
-
-	v8::Isolate::CreateParams create_params;
-	create_params.array_buffer_allocator =
-			v8::ArrayBuffer::Allocator::NewDefaultAllocator();
-
-	_isolate = v8::Isolate::New(create_params);
-
-	v8::Locker l(_isolate);
-	Isolate::Scope isolate_scope(_isolate);
-	HandleScope scope(_isolate);
+v8::Local<v8::ObjectTemplate> BGJSV8Engine::createGlobalTemplate() {
+	EscapableHandleScope scope(_isolate);
 
 	// Create global object template
 	v8::Local<v8::ObjectTemplate> globalObjTpl = v8::ObjectTemplate::New();
@@ -1100,6 +1401,55 @@ void BGJSV8Engine::createContext() {
 	globalObjTpl->Set(String::NewFromUtf8(_isolate, "clearInterval"),
 				v8::FunctionTemplate::New(_isolate, BGJSV8Engine::js_global_clearInterval, Local<Value>(), Local<Signature>(), 0, ConstructorBehavior::kThrow));
 
+	return scope.Escape(globalObjTpl);
+}
+
+void BGJSV8Engine::createContext(BGJSV8Engine *isolateHost) {
+	static bool isPlatformInitialized = false;
+
+	if(!isPlatformInitialized) {
+		isPlatformInitialized = true;
+		LOGI("Creating default platform");
+		v8::Platform *platform = v8::platform::CreateDefaultPlatform();
+		LOGD("Created default platform %p", platform);
+		v8::V8::InitializePlatform(platform);
+		LOGD("Initialized platform");
+		v8::V8::Initialize();
+		LOGD("Initialized v8: %s", v8::V8::GetVersion());
+	}
+
+	if(isolateHost) {
+		// share the isolate (heap, compilation cache, array buffer allocator, templates and class infos) with the host;
+		// this engine only gets its own context, global, module cache and timers
+		_isolateHost = isolateHost;
+		_isolateHost->retainJObject();
+		_isolate = isolateHost->getIsolate();
+	} else {
+		v8::Isolate::CreateParams create_params;
+		create_params.array_buffer_allocator =
+				v8::ArrayBuffer::Allocator::NewDefaultAllocator();
+
+		_isolate = v8::Isolate::New(create_params);
+		_isolateOwner = new BGJSIsolateOwner(_isolate, create_params.array_buffer_allocator);
+
+		// the host owns the queue of the isolate and drains it on its own thread
+		_finalizationQueue.setListener(&BGJSV8Engine::FinalizationQueueListener, this);
+	}
+
+	v8::Locker l(_isolate);
+	Isolate::Scope isolate_scope(_isolate);
+	HandleScope scope(_isolate);
+
+	// the global template only contains callbacks that look up the engine of the current context,
+	// so it is created once per isolate
+	v8::Local<v8::ObjectTemplate> globalObjTpl;
+	if(_isolateHost) {
+		globalObjTpl = Local<ObjectTemplate>::New(_isolate, _isolateHost->_globalObjTpl);
+	} else {
+		globalObjTpl = createGlobalTemplate();
+		_globalObjTpl.Reset(_isolate, globalObjTpl);
+	}
+
 	// Create a new context.
     Local<Context> context = v8::Context::New(_isolate, NULL, globalObjTpl);
 	context->SetAlignedPointerInEmbedderData(EBGJSV8EngineEmbedderData::kContext, this);
@@ -1214,6 +1564,10 @@ void BGJSV8Engine::setDebug(bool debug) {
     _debug = debug;
 }
 
+void BGJSV8Engine::setCodeCacheDir(const char* path) {
+    _codeCacheDir = path ? path : "";
+}
+
 char* BGJSV8Engine::loadFile(const char* path, unsigned int* length) const {
     JNIEnv* env = JNIWrapper::getEnvironment();
     AAssetManager* mgr = AAssetManager_fromJava(env, _javaAssetManager);
@@ -1245,28 +1599,102 @@ char* BGJSV8Engine::loadFile(const char* path, unsigned int* length) const {
 BGJSV8Engine::~BGJSV8Engine() {
 	LOGI("Cleaning up");
 
+	if (!_isolateHost) {
+		// weak callbacks may still enqueue on other threads; once this returns none of them calls back into this engine
+		_finalizationQueue.setListener(nullptr, nullptr);
+	}
+
     JNIEnv* env = JNIWrapper::getEnvironment();
     env->DeleteGlobalRef(_javaAssetManager);
 
-	// clear persistent references
-	_context.Reset();
-    _requireFn.Reset();
-    _makeRequireFn.Reset();
-    _jsonParseFn.Reset();
-    _jsonStringifyFn.Reset();
-    _makeJavaErrorFn.Reset();
-    _getStackTraceFn.Reset();
-
 	if (_locale) {
 		free(_locale);
 	}
-    this->_isolate->Exit();
 
 	for(auto &it : _javaModules) {
 		env->DeleteGlobalRef(it.second);
 	}
 
-	JNIV8Wrapper::cleanupV8Engine(this);
+	// the isolate is never created if the engine was shut down before its thread started
+	if (_isolate) {
+		// the destructor can run on any thread; persistent handles may only be reset while the isolate is locked
+		v8::Locker locker(_isolate);
+		Isolate::Scope isolateScope(_isolate);
+
+		// results of async java calls that were never delivered; their promises belong to the context released below
+		// calls still running on an executor keep the java engine reachable, so none of them can be in flight here
+		pthread_mutex_lock(&_asyncJavaCallsMutex);
+		std::set<JNIV8AsyncJavaCall*> asyncJavaCalls;
+		asyncJavaCalls.swap(_asyncJavaCalls);
+		pthread_mutex_unlock(&_asyncJavaCallsMutex);
+		for(JNIV8AsyncJavaCall *call : asyncJavaCalls) {
+			JNIV8ClassInfo::dropAsyncJavaCall(env, call);
+		}
+
+		releaseContext();
+
+		if (!_isolateHost) {
+			_globalObjTpl.Reset();
+			JNIV8Wrapper::cleanupV8Engine(this);
+			JNIV8ArrayBuffer::releaseByteBuffers(_isolate, true);
+		}
+	}
+	pthread_mutex_destroy(&_asyncJavaCallsMutex);
+
+	if (_isolateHost) {
+		// the isolate, the class infos and the finalization queue belong to the host engine
+		_isolateHost->releaseJObject();
+		_isolateHost = nullptr;
+	} else {
+		// nothing may stay queued once the engine is gone
+		_finalizationQueue.drain(_finalizationQueue.depth());
+
+		// wrappers that are finalized after the engine still reset their handles; the last one disposes the isolate
+		if (_isolateOwner) {
+			_isolateOwner->release();
+			_isolateOwner = nullptr;
+		}
+	}
+}
+
+void BGJSV8Engine::releaseContext() {
+	for(auto &it : _moduleCache) {
+		it.second.Reset();
+	}
+	_moduleCache.clear();
+
+	_context.Reset();
+	_requireFn.Reset();
+	_makeRequireFn.Reset();
+	_jsonParseFn.Reset();
+	_jsonStringifyFn.Reset();
+	_makeJavaErrorFn.Reset();
+	_getStackTraceFn.Reset();
+}
+
+void BGJSV8Engine::shutdown() {
+	JNIEnv* env = JNIWrapper::getEnvironment();
+
+	// modules usually reference the java engine
+	for(auto &it : _javaModules) {
+		env->DeleteGlobalRef(it.second);
+	}
+	_javaModules.clear();
+
+	{
+		v8::Locker locker(_isolate);
+		Isolate::Scope isolateScope(_isolate);
+
+		releaseContext();
+
+		// java wrappers are strongly referenced as long as their js objects are alive; without a gc the js objects
+		// of the released context would keep them - and through them the java engine - alive forever
+		_isolate->LowMemoryNotification();
+	}
+
+	// the weak callbacks of the gc queued the references; nothing drains the queue after the engine thread ended
+	BGJSFinalizationQueue *queue = getFinalizationQueue();
+	queue->drain(queue->depth());
 }
 
 void BGJSV8Engine::enqueueNextTick(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -1276,6 +1704,33 @@ void BGJSV8Engine::enqueueNextTick(const v8::FunctionCallbackInfo<v8::Value>& ar
     env->CallBooleanMethod(getJObject(), _jniV8Engine.enqueueOnNextTick, wrappedFunction.get()->getJObject());
 }
 
+void BGJSV8Engine::doAjaxRequest(jstring url, jlong callbackPtr, jlong thisPtr, jlong errorPtr,
+								 jstring data, jstring method, bool processData) {
+    JNIEnv* env = JNIWrapper::getEnvironment();
+    env->CallVoidMethod(getJObject(), _jniV8Engine.doAjaxRequestId, url, callbackPtr, thisPtr, errorPtr,
+                        data, method, (jboolean)processData);
+}
+
+void BGJSV8Engine::startAsyncJavaCall(JNIV8AsyncJavaCall *call) {
+    pthread_mutex_lock(&_asyncJavaCallsMutex);
+    _asyncJavaCalls.insert(call);
+    pthread_mutex_unlock(&_asyncJavaCallsMutex);
+
+    JNIEnv* env = JNIWrapper::getEnvironment();
+    env->CallVoidMethod(getJObject(), _jniV8Engine.runAsyncJavaCallId, (jlong)call);
+    if(env->ExceptionCheck()) {
+        // not handed to an executor; the caller still owns the call
+        finishAsyncJavaCall(call);
+    }
+}
+
+bool BGJSV8Engine::finishAsyncJavaCall(JNIV8AsyncJavaCall *call) {
+    pthread_mutex_lock(&_asyncJavaCallsMutex);
+    const bool registered = _asyncJavaCalls.erase(call) > 0;
+    pthread_mutex_unlock(&_asyncJavaCallsMutex);
+    return registered;
+}
+
 void BGJSV8Engine::trace(const FunctionCallbackInfo<Value> &args) {
     v8::Locker locker(args.GetIsolate());
     HandleScope scope(args.GetIsolate());
@@ -1315,6 +1770,48 @@ Java_ag_boersego_bgjs_V8Engine_parseJSON(JNIEnv *env, jobject obj, jstring json)
     return JNIV8Marshalling::v8value2jobject(value);
 }
 
+static jobject deserializeToJava(BGJSV8Engine *engine, const uint8_t *data, size_t length) {
+    v8::Isolate* isolate = engine->getIsolate();
+    v8::Locker l(isolate);
+    v8::Isolate::Scope isolateScope(isolate);
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = engine->getContext();
+    v8::Context::Scope ctxScope(context);
+
+    v8::TryCatch try_catch;
+    v8::Local<v8::Value> value;
+    if(!engine->deserialize(data, length).ToLocal(&value)) {
+        engine->forwardV8ExceptionToJNI(&try_catch);
+        return nullptr;
+    }
+    return JNIV8Marshalling::v8value2jobject(value);
+}
+
+JNIEXPORT jobject JNICALL
+Java_ag_boersego_bgjs_V8Engine_deserializeBytes(JNIEnv *env, jobject obj, jbyteArray data, jint offset, jint length) {
+    auto engine = JNIWrapper::wrapObject<BGJSV8Engine>(obj);
+
+    // the deserializer allocates js objects while reading, so the data is copied instead of pinning the array
+    std::vector<uint8_t> bytes((size_t)length);
+    if(length > 0) {
+        env->GetByteArrayRegion(data, offset, length, (jbyte*)&bytes[0]);
+        if(env->ExceptionCheck()) return nullptr;
+    }
+    return deserializeToJava(engine.get(), bytes.data(), bytes.size());
+}
+
+JNIEXPORT jobject JNICALL
+Java_ag_boersego_bgjs_V8Engine_deserializeDirect(JNIEnv *env, jobject obj, jobject buffer, jint offset, jint length) {
+    auto engine = JNIWrapper::wrapObject<BGJSV8Engine>(obj);
+
+    const uint8_t *data = (const uint8_t*)env->GetDirectBufferAddress(buffer);
+    if(!data) {
+        env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"), "ByteBuffer must be direct");
+        return nullptr;
+    }
+    return deserializeToJava(engine.get(), data + offset, (size_t)length);
+}
+
 JNIEXPORT jobject JNICALL
 Java_ag_boersego_bgjs_V8Engine_require(JNIEnv *env, jobject obj, jstring file) {
     auto engine = JNIWrapper::wrapObject<BGJSV8Engine>(obj);
@@ -1337,14 +1834,39 @@ Java_ag_boersego_bgjs_V8Engine_require(JNIEnv *env, jobject obj, jstring file) {
     return JNIV8Marshalling::v8value2jobject(value.ToLocalChecked());
 }
 
+JNIEXPORT void JNICALL
+Java_ag_boersego_bgjs_V8Engine_setCodeCacheDir(JNIEnv *env, jobject obj, jstring path) {
+    auto engine = JNIWrapper::wrapObject<BGJSV8Engine>(obj);
+    engine->setCodeCacheDir(path ? JNIWrapper::jstring2string(path).c_str() : nullptr);
+}
+
+// lock() and unlock() bracket the execution of the nextTick queue on the java side
+struct BGJSV8EngineLock {
+    BGJSV8EngineLock(v8::Isolate *isolate) : locker(isolate), start(BGJSFrameScheduler::now()) {}
+    v8::Locker locker;
+    double start;
+};
+
 JNIEXPORT jlong JNICALL
 Java_ag_boersego_bgjs_V8Engine_lock(JNIEnv *env, jobject obj) {
     auto engine = JNIWrapper::wrapObject<BGJSV8Engine>(obj);
 
     v8::Isolate *isolate = engine->getIsolate();
-    v8::Locker *locker = new Locker(isolate);
+    BGJSV8EngineLock *lock = new BGJSV8EngineLock(isolate);
 
-    return (jlong)locker;
+    return (jlong)lock;
+}
+
+JNIEXPORT jint JNICALL
+Java_ag_boersego_bgjs_V8Engine_createV8Key(JNIEnv *env, jobject obj, jstring name) {
+    auto engine = JNIWrapper::wrapObject<BGJSV8Engine>(obj);
+
+    v8::Isolate* isolate = engine->getIsolate();
+    v8::Locker l(isolate);
+    v8::Isolate::Scope isolateScope(isolate);
+    v8::HandleScope scope(isolate);
+
+    return engine->createPropertyKey(JNIWrapper::jstring2string(name));
 }
 
 JNIEXPORT jobject JNICALL
@@ -1363,8 +1885,12 @@ Java_ag_boersego_bgjs_V8Engine_getGlobalObject(JNIEnv *env, jobject obj) {
 
 JNIEXPORT void JNICALL
 Java_ag_boersego_bgjs_V8Engine_unlock(JNIEnv *env, jobject obj, jlong lockerPtr) {
-    v8::Locker *locker = reinterpret_cast<Locker *>(lockerPtr);
-    delete(locker);
+    auto engine = JNIWrapper::wrapObject<BGJSV8Engine>(obj);
+    BGJSV8EngineLock *lock = reinterpret_cast<BGJSV8EngineLock *>(lockerPtr);
+    engine->getFrameScheduler()->account(BGJSWorkClass::kMicrotask, BGJSFrameScheduler::now() - lock->start);
+    // the nextTick queue is empty at this point => release what the gc collected meanwhile
+    engine->runIdleWork();
+    delete(lock);
 }
 
 JNIEXPORT jobject JNICALL
@@ -3,13 +3,19 @@
 
 #include <v8.h>
 #include <jni.h>
+#include <atomic>
 #include <map>
+#include <pthread.h>
 #include <string>
 #include <set>
+#include <vector>
 #include <mallocdebug.h>
 
 #include "os-android.h"
 #include "BGJSModule.h"
+#include "BGJSFrameScheduler.h"
+#include "BGJSFinalizationQueue.h"
+#include "EJExternalMemory.h"
 
 #include "../jni/jni.h"
 
@@ -22,17 +28,41 @@
  */
 
 class BGJSGLView;
-
-#define MAX_FRAME_REQUESTS 10
+struct JNIV8AsyncJavaCall;
 
 struct WrapPersistentFunc {
 	v8::Persistent<v8::Function> callbackFunc;
+	// set by clearTimeout; the record of a timer can already be waiting in a callback batch
+	bool cancelled;
 };
 
 struct WrapPersistentObj {
 	v8::Persistent<v8::Object> obj;
 };
 
+/**
+ * BGJSIsolateOwner
+ * Disposes the isolate of a host engine once the engine and all native wrappers holding handles of it are gone.
+ * Java wrappers and their engine are finalized in no particular order, so wrappers can outlive the engine.
+ */
+class BGJSIsolateOwner {
+public:
+	BGJSIsolateOwner(v8::Isolate *isolate, v8::ArrayBuffer::Allocator *allocator);
+
+	void retain();
+	/**
+	 * the last release disposes the isolate; it must not be locked or entered by any thread at that point
+	 */
+	void release();
+
+private:
+	~BGJSIsolateOwner();
+
+	std::atomic<int> _refCount;
+	v8::Isolate *_isolate;
+	v8::ArrayBuffer::Allocator *_allocator;
+};
+
 typedef  void (*requireHook) (class BGJSV8Engine* engine, v8::Handle<v8::Object> target);
 
 typedef enum EBGJSV8EngineEmbedderData {
@@ -49,10 +79,63 @@ public:
 	void setAssetManager(jobject jAssetManager);
 
 	/**
-	 * returns the engine instance for the specified isolate
+	 * returns the engine instance for the current context of the specified isolate
+	 * if multiple engines share an isolate, each of them owns one context
 	 */
 	static BGJSV8Engine* GetInstance(v8::Isolate* isolate);
 
+	/**
+	 * returns the engine that created the isolate this engine runs on (which can be the engine itself)
+	 */
+	BGJSV8Engine* getIsolateHost();
+	const BGJSV8Engine* getIsolateHost() const;
+
+	/**
+	 * returns the owner of the isolate this engine runs on; native wrappers retain it while they hold handles
+	 */
+	BGJSIsolateOwner* getIsolateOwner();
+
+	/**
+	 * returns the scheduler pacing work against the animation frames of this engines isolate
+	 */
+	BGJSFrameScheduler* getFrameScheduler();
+
+	/**
+	 * returns the queue collecting java references released by weak callbacks of this engines isolate
+	 */
+	BGJSFinalizationQueue* getFinalizationQueue() const;
+
+	/**
+	 * returns the memory held by native canvas resources created for this engine
+	 */
+	EJExternalMemory* getExternalMemory();
+
+	/**
+	 * called at idle points of the engine thread, with the isolate locked
+	 * - passes memory allocated or freed by native canvas resources on to the gc
+	 * - releases a bounded batch of queued references; the batch is skipped while the current frame has no
+	 *   budget left, unless the queue grew too long
+	 */
+	void runIdleWork();
+
+	/**
+	 * returns the private symbol under which js objects store the cache of their java wrapper
+	 * the symbol is shared by all engines running on the same isolate
+	 */
+	v8::Local<v8::Private> getWrapperCacheKey();
+
+	/**
+	 * returns the index of the internalized property key for the specified name, creating it if necessary
+	 * keys stay valid for the lifetime of the isolate and are used by java V8Key handles
+	 * the table is shared by all engines running on the same isolate
+	 */
+	int createPropertyKey(const std::string& name);
+
+	/**
+	 * returns the property key stored at the specified index, or an empty handle if there is none
+	 */
+	v8::Local<v8::String> getPropertyKey(int index);
+
     v8::MaybeLocal<v8::Value> require(std::string baseNameStr);
     uint8_t requestEmbedderDataIndex();
     bool registerModule(const char *name, requireHook f);
@@ -74,6 +157,12 @@ public:
 	float getDensity() const;
 	void setDebug(bool debug);
 
+	/**
+	 * sets the directory used to cache compiled WebAssembly modules
+	 * if it is not set, modules are compiled every time they are required
+	 */
+	void setCodeCacheDir(const char* path);
+
 	char* loadFile(const char* path, unsigned int* length = nullptr) const;
 
 	static void js_global_requestAnimationFrame (const v8::FunctionCallbackInfo<v8::Value>&);
@@ -101,7 +190,25 @@ public:
 	v8::Handle<v8::Value> parseJSON(v8::Handle<v8::String> source) const;
 	v8::Handle<v8::Value> stringifyJSON(v8::Handle<v8::Object> source) const;
 
-	void createContext();
+	/**
+	 * converts a value to / from the binary format of v8::ValueSerializer (structured clone), see V8ValueCodec.java
+	 * on failure an exception is thrown in the current context and an empty handle / false is returned
+	 */
+	bool serialize(v8::Local<v8::Value> value, std::vector<uint8_t> *target) const;
+	v8::MaybeLocal<v8::Value> deserialize(const uint8_t *data, size_t length) const;
+
+	/**
+	 * creates the isolate and the context of this engine
+	 * if a host engine is specified, its isolate is used instead and only a new context is created
+	 */
+	void createContext(BGJSV8Engine *isolateHost = nullptr);
+
+	/**
+	 * releases the context and everything it keeps alive; called on the engine thread right before it ends
+	 * java wrappers only referenced by js are released immediately, so that the java engine - and once all of its
+	 * wrappers were finalized, the isolate - can be collected
+	 */
+	void shutdown();
 
 	/**
      * cache JNI class references
@@ -110,12 +217,33 @@ public:
 
     void trace(const v8::FunctionCallbackInfo<v8::Value> &info);
 
+	/**
+	 * starts an ajax request on the java side of this engine
+	 */
+	void doAjaxRequest(jstring url, jlong callbackPtr, jlong thisPtr, jlong errorPtr,
+					   jstring data, jstring method, bool processData);
+
+	/**
+	 * hands a call of an async java method to the executor of this engine
+	 * the result is delivered back to the engine thread in a callback batch
+	 * the call stays registered with the engine until finishAsyncJavaCall is called;
+	 * calls that are still registered when the engine is destroyed are dropped without settling their promise
+	 */
+	void startAsyncJavaCall(JNIV8AsyncJavaCall *call);
+
+	/**
+	 * unregisters a call started with startAsyncJavaCall
+	 * returns false if the call was not registered (anymore)
+	 */
+	bool finishAsyncJavaCall(JNIV8AsyncJavaCall *call);
+
     bool _debug;
 private:
 	// called by JNIWrapper
 	static void initializeJNIBindings(JNIClassInfo *info, bool isReload);
 
 	static void JavaModuleRequireCallback(BGJSV8Engine *engine, v8::Handle<v8::Object> target);
+	static void FinalizationQueueListener(void *data);
 	static struct {
 		jclass clazz;
 		jmethodID getNameId;
@@ -143,6 +271,9 @@ private:
 		jmethodID removeTimeoutId;
 		jmethodID setTimeoutId;
 		jmethodID enqueueOnNextTick;
+		jmethodID doAjaxRequestId;
+		jmethodID runAsyncJavaCallId;
+		jmethodID requestIdleWorkId;
 	} _jniV8Engine;
 
 	char *_locale;		// de_DE
@@ -157,7 +288,26 @@ private:
 
     void enqueueNextTick(const v8::FunctionCallbackInfo<v8::Value>&);
 
+	// resets the context, the module cache and the cached functions; the isolate has to be locked
+	void releaseContext();
+
+	v8::MaybeLocal<v8::Value> requireWasm(const std::string& fileName);
+	std::string _codeCacheDir;
+
 	v8::Persistent<v8::Context> _context;
+	v8::Persistent<v8::ObjectTemplate> _globalObjTpl;
+	BGJSV8Engine *_isolateHost;
+	// only set on the host engine
+	BGJSIsolateOwner *_isolateOwner;
+	BGJSFrameScheduler _frameScheduler;
+	// the queue is thread safe; it is filled from const methods that hand java references to js
+	mutable BGJSFinalizationQueue _finalizationQueue;
+	EJExternalMemory _externalMemory;
+	v8::Eternal<v8::Private> _wrapperCacheKey;
+	// only used on the host engine, see createPropertyKey
+	std::vector<v8::Eternal<v8::String>> _propertyKeys;
+	std::map<std::string, int> _propertyKeyIndices;
+	v8::Local<v8::ObjectTemplate> createGlobalTemplate();
 
 	// Attributes
 	std::map<std::string, jobject> _javaModules;
@@ -173,6 +323,10 @@ private:
 
 	std::set<BGJSGLView*> _glViews;
 
+	// async java calls that were started but not resolved or dropped yet; finished from executor threads after shutdown
+	std::set<JNIV8AsyncJavaCall*> _asyncJavaCalls;
+	pthread_mutex_t _asyncJavaCallsMutex;
+
 	int _nextTimerId;
 };
 
@@ -18,11 +18,13 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <vector>
 #include <v8.h>
 
 #include "BGJSV8Engine.h"
 #include "modules/AjaxModule.h"
 #include "modules/BGJSGLModule.h"
+#include "EJExternalMemory.h"
 
 #include "jniext.h"
 #include "../jni/JNIWrapper.h"
@@ -53,7 +55,10 @@ jint JNI_OnLoad(JavaVM* vm, void* reserved)  {
 
 JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_initialize(
 		JNIEnv * env, jobject obj, jobject assetManager, jobject v8Engine, jstring locale, jstring lang,
-        jstring timezone, jfloat density, jstring deviceClass, jboolean debug) {
+        jstring timezone, jfloat density, jstring deviceClass, jboolean debug, jobject isolateHost) {
+
+	// resolves the JNI caches unless this already happened, e.g. through V8Engine.prewarm()
+	JNIV8Wrapper::initJNICaches();
 
 	auto ct = JNIV8Wrapper::wrapObject<BGJSV8Engine>(v8Engine);
 	ct->setAssetManager(assetManager);
@@ -69,7 +74,16 @@ JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_initialize(
 	env->ReleaseStringUTFChars(lang, langStr);
 	env->ReleaseStringUTFChars(timezone, tzStr);
     env->ReleaseStringUTFChars(deviceClass, deviceClassStr);
-	ct->createContext();
+	if (isolateHost) {
+		auto host = JNIWrapper::wrapObject<BGJSV8Engine>(isolateHost);
+		if (!host || !host->getIsolate()) {
+			env->ThrowNew(env->FindClass("java/lang/RuntimeException"), "Isolate host engine has not been initialized");
+			return;
+		}
+		ct->createContext(host->getIsolateHost());
+	} else {
+		ct->createContext();
+	}
 	LOGD("BGJS context created");
 
 	ct->registerModule("ajax", AjaxModule::doRequire);
@@ -77,19 +91,16 @@ JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_initialize(
 	LOGD("ClientAndroid init: registerModule done");
 }
 
-JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_timeoutCB(
-		JNIEnv * env, jobject obj, jobject engine, jlong jsCbPtr, jlong thisPtr, jboolean cleanup, jboolean runCb) {
-	auto context = JNIWrapper::wrapObject<BGJSV8Engine>(engine);
-    v8::Isolate* isolate = context->getIsolate();
-    v8::Locker l (isolate);
-	Isolate::Scope isolateScope(isolate);
-	if (DEBUG) {
-		LOGD("clientAndroid timeoutCB");
-	}
-	HandleScope scope (isolate);
-	Context::Scope context_scope(context->getContext());
+JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_prewarm(JNIEnv * env, jobject obj) {
+	JNIV8Wrapper::initJNICaches();
+}
 
-	TryCatch trycatch;
+/**
+ * runs and/or cleans up a timer callback
+ * all v8 scopes have to be set up by the caller; exceptions are left in the callers TryCatch
+ */
+static void runTimeoutCallback(BGJSV8Engine *context, jlong jsCbPtr, jlong thisPtr, bool cleanup, bool runCb) {
+	v8::Isolate* isolate = context->getIsolate();
 
 	// Persistent<Function>* callbackPers = (Persistent<Function>*) jsCbPtr;
 	WrapPersistentObj* wo = (WrapPersistentObj*)thisPtr;
@@ -97,15 +108,11 @@ JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_timeoutCB(
 	WrapPersistentFunc* ws = (WrapPersistentFunc*)jsCbPtr;
 	Local<Function> callbackP = Local<Function>::New(isolate, *reinterpret_cast<Local<Function>*>(&ws->callbackFunc));
 
-
-	if (runCb) {
+	if (runCb && !ws->cancelled) {
 		int argcount = 0;
 		Handle<Value> argarray[] = { };
 
-		Handle<Value> result = callbackP->Call(thisObj, argcount, argarray);
-		if (result.IsEmpty()) {
-			context->forwardV8ExceptionToJNI(&trycatch);
-		}
+		callbackP->Call(thisObj, argcount, argarray);
 		if (DEBUG) {
 			LOGI("timeoutCb finished");
 		}
@@ -122,6 +129,59 @@ JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_timeoutCB(
 	}
 }
 
+/**
+ * calls an event callback with a single boolean argument
+ * all v8 scopes have to be set up by the caller; exceptions are left in the callers TryCatch
+ */
+static void runBooleanCallback(BGJSV8Engine *context, jlong cbPtr, jlong thisPtr, bool b) {
+	v8::Isolate* isolate = context->getIsolate();
+
+	Persistent<Function>* fnPersist = static_cast<Persistent<Function>*>((void*)cbPtr);
+	Persistent<Object>* thisObjPersist = static_cast<Persistent<Object>*>((void*)thisPtr);
+	Local<Function> fn = (*reinterpret_cast<Local<Function>*>(fnPersist));
+	Local<Object> thisObj = (*reinterpret_cast<Local<Object>*>(thisObjPersist));
+
+	int argcount = 1;
+	Handle<Value> argarray[] = { Boolean::New(isolate, b)};
+
+	fn->Call(thisObj, argcount, argarray);
+	// TODO: Don't we need to clean up these persistents?
+	// => No, because they are pointers to a persistent that is stored elsewhere?!
+}
+
+JNIEXPORT jboolean JNICALL Java_ag_boersego_bgjs_ClientAndroid_timeoutCB(
+		JNIEnv * env, jobject obj, jobject engine, jlong jsCbPtr, jlong thisPtr, jboolean cleanup, jboolean runCb) {
+	auto context = JNIWrapper::wrapObject<BGJSV8Engine>(engine);
+
+	// timers have to wait if they would delay the next animation frame
+	BGJSFrameScheduler *scheduler = context->getFrameScheduler();
+	if (runCb && scheduler->shouldDefer(BGJSWorkClass::kTimer)) {
+		return JNI_FALSE;
+	}
+
+    v8::Isolate* isolate = context->getIsolate();
+    v8::Locker l (isolate);
+	Isolate::Scope isolateScope(isolate);
+	if (DEBUG) {
+		LOGD("clientAndroid timeoutCB");
+	}
+	HandleScope scope (isolate);
+	Context::Scope context_scope(context->getContext());
+
+	TryCatch trycatch;
+
+	const double start = BGJSFrameScheduler::now();
+	runTimeoutCallback(context.get(), jsCbPtr, thisPtr, cleanup, runCb);
+	if (runCb) {
+		scheduler->account(BGJSWorkClass::kTimer, BGJSFrameScheduler::now() - start);
+	}
+	if (trycatch.HasCaught()) {
+		context->forwardV8ExceptionToJNI(&trycatch);
+	}
+	context->runIdleWork();
+	return JNI_TRUE;
+}
+
 JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_runCBBoolean (JNIEnv * env, jobject obj, jobject engine, jlong cbPtr, jlong thisPtr, jboolean b) {
 	auto context = JNIWrapper::wrapObject<BGJSV8Engine>(engine);
     v8::Isolate* isolate = context->getIsolate();
@@ -132,20 +192,221 @@ JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_runCBBoolean (JNIEnv
 	Context::Scope context_scope(context->getContext());
 
 	TryCatch trycatch;
-	Persistent<Function>* fnPersist = static_cast<Persistent<Function>*>((void*)cbPtr);
-	Persistent<Object>* thisObjPersist = static_cast<Persistent<Object>*>((void*)thisPtr);
-	Local<Function> fn = (*reinterpret_cast<Local<Function>*>(fnPersist));
-	Local<Object> thisObj = (*reinterpret_cast<Local<Object>*>(thisObjPersist));
-
-	int argcount = 1;
-	Handle<Value> argarray[] = { Boolean::New(isolate, b ? true : false)};
 
-	Handle<Value> result = fn->Call(thisObj, argcount, argarray);
-	if (result.IsEmpty()) {
+	runBooleanCallback(context.get(), cbPtr, thisPtr, b ? true : false);
+	if (trycatch.HasCaught()) {
 		context->forwardV8ExceptionToJNI(&trycatch);
 	}
-	// TODO: Don't we need to clean up these persistents?
-    // => No, because they are pointers to a persistent that is stored elsewhere?!
+}
+
+// record layout shared with V8CallbackBatch.java
+enum ECallbackBatchRecord {
+	CALLBACK_BATCH_TIMEOUT = 0,
+	CALLBACK_BATCH_AJAX = 1,
+	CALLBACK_BATCH_BOOLEAN = 2,
+	CALLBACK_BATCH_ASYNC_CALL = 3
+};
+enum ECallbackBatchFlag {
+	CALLBACK_BATCH_RUN = 1,
+	CALLBACK_BATCH_CLEANUP = 2,
+	CALLBACK_BATCH_SUCCESS = 4,
+	CALLBACK_BATCH_PROCESS_DATA = 8,
+	CALLBACK_BATCH_VALUE = 16
+};
+
+JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_runCallbackBatch(JNIEnv * env, jobject obj, jobject engine, jint count,
+		jintArray types, jlongArray pointers, jintArray values, jobjectArray payloads, jintArray result) {
+	if (count <= 0) {
+		return;
+	}
+
+	// copy the record data in bulk instead of touching the java arrays once per field
+	std::vector<jint> typeData((size_t)count);
+	std::vector<jlong> pointerData((size_t)count * 3);
+	std::vector<jint> valueData((size_t)count * 2);
+	env->GetIntArrayRegion(types, 0, count, &typeData[0]);
+	env->GetLongArrayRegion(pointers, 0, count * 3, &pointerData[0]);
+	env->GetIntArrayRegion(values, 0, count * 2, &valueData[0]);
+
+	auto context = JNIWrapper::wrapObject<BGJSV8Engine>(engine);
+	BGJSFrameScheduler *scheduler = context->getFrameScheduler();
+	v8::Isolate* isolate = context->getIsolate();
+	v8::Locker l (isolate);
+	Isolate::Scope isolateScope(isolate);
+	HandleScope scope(isolate);
+	Context::Scope context_scope(context->getContext());
+
+	TryCatch trycatch;
+
+	// a failing record must not keep the remaining ones from running:
+	// the first exception is forwarded to java once the batch is done, all others are logged
+	jthrowable firstException = nullptr;
+	jint failed = 0;
+	jint i = 0;
+	bool settledPromises = false;
+
+	for (; i < count; i++) {
+		const jlong *ptrs = &pointerData[i * 3];
+		const jint flags = valueData[i * 2];
+
+		// records stay in order, so everything after a deferred record waits as well
+		// timer records that only clean up do not run any js and are neither paced nor accounted
+		BGJSWorkClass workClass = BGJSWorkClass::kInput;
+		bool runsJS = true;
+		if (typeData[i] == CALLBACK_BATCH_TIMEOUT) {
+			workClass = BGJSWorkClass::kTimer;
+			runsJS = (flags & CALLBACK_BATCH_RUN) != 0;
+		} else if (typeData[i] == CALLBACK_BATCH_AJAX || typeData[i] == CALLBACK_BATCH_ASYNC_CALL) {
+			workClass = BGJSWorkClass::kNetwork;
+		}
+		if (runsJS && scheduler->shouldDefer(workClass)) {
+			break;
+		}
+		const double start = BGJSFrameScheduler::now();
+
+		// keep the handles of one record from piling up over the whole batch
+		HandleScope recordScope(isolate);
+
+		switch (typeData[i]) {
+			case CALLBACK_BATCH_TIMEOUT:
+				runTimeoutCallback(context.get(), ptrs[0], ptrs[1], (flags & CALLBACK_BATCH_CLEANUP) != 0,
+								   (flags & CALLBACK_BATCH_RUN) != 0);
+				break;
+			case CALLBACK_BATCH_BOOLEAN:
+				runBooleanCallback(context.get(), ptrs[0], ptrs[1], (flags & CALLBACK_BATCH_VALUE) != 0);
+				break;
+			case CALLBACK_BATCH_AJAX: {
+				// ajax results are delivered as utf-8 encoded byte arrays
+				Local<Value> data = v8::Null(isolate);
+				jbyteArray payload = (jbyteArray)env->GetObjectArrayElement(payloads, i);
+				if (payload) {
+					jsize length = env->GetArrayLength(payload);
+					jbyte *bytes = env->GetByteArrayElements(payload, nullptr);
+					Local<String> str = String::NewFromUtf8(isolate, (const char*)bytes, NewStringType::kNormal, length).ToLocalChecked();
+					env->ReleaseByteArrayElements(payload, bytes, JNI_ABORT);
+					env->DeleteLocalRef(payload);
+					if (flags & CALLBACK_BATCH_PROCESS_DATA) {
+						data = context->parseJSON(str);
+					} else {
+						data = str;
+					}
+				}
+				AjaxModule::runCallback(context.get(), data, ptrs[0], ptrs[1], ptrs[2], (flags & CALLBACK_BATCH_SUCCESS) != 0);
+				break;
+			}
+			case CALLBACK_BATCH_ASYNC_CALL:
+				JNIV8ClassInfo::resolveAsyncJavaCall((JNIV8AsyncJavaCall*)ptrs[0]);
+				settledPromises = true;
+				break;
+			default:
+				LOGE("runCallbackBatch: unknown record type %d", typeData[i]);
+				break;
+		}
+		if (runsJS) {
+			scheduler->account(workClass, BGJSFrameScheduler::now() - start);
+		}
+
+		if (trycatch.HasCaught()) {
+			failed++;
+			if (!firstException) {
+				context->forwardV8ExceptionToJNI(&trycatch);
+				firstException = env->ExceptionOccurred();
+				env->ExceptionClear();
+			} else {
+				String::Utf8Value message(trycatch.Exception());
+				LOGE("runCallbackBatch: record %d failed: %s", i, *message ? *message : "<unknown>");
+			}
+			trycatch.Reset();
+		}
+	}
+
+	// promise reactions are not run automatically when no js is on the stack
+	if (settledPromises) {
+		const double start = BGJSFrameScheduler::now();
+		isolate->RunMicrotasks();
+		scheduler->account(BGJSWorkClass::kMicrotask, BGJSFrameScheduler::now() - start);
+	}
+
+	context->runIdleWork();
+
+	// report how many records ran, so that the java side can keep the deferred ones
+	jint counters[] = { i, failed };
+	env->SetIntArrayRegion(result, 0, 2, counters);
+
+	if (firstException) {
+		env->Throw(firstException);
+	}
+}
+
+JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_setFrameBudget(JNIEnv * env, jobject obj, jobject engine, jdouble budgetMs) {
+	auto context = JNIWrapper::wrapObject<BGJSV8Engine>(engine);
+	context->getFrameScheduler()->setBudget(budgetMs);
+}
+
+JNIEXPORT jboolean JNICALL Java_ag_boersego_bgjs_ClientAndroid_runIdleWork(JNIEnv * env, jobject obj, jobject engine) {
+	auto context = JNIWrapper::wrapObject<BGJSV8Engine>(engine);
+
+	v8::Isolate* isolate = context->getIsolate();
+	v8::Locker l (isolate);
+	Isolate::Scope isolateScope(isolate);
+	HandleScope scope (isolate);
+
+	context->runIdleWork();
+	return context->getFinalizationQueue()->depth() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_runAsyncJavaCall(JNIEnv * env, jobject obj, jlong callPtr) {
+	JNIV8ClassInfo::runAsyncJavaCall(env, (JNIV8AsyncJavaCall*)callPtr);
+}
+
+JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_dropAsyncJavaCall(JNIEnv * env, jobject obj, jlong callPtr) {
+	JNIV8AsyncJavaCall *call = (JNIV8AsyncJavaCall*)callPtr;
+
+	v8::Isolate* isolate = call->engine->getIsolate();
+	v8::Locker l (isolate);
+	Isolate::Scope isolateScope(isolate);
+
+	if (call->engine->finishAsyncJavaCall(call)) {
+		JNIV8ClassInfo::dropAsyncJavaCall(env, call);
+	}
+}
+
+JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_shutdownEngine(JNIEnv * env, jobject obj, jobject engine) {
+	auto context = JNIWrapper::wrapObject<BGJSV8Engine>(engine);
+	context->shutdown();
+}
+
+JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_getFrameStats(JNIEnv * env, jobject obj, jobject engine, jdoubleArray stats) {
+	auto context = JNIWrapper::wrapObject<BGJSV8Engine>(engine);
+	BGJSFrameStats lastFrame, total;
+	context->getFrameScheduler()->getStats(&lastFrame, &total);
+
+	BGJSFinalizationStats finalization;
+	context->getFinalizationQueue()->getStats(&finalization);
+
+	// layout shared with V8FrameStats.java: frames, interval, then time and deferred count per class for the last frame and in total,
+	// followed by the finalization queue counters and the memory held by canvas resources per category
+	const int numClasses = (int)BGJSWorkClass::kCount;
+	const int finalizationOffset = 2 + numClasses * 4;
+	const int memoryOffset = finalizationOffset + 4;
+	const int numCategories = (int)EJExternalMemoryCategory::kCount;
+	jdouble data[memoryOffset + numCategories];
+	data[0] = total.frames;
+	data[1] = total.frameIntervalMs;
+	for (int c = 0; c < numClasses; c++) {
+		data[2 + c] = lastFrame.timeMs[c];
+		data[2 + numClasses + c] = lastFrame.deferred[c];
+		data[2 + numClasses * 2 + c] = total.timeMs[c];
+		data[2 + numClasses * 3 + c] = total.deferred[c];
+	}
+	data[finalizationOffset] = finalization.depth;
+	data[finalizationOffset + 1] = finalization.peakDepth;
+	data[finalizationOffset + 2] = finalization.enqueued;
+	data[finalizationOffset + 3] = finalization.released;
+	for (int c = 0; c < numCategories; c++) {
+		data[memoryOffset + c] = context->getExternalMemory()->total((EJExternalMemoryCategory)c);
+	}
+	env->SetDoubleArrayRegion(stats, 0, memoryOffset + numCategories, data);
 }
 
 
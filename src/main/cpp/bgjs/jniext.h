@@ -12,13 +12,22 @@
 extern "C" {
 	// ClientAndroid
 	JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_initialize(
-			JNIEnv * env, jobject obj, jobject assetManager, jobject v8Engine, jstring locale, jstring lang, jstring timezone, float density, jstring deviceClass, jboolean debug);
+			JNIEnv * env, jobject obj, jobject assetManager, jobject v8Engine, jstring locale, jstring lang, jstring timezone, float density, jstring deviceClass, jboolean debug, jobject isolateHost);
+	JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_prewarm(JNIEnv * env, jobject obj);
 	JNIEXPORT bool JNICALL Java_ag_boersego_bgjs_ClientAndroid_ajaxDone(
 		JNIEnv * env, jobject obj, jobject engine, jstring dataStr, jint responseCode,
 		jlong jsCbPtr, jlong thisPtr, jlong errorCb, jboolean success, jboolean processData);
-	JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_timeoutCB(
+	JNIEXPORT jboolean JNICALL Java_ag_boersego_bgjs_ClientAndroid_timeoutCB(
 			JNIEnv * env, jobject obj, jobject engine, jlong jsCbPtr, jlong thisPtr, jboolean cleanup, jboolean runCb);
 	JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_runCBBoolean (JNIEnv * env, jobject obj, jobject engine, jlong cbPtr, jlong thisPtr, jboolean b);
+	JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_runCallbackBatch(JNIEnv * env, jobject obj, jobject engine, jint count,
+			jintArray types, jlongArray pointers, jintArray values, jobjectArray payloads, jintArray result);
+	JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_setFrameBudget(JNIEnv * env, jobject obj, jobject engine, jdouble budgetMs);
+	JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_getFrameStats(JNIEnv * env, jobject obj, jobject engine, jdoubleArray stats);
+	JNIEXPORT jboolean JNICALL Java_ag_boersego_bgjs_ClientAndroid_runIdleWork(JNIEnv * env, jobject obj, jobject engine);
+	JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_runAsyncJavaCall(JNIEnv * env, jobject obj, jlong callPtr);
+	JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_dropAsyncJavaCall(JNIEnv * env, jobject obj, jlong callPtr);
+	JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_shutdownEngine(JNIEnv * env, jobject obj, jobject engine);
 
 	// BGJSGLModule
     JNIEXPORT jint JNICALL Java_ag_boersego_bgjs_ClientAndroid_cssColorToInt(JNIEnv * env, jobject obj, jstring color);
@@ -63,7 +63,7 @@ void AjaxModule::ajax(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
 	Persistent<Function>* callbackPers = new Persistent<Function>(isolate, callback);
 	BGJS_NEW_PERSISTENT_PTR(callbackPers);
-	Persistent<Function>* errorPers;
+	Persistent<Function>* errorPers = nullptr;
 	if (!errCallback.IsEmpty() && !errCallback->IsUndefined())  {
 		errorPers = new Persistent<Function>(isolate, errCallback);
 		BGJS_NEW_PERSISTENT_PTR(errorPers);
@@ -109,19 +109,45 @@ void AjaxModule::ajax(const v8::FunctionCallbackInfo<v8::Value>& args) {
 		methodStr = 0;
 	}
 
-	jclass clazz = env->FindClass("ag/boersego/bgjs/V8Engine");
-	jmethodID ajaxMethod = env->GetStaticMethodID(clazz,
-			"doAjaxRequest", "(Ljava/lang/String;JJJLjava/lang/String;Ljava/lang/String;Z)V");
-	assert(ajaxMethod);
-	assert(clazz);
-	env->CallStaticVoidMethod(clazz, ajaxMethod, urlStr,
-			(jlong) callbackPers, (jlong) thisObj, (jlong) errorPers, dataStr, methodStr, (jboolean)processData);
+	// requests are routed to the engine that made them
+	engine->doAjaxRequest(urlStr, (jlong) callbackPers, (jlong) thisObj, (jlong) errorPers, dataStr, methodStr, processData);
 
 #endif
 
 	args.GetReturnValue().SetUndefined();
 }
 
+void AjaxModule::runCallback(BGJSV8Engine* engine, v8::Local<v8::Value> data, jlong jsCbPtr, jlong thisPtr, jlong errorCb, bool success) {
+	Isolate *isolate = engine->getIsolate();
+
+	Persistent<Object> *thisObj = static_cast<Persistent<Object> *>((void *) thisPtr);
+	Local<Object> thisObjLocal = Local<Object>::New(isolate, *thisObj);
+	Persistent<Function> *errorP = nullptr;
+	if (errorCb) {
+		errorP = static_cast<Persistent<Function> *>((void *) errorCb);
+	}
+	Persistent<Function> *callbackP = static_cast<Persistent<Function> *>((void *) jsCbPtr);
+
+	Handle<Value> argarray[1] = { data };
+	int argcount = 1;
+
+	if (success) {
+		Local<Function>::New(isolate, *callbackP)->Call(thisObjLocal, argcount, argarray);
+	} else {
+		if (errorP && !errorP->IsEmpty()) {
+			Local<Function>::New(isolate, *errorP)->Call(thisObjLocal, argcount, argarray);
+		} else {
+			LOGI("Error signaled by java code but no error callback set");
+		}
+	}
+
+	BGJS_CLEAR_PERSISTENT_PTR(callbackP);
+	BGJS_CLEAR_PERSISTENT_PTR(thisObj);
+	if (errorP) {
+		BGJS_CLEAR_PERSISTENT_PTR(errorP);
+	}
+}
+
 #ifdef ANDROID
 extern "C" {
 
@@ -143,54 +169,25 @@ JNIEXPORT bool JNICALL Java_ag_boersego_bgjs_ClientAndroid_ajaxDone(
 
 	TryCatch trycatch;
 
-	Persistent<Object> *thisObj = static_cast<Persistent<Object> *>((void *) thisPtr);
-	Local<Object> thisObjLocal = Local<Object>::New(isolate, *thisObj);
-	Persistent<Function> *errorP;
-	if (errorCb) {
-		errorP = static_cast<Persistent<Function> *>((void *) errorCb);
-	}
-	Persistent<Function> *callbackP = static_cast<Persistent<Function> *>((void *) jsCbPtr);
-
-	Handle<Value> argarray[1];
-	int argcount = 1;
-
+	Handle<Value> data;
 	if (dataStr == 0) {
-		argarray[0] = v8::Null(isolate);
+		data = v8::Null(isolate);
 	} else {
 		nativeString = env->GetStringUTFChars(dataStr, 0);
-		Handle<Value> resultObj;
 		if (processData) {
-			resultObj = context->parseJSON(String::NewFromUtf8(isolate, nativeString));
+			data = context->parseJSON(String::NewFromUtf8(isolate, nativeString));
 		} else {
-			resultObj = String::NewFromUtf8(isolate, nativeString);
+			data = String::NewFromUtf8(isolate, nativeString);
 		}
-
-		argarray[0] = resultObj;
 	}
 
-
-	Handle<Value> result;
-
-	if (success) {
-		result = Local<Function>::New(isolate, *callbackP)->Call(thisObjLocal, argcount, argarray);
-	} else {
-		if (!errorP->IsEmpty()) {
-			result = (*reinterpret_cast<Local<Function> *>(errorP))->Call(thisObjLocal, argcount,
-																		  argarray);
-		} else {
-			LOGI("Error signaled by java code but no error callback set");
-			result = v8::Undefined(isolate);
-		}
-	}
-	if (result.IsEmpty()) {
+	AjaxModule::runCallback(context.get(), data, jsCbPtr, thisPtr, errorCb, success);
+	if (trycatch.HasCaught()) {
 		context->forwardV8ExceptionToJNI(&trycatch);
 	}
 	if (nativeString) {
 		env->ReleaseStringUTFChars(dataStr, nativeString);
 	}
-	BGJS_CLEAR_PERSISTENT_PTR(callbackP);
-	BGJS_CLEAR_PERSISTENT_PTR(thisObj);
-	BGJS_CLEAR_PERSISTENT_PTR(errorP);
 
 	return true;
 }
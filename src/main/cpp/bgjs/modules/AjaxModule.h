@@ -19,6 +19,12 @@ public:
 	AjaxModule ();
 	static void doRequire (BGJSV8Engine* engine, v8::Handle<v8::Object> target);
 	static void ajax(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+	/**
+	 * invokes the success or error callback of a finished request and releases its persistents
+	 * all v8 scopes have to be set up by the caller; exceptions are left in the callers TryCatch
+	 */
+	static void runCallback(BGJSV8Engine* engine, v8::Local<v8::Value> data, jlong jsCbPtr, jlong thisPtr, jlong errorCb, bool success);
 };
 
 
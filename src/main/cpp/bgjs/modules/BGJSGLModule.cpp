@@ -1279,6 +1279,8 @@ JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_sendTouchEvent(
 	HandleScope scope(isolate);
 	Context::Scope context_scope(ct->getContext());
 
+	const double start = BGJSFrameScheduler::now();
+
 	float* x = env->GetFloatArrayElements(xArr, NULL);
 	float* y = env->GetFloatArrayElements(yArr, NULL);
 	const int count = env->GetArrayLength(xArr);
@@ -1323,5 +1325,7 @@ JNIEXPORT void JNICALL Java_ag_boersego_bgjs_ClientAndroid_sendTouchEvent(
 
 	// send event to view (can throw jni exception)
 	view->sendEvent(eventObjRef);
+
+	ct->getFrameScheduler()->account(BGJSWorkClass::kInput, BGJSFrameScheduler::now() - start);
 }
 
@@ -39,6 +39,7 @@ EJCanvasContext::EJCanvasContext (short widthp, short heightp) {
 
 	path = new EJPath();
 	backingStoreRatio = 1;
+	externalMemory = NULL;
 	_font = NULL;
 
 	// TODO: Font
@@ -113,6 +114,9 @@ EJCanvasContext::~EJCanvasContext() {
 	if( stencilBuffer ) { COMPAT_glDeleteRenderbuffers(1, &stencilBuffer); }
 
 	delete path;
+	if (_font) {
+		delete _font;
+	}
 }
 
 void EJCanvasContext::create () {
@@ -484,7 +488,7 @@ EJImageData* EJCanvasContext::getImageDataSx (float sx, float sy, float sw, floa
 	GLubyte * pixels = (GLubyte*)malloc( sw * sh * 4 * sizeof(GLubyte));
 	glReadPixels(sx, sy, sw, sh, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
 
-	EJImageData *data = EJImageData::initWithWidth(sw, sh, pixels);
+	EJImageData *data = EJImageData::initWithWidth(sw, sh, pixels, externalMemory);
 	return data;
 	// return [[[EJImageData alloc] initWithWidth:sw height:sh pixels:pixels] autorelease];
 }
@@ -565,9 +569,11 @@ EJFont* EJCanvasContext::acquireFont (char* fontName, float pointSize, bool fill
 
 	// This font is different, recreate
 	if (_font) {
+		// pending vertices might still use the atlas texture of the old font
+		this->setTexture(NULL);
 		delete(_font);
 	}
-	_font = new EJFont(fontName, pointSize, fill, contentScale);
+	_font = new EJFont(fontName, pointSize, fill, contentScale, externalMemory);
 	return _font;
 
 	// TODO: Caching
@@ -165,6 +165,8 @@ public:
 	// Attributes
 	EJCanvasState * state;
 	float backingStoreRatio;
+	// resources created by the context are charged to this; set by the owner, can be NULL
+	EJExternalMemory *externalMemory;
 	bool msaaEnabled;
 	int msaaSamples;
 	short width, height;
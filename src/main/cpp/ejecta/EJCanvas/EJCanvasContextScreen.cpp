@@ -125,7 +125,7 @@ EJImageData* EJCanvasContextScreen::getImageDataSx (float sx, float sy, float sw
 	}
 	free(internalPixels);
 
-	return EJImageData::initWithWidth (sw, sh, (GLubyte *)pixels);
+	return EJImageData::initWithWidth (sw, sh, (GLubyte *)pixels, externalMemory);
 	// return [[[EJImageData alloc] initWithWidth:sw height:sh pixels:(GLubyte *)pixels] autorelease];
 }
 
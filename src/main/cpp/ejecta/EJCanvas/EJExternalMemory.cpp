@@ -0,0 +1,21 @@
+#include "EJExternalMemory.h"
+
+EJExternalMemory::EJExternalMemory() : _unreported(0) {
+	for (int c = 0; c < (int)EJExternalMemoryCategory::kCount; c++) {
+		_totals[c] = 0;
+	}
+}
+
+void EJExternalMemory::adjust(EJExternalMemoryCategory category, int64_t change) {
+	if (!change) return;
+	_totals[(int)category] += change;
+	_unreported += change;
+}
+
+int64_t EJExternalMemory::total(EJExternalMemoryCategory category) {
+	return _totals[(int)category].load();
+}
+
+int64_t EJExternalMemory::takeUnreported() {
+	return _unreported.exchange(0);
+}
@@ -0,0 +1,46 @@
+#ifndef __EJEXTERNALMEMORY_H
+#define __EJEXTERNALMEMORY_H	1
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * Tracks the memory held by native canvas resources (textures, image data, fonts) per category.
+ * The canvas has no notion of the javascript engine, so changes are collected here and passed on to the
+ * garbage collector of the engine by whoever calls takeUnreported().
+ * Each engine owns one instance; its canvas contexts charge the resources they create to it.
+ * All methods are thread safe.
+ */
+
+enum class EJExternalMemoryCategory : int {
+	kTexture = 0,
+	kImageData,
+	kFont,
+	kCount
+};
+
+class EJExternalMemory {
+public:
+	EJExternalMemory();
+
+	/**
+	 * records that the resource allocated (positive change) or freed (negative change) memory
+	 */
+	void adjust(EJExternalMemoryCategory category, int64_t change);
+
+	/**
+	 * returns the number of bytes currently held by resources of the category
+	 */
+	int64_t total(EJExternalMemoryCategory category);
+
+	/**
+	 * returns the sum of all changes since the last call and resets it
+	 */
+	int64_t takeUnreported();
+
+private:
+	std::atomic<int64_t> _totals[(int)EJExternalMemoryCategory::kCount];
+	std::atomic<int64_t> _unreported;
+};
+
+#endif
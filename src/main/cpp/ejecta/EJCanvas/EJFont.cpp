@@ -7,6 +7,7 @@
 
 #include "EJFont.h"
 #include "EJCanvasContext.h"
+#include "EJExternalMemory.h"
 
 //#include "fonts/arial-38.h"
 /*#include "fonts/roboto_regular-15.h"
@@ -26,7 +27,7 @@
 #define PT_TO_PX(pt) pt
 #define LOG_TAG "EJFont"
 
-EJFont::EJFont (const char* font, int size, bool useFill, float cs) {
+EJFont::EJFont (const char* font, int size, bool useFill, float cs, EJExternalMemory *externalMemory) {
 
 	// size is in points, calculate number of pixels from that.
 	// Points = 1/72 inch, we can assume 2.22 pixel per pt for mdpi
@@ -35,6 +36,7 @@ EJFont::EJFont (const char* font, int size, bool useFill, float cs) {
 
 	_copy = false;
     _isFilled = useFill;
+	_externalMemory = externalMemory;
 
 	_font = &font_roboto_medium_24;
 	if (realPxSize >= 40) {
@@ -58,16 +60,29 @@ EJFont::EJFont (const char* font, int size, bool useFill, float cs) {
 			_font->tex_data[i] = 96;
 		}
 	} */
-	_texture = EJTexture::initWithWidth(_font->tex_width, _font->tex_height, (GLubyte*)_font->tex_data, GL_ALPHA, 1);
+	_texture = EJTexture::initWithWidth(_font->tex_width, _font->tex_height, (GLubyte*)_font->tex_data, GL_ALPHA, 1, _externalMemory);
+
+	// the atlas texture is accounted as a texture
+	if (_externalMemory) {
+		_externalMemory->adjust(EJExternalMemoryCategory::kFont, byteSize());
+	}
 }
 
 EJFont::~EJFont() {
+	if (_externalMemory) {
+		_externalMemory->adjust(EJExternalMemoryCategory::kFont, -byteSize());
+	}
+	delete _texture;
 	if (_copy) {
 		free(_font);
 	}
 	free(_utf32buffer);
 }
 
+int64_t EJFont::byteSize() {
+	return _utf32bufsize + (_copy ? sizeof(texture_font_t) : 0);
+}
+
 void EJFont::drawString (const char* utf8string, EJCanvasContext* toContext, float pen_x, float pen_y) {
     size_t i, j, k;
     const int rawLength = strlen(utf8string);
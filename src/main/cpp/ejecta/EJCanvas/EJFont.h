@@ -46,8 +46,11 @@ private:
 	uint32_t* _utf32buffer;
 	int _utf32bufsize;
     bool _isFilled;
+	EJExternalMemory *_externalMemory;
+	int64_t byteSize();
 public:
-	EJFont (const char* font, int size, bool fill, float contentScale);
+	// the font and its atlas texture are charged to externalMemory, which can be NULL
+	EJFont (const char* font, int size, bool fill, float contentScale, EJExternalMemory *externalMemory);
 	void drawString (const char* text, EJCanvasContext* context, float x, float y);
 	float measureString (const char* string);
 	float measureStringFromBuffer (int length);
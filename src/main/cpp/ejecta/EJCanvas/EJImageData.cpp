@@ -1,11 +1,16 @@
 #include "EJImageData.h"
+#include "EJExternalMemory.h"
 #include <stdlib.h>
 
- EJImageData* EJImageData::initWithWidth (int widthp, int heightp, GLubyte *pixelsp) {
+ EJImageData* EJImageData::initWithWidth (int widthp, int heightp, GLubyte *pixelsp, EJExternalMemory *externalMemory) {
 	EJImageData* self = new EJImageData();
 	self->width = widthp;
 	self->height = heightp;
 	self->pixels = pixelsp;
+	self->externalMemory = externalMemory;
+	if (pixelsp != NULL && externalMemory) {
+		externalMemory->adjust(EJExternalMemoryCategory::kImageData, (int64_t)widthp * heightp * 4);
+	}
 
 	return self;
 }
@@ -13,11 +18,14 @@
 EJImageData::~EJImageData() {
 	if (pixels != NULL) {
 		free(pixels);
+		if (externalMemory) {
+			externalMemory->adjust(EJExternalMemoryCategory::kImageData, -(int64_t)width * height * 4);
+		}
 	}
 }
 
 
 EJTexture *EJImageData::getTexture () {
-	EJTexture *texture = EJTexture::initWithWidth(width, height, pixels);
+	EJTexture *texture = EJTexture::initWithWidth(width, height, pixels, externalMemory);
 	return texture;
 }
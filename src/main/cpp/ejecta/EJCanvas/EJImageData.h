@@ -9,9 +9,14 @@ public:
 	int width, height;
 	GLubyte *pixels;
 
-	static EJImageData* initWithWidth (int width, int height, GLubyte *pixels);
+	// takes ownership of the RGBA pixels, which have to be allocated with malloc
+	// the pixels, and textures created from them, are charged to externalMemory, which can be NULL
+	static EJImageData* initWithWidth (int width, int height, GLubyte *pixels, EJExternalMemory *externalMemory);
 	EJTexture* getTexture();
 	~EJImageData();
+
+private:
+	EJExternalMemory *externalMemory;
 };
 
 #endif
@@ -1,4 +1,5 @@
 #include "EJTexture.h"
+#include "EJExternalMemory.h"
 #include "lodepng.h"
 #include "stdlib.h"
 
@@ -50,10 +51,11 @@ EJTexture* EJTexture::initWithWidth (int width, int height) {
 	return EJTexture::initWithWidth(width, height, GL_RGBA);
 }
 
-EJTexture* EJTexture::initWithWidth (int widthp, int heightp, GLubyte* pixels) {
+EJTexture* EJTexture::initWithWidth (int widthp, int heightp, GLubyte* pixels, EJExternalMemory *externalMemory) {
 	// Creates a texture with the given pixels
 
 	EJTexture* self = new EJTexture();
+	self->externalMemory = externalMemory;
 	self->fullPath = strdup("[From Pixels]");
 	self->setWidth(widthp, heightp);
 
@@ -72,10 +74,11 @@ EJTexture* EJTexture::initWithWidth (int widthp, int heightp, GLubyte* pixels) {
 	return self;
 }
 
-EJTexture* EJTexture::initWithWidth (int widthp, int heightp, GLubyte* pixels, GLenum format, size_t bytePerPixel) {
+EJTexture* EJTexture::initWithWidth (int widthp, int heightp, GLubyte* pixels, GLenum format, size_t bytePerPixel, EJExternalMemory *externalMemory) {
 	// Creates a texture with the given pixels
 
 	EJTexture* self = new EJTexture();
+	self->externalMemory = externalMemory;
 	self->fullPath = strdup("[From Pixels]");
 	self->setWidth(widthp, heightp);
 
@@ -96,6 +99,28 @@ EJTexture* EJTexture::initWithWidth (int widthp, int heightp, GLubyte* pixels, G
 
 EJTexture::~EJTexture() {
 	glDeleteTextures (1, &textureId);
+	setByteSize(0);
+}
+
+static int bytesPerPixel(GLenum format) {
+	switch (format) {
+		case GL_ALPHA:
+		case GL_LUMINANCE:
+			return 1;
+		case GL_LUMINANCE_ALPHA:
+			return 2;
+		case GL_RGB:
+			return 3;
+		default:
+			return 4;
+	}
+}
+
+void EJTexture::setByteSize (int64_t size) {
+	if (externalMemory) {
+		externalMemory->adjust(EJExternalMemoryCategory::kTexture, size - byteSize);
+	}
+	byteSize = size;
 }
 
 static int findNextPot(int size) {
@@ -126,6 +151,7 @@ void EJTexture::createTextureWithPixels (GLubyte *pixels, GLenum formatp) {
 	if( textureId ) {
 		glDeleteTextures( 1, &textureId );
 		textureId = 0;
+		setByteSize(0);
 	}
 
 	GLint maxTextureSize;
@@ -146,6 +172,7 @@ void EJTexture::createTextureWithPixels (GLubyte *pixels, GLenum formatp) {
 	// LOGD ("new textureId %u", textureId);
 	glBindTexture(GL_TEXTURE_2D, textureId);
 	glTexImage2D(GL_TEXTURE_2D, 0, format, realWidth, realHeight, 0, format, GL_UNSIGNED_BYTE, pixels);
+	setByteSize((int64_t)realWidth * realHeight * bytesPerPixel(format));
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, textureFilter);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, textureFilter);
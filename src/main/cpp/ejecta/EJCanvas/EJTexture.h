@@ -3,6 +3,10 @@
 
 #include "GLcompat.h"
 
+#include <stdint.h>
+
+class EJExternalMemory;
+
 
 using namespace std;
 
@@ -16,8 +20,9 @@ public:
 	static EJTexture* initWithPath (const char* path);
 	static EJTexture* initWithWidth (int width, int height, GLenum format);
 	static EJTexture* initWithWidth (int width, int height);
-	static EJTexture* initWithWidth (int width, int height, GLubyte* pixels);
-	static EJTexture* initWithWidth (int widthp, int heightp, GLubyte* pixels, GLenum format, size_t bytePerPixel);
+	// textures created from pixels charge their storage to externalMemory, which can be NULL
+	static EJTexture* initWithWidth (int width, int height, GLubyte* pixels, EJExternalMemory *externalMemory);
+	static EJTexture* initWithWidth (int widthp, int heightp, GLubyte* pixels, GLenum format, size_t bytePerPixel, EJExternalMemory *externalMemory);
 
 	~EJTexture();
 
@@ -34,7 +39,11 @@ public:
 private:
 	const char* fullPath;
 	GLenum format;
+	// memory of the texture storage, reported to externalMemory
+	int64_t byteSize;
+	EJExternalMemory *externalMemory;
 	GLubyte *loadPixelsWithLodePNGFromPath (const char* path);
+	void setByteSize (int64_t size);
 };
 
 #endif
@@ -8,6 +8,8 @@
 #include "JNIClass.h"
 #include "JNIWrapper.h"
 
+std::atomic<size_t> JNITypeSlot::_nextSlot(0);
+
 JNIBase::JNIBase(JNIClassInfo *info) {
     _jniClassInfo = info;
 }
@@ -6,6 +6,7 @@
 #define ANDROID_TRADINGLIB_SAMPLE_JNIBASE_H
 
 #import <string>
+#include <atomic>
 #include <jni.h>
 #include "jni_assert.h"
 
@@ -38,6 +39,23 @@ protected:
     JNIClassInfo *_jniClassInfo;
 };
 
+/**
+ * assigns every native type a dense integer slot on first use
+ * registries use it as an index into flat tables instead of looking types up by their canonical name
+ */
+class JNITypeSlot {
+public:
+    static const size_t kMaxSlots = 256;
+
+    template <typename T> static
+    size_t get() {
+        static const size_t slot = _nextSlot++;
+        return slot;
+    }
+private:
+    static std::atomic<size_t> _nextSlot;
+};
+
 /**
  * macro to link native class with matching java counterpart
  * specify the native class, and the full canonical name of the associated java class
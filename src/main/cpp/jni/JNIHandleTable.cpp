@@ -0,0 +1,131 @@
+//
+// JNIHandleTable.cpp
+//
+
+#include "jni_assert.h"
+
+#include "JNIHandleTable.h"
+
+std::atomic<bool> JNIHandleTable::_enabled(false);
+std::mutex JNIHandleTable::_mutex;
+jobjectArray JNIHandleTable::_objects = nullptr;
+std::vector<uint16_t> JNIHandleTable::_generations;
+std::vector<uint32_t> JNIHandleTable::_freeIndices;
+size_t JNIHandleTable::_size = 0;
+decltype(JNIHandleTable::_jniObject) JNIHandleTable::_jniObject = {0};
+decltype(JNIHandleTable::_jniSystem) JNIHandleTable::_jniSystem = {0};
+
+void JNIHandleTable::setEnabled(bool enabled) {
+    _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool JNIHandleTable::isEnabled() {
+    return _enabled.load(std::memory_order_relaxed);
+}
+
+jint JNIHandleTable::add(JNIEnv *env, jobject obj) {
+    if(!obj || !_enabled.load(std::memory_order_relaxed)) {
+        return kInvalidHandle;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(_freeIndices.empty() && !grow(env)) {
+        return kInvalidHandle;
+    }
+
+    const uint32_t index = _freeIndices.back();
+    _freeIndices.pop_back();
+    env->SetObjectArrayElement(_objects, (jsize)index, obj);
+    _size++;
+
+    return (jint)(((uint32_t)_generations[index] << kIndexBits) | index);
+}
+
+jobject JNIHandleTable::get(JNIEnv *env, jint handle) {
+    const uint32_t index = (uint32_t)handle & kIndexMask;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(index >= _generations.size() || _generations[index] != ((uint32_t)handle >> kIndexBits)) {
+        JNI_ASSERTF(false, "Attempt to access removed handle %d", handle);
+        return nullptr;
+    }
+    return env->GetObjectArrayElement(_objects, (jsize)index);
+}
+
+void JNIHandleTable::remove(JNIEnv *env, jint handle) {
+    const uint32_t index = (uint32_t)handle & kIndexMask;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(index >= _generations.size() || _generations[index] != ((uint32_t)handle >> kIndexBits)) {
+        JNI_ASSERTF(false, "Attempt to remove handle %d twice", handle);
+        return;
+    }
+
+    env->SetObjectArrayElement(_objects, (jsize)index, nullptr);
+    // handles of the previous occupant of a slot become invalid
+    _generations[index] = (uint16_t)(_generations[index] % kMaxGeneration + 1);
+    _freeIndices.push_back(index);
+    _size--;
+}
+
+size_t JNIHandleTable::size() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _size;
+}
+
+/**
+ * doubles the capacity of the table; has to be called with the mutex held
+ */
+bool JNIHandleTable::grow(JNIEnv *env) {
+    const size_t capacity = _generations.size();
+    size_t newCapacity = capacity ? capacity * 2 : kInitialCapacity;
+    if(newCapacity > (size_t)kIndexMask + 1) {
+        newCapacity = (size_t)kIndexMask + 1;
+    }
+    if(newCapacity <= capacity) {
+        return false;
+    }
+
+    if(!_jniObject.clazz) {
+        _jniObject.clazz = (jclass)env->NewGlobalRef(env->FindClass("java/lang/Object"));
+        _jniSystem.clazz = (jclass)env->NewGlobalRef(env->FindClass("java/lang/System"));
+        _jniSystem.arraycopyId = env->GetStaticMethodID(_jniSystem.clazz, "arraycopy", "(Ljava/lang/Object;ILjava/lang/Object;II)V");
+    }
+
+    jobjectArray objects = env->NewObjectArray((jsize)newCapacity, _jniObject.clazz, nullptr);
+    if(!objects) {
+        // out of memory; references fall back to global references
+        env->ExceptionClear();
+        return false;
+    }
+    if(_objects) {
+        env->CallStaticVoidMethod(_jniSystem.clazz, _jniSystem.arraycopyId, _objects, 0, objects, 0, (jint)capacity);
+        env->DeleteGlobalRef(_objects);
+    }
+    _objects = (jobjectArray)env->NewGlobalRef(objects);
+    env->DeleteLocalRef(objects);
+
+    _generations.resize(newCapacity, 1);
+    // lowest indices are handed out first
+    for(size_t index = newCapacity; index > capacity; index--) {
+        _freeIndices.push_back((uint32_t)(index - 1));
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Exports
+//--------------------------------------------------------------------------------------------------
+extern "C" {
+    JNIEXPORT void JNICALL Java_ag_boersego_bgjs_JNIHandleTable_setEnabled(JNIEnv *env, jclass clazz, jboolean enabled) {
+        JNIHandleTable::setEnabled(enabled != 0);
+    }
+
+    JNIEXPORT jboolean JNICALL Java_ag_boersego_bgjs_JNIHandleTable_isEnabled(JNIEnv *env, jclass clazz) {
+        return (jboolean)JNIHandleTable::isEnabled();
+    }
+
+    JNIEXPORT jint JNICALL Java_ag_boersego_bgjs_JNIHandleTable_getSize(JNIEnv *env, jclass clazz) {
+        return (jint)JNIHandleTable::size();
+    }
+}
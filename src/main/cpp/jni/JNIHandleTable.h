@@ -0,0 +1,131 @@
+//
+// JNIHandleTable.h
+//
+
+#ifndef __JNIHANDLETABLE_H
+#define __JNIHANDLETABLE_H
+
+#include <jni.h>
+#include <atomic>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * keeps java objects alive for native code without creating a global reference for each of them
+ *
+ * objects are stored in a single java array that is referenced globally; native code only keeps an integer handle.
+ * the global reference table of the vm is capped and every NewGlobalRef/DeleteGlobalRef takes a vm wide lock,
+ * storing an array element is a plain write instead.
+ * handles contain a generation counter, so a handle that was removed is not mistaken for the object now stored in its slot.
+ *
+ * the table is disabled by default; references created while it is disabled stay global references.
+ * all methods are thread safe.
+ */
+class JNIHandleTable {
+public:
+    static const jint kInvalidHandle = 0;
+
+    /**
+     * enables or disables the table for new references; existing handles stay valid either way
+     */
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    /**
+     * stores a strong reference to the object and returns its handle
+     * returns kInvalidHandle if the table is disabled or full, or if obj is null; callers fall back to a global reference then
+     */
+    static jint add(JNIEnv *env, jobject obj);
+
+    /**
+     * returns a new local reference to the object of the handle, or nullptr if the handle was already removed
+     */
+    static jobject get(JNIEnv *env, jint handle);
+
+    /**
+     * removes the reference; no jni exception must be pending
+     */
+    static void remove(JNIEnv *env, jint handle);
+
+    /**
+     * returns the number of objects stored in the table
+     */
+    static size_t size();
+
+private:
+    static bool grow(JNIEnv *env);
+
+    // handles are (generation << kIndexBits) | index; generations are never 0, so neither is a valid handle
+    static const int kIndexBits = 20;
+    static const uint32_t kIndexMask = (1u << kIndexBits) - 1;
+    static const uint16_t kMaxGeneration = (1u << (31 - kIndexBits)) - 1;
+    static const size_t kInitialCapacity = 1024;
+
+    static std::atomic<bool> _enabled;
+    static std::mutex _mutex;
+    static jobjectArray _objects;
+    static std::vector<uint16_t> _generations;
+    static std::vector<uint32_t> _freeIndices;
+    static size_t _size;
+
+    static struct {
+        jclass clazz;
+    } _jniObject;
+    static struct {
+        jclass clazz;
+        jmethodID arraycopyId;
+    } _jniSystem;
+};
+
+/**
+ * strong reference to a java object held by native code: an entry of the handle table if it was enabled when the
+ * reference was set, a global reference otherwise
+ * plain struct, so that it can be stored in containers that are copied with memcpy
+ */
+struct JNIStrongRef {
+    jobject globalRef;
+    jint handle;
+
+    void set(JNIEnv *env, jobject obj) {
+        handle = JNIHandleTable::add(env, obj);
+        globalRef = handle ? nullptr : env->NewGlobalRef(obj);
+    }
+
+    void reset(JNIEnv *env) {
+        if(handle) {
+            JNIHandleTable::remove(env, handle);
+        } else if(globalRef) {
+            env->DeleteGlobalRef(globalRef);
+        }
+        handle = JNIHandleTable::kInvalidHandle;
+        globalRef = nullptr;
+    }
+};
+
+/**
+ * provides a usable jobject for a JNIStrongRef for the lifetime of the scope
+ * table entries are resolved to a local reference, which is deleted again when the scope is left
+ */
+class JNIStrongRefScope {
+public:
+    JNIStrongRefScope(JNIEnv *env, const JNIStrongRef &ref) : _env(env), _isLocal(ref.handle != 0) {
+        _obj = _isLocal ? JNIHandleTable::get(env, ref.handle) : ref.globalRef;
+    }
+    ~JNIStrongRefScope() {
+        if(_isLocal && _obj) _env->DeleteLocalRef(_obj);
+    }
+    jobject get() const {
+        return _obj;
+    }
+private:
+    JNIStrongRefScope(const JNIStrongRefScope&) = delete;
+    JNIStrongRefScope& operator=(const JNIStrongRefScope&) = delete;
+
+    JNIEnv *_env;
+    bool _isLocal;
+    jobject _obj;
+};
+
+#endif //__JNIHANDLETABLE_H
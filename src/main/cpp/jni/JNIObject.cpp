@@ -5,8 +5,11 @@
 #include "jni_assert.h"
 
 #include "JNIObject.h"
+#include "JNIHandleTable.h"
 #include "JNIWrapper.h"
 
+#include <vector>
+
 BGJS_JNI_LINK(JNIObject, "ag/boersego/bgjs/JNIObject");
 
 JNIObject::JNIObject(jobject obj, JNIClassInfo *info) : JNIBase(info) {
@@ -23,6 +26,7 @@ JNIObject::JNIObject(jobject obj, JNIClassInfo *info) : JNIBase(info) {
         _jniObject = env->NewGlobalRef(obj);
         _jniObjectWeak = nullptr;
     }
+    _jniObjectHandle = JNIHandleTable::kInvalidHandle;
     _atomicJniObjectRefCount = 0;
 
     // store pointer to native instance in "nativeHandle" field
@@ -38,6 +42,20 @@ JNIObject::JNIObject(jobject obj, JNIClassInfo *info) : JNIBase(info) {
 
 JNIObject::~JNIObject() {
     JNI_ASSERTF(_atomicJniObjectRefCount==0, "JNIObject (%s) was deleted while retaining java object (ref count: %d)", getCanonicalName().c_str(), _atomicJniObjectRefCount.load());
+    if(_jniObjectHandle) {
+        // storing into the table is a jni call, which is not allowed while an exception is pending (see releaseJObject)
+        JNIEnv *env = JNIWrapper::getEnvironment();
+        jthrowable exc = nullptr;
+        if(env->ExceptionCheck()) {
+            exc = env->ExceptionOccurred();
+            env->ExceptionClear();
+        }
+
+        JNIHandleTable::remove(env, _jniObjectHandle);
+        _jniObjectHandle = JNIHandleTable::kInvalidHandle;
+
+        if(exc) env->Throw(exc);
+    }
     if(_jniObject) {
         // this should/can never happen for persistent objects
         // if there is a strong ref to the JObject, then the native object must not be deleted!
@@ -81,12 +99,22 @@ void JNIObject::retainJObject() {
         // or another thread B could possible even already have created the object
         // e.g. (0->1(A)->0->1(B), executed as 1->0->1 (B)(A)
         // => check state here, guarded by mutex, and possibly do nothing
-        if(_atomicJniObjectRefCount==0 || _jniObject) {
+        if(_atomicJniObjectRefCount==0 || _jniObject || _jniObjectHandle) {
             return;
         }
 
+        // with the handle table enabled the object is kept alive by an entry of the table instead of a global ref
+        // the table must not store the weak reference itself => resolve it first; null if the object was already collected
         JNIEnv *env = JNIWrapper::getEnvironment();
-        _jniObject = env->NewGlobalRef(_jniObjectWeak);
+        jobject obj = env->NewLocalRef(_jniObjectWeak);
+        if(!obj) {
+            return;
+        }
+        _jniObjectHandle = JNIHandleTable::add(env, obj);
+        if(!_jniObjectHandle) {
+            _jniObject = env->NewGlobalRef(obj);
+        }
+        env->DeleteLocalRef(obj);
     }
 }
 
@@ -103,7 +131,7 @@ void JNIObject::releaseJObject() {
         // or another thread B could possible even already have released the object
         // e.g. (1->0(A)->1->0(B), executed as 1->0->1 (B)(A)
         // => check state here, guarded by mutex, and possibly do nothing
-        if(_atomicJniObjectRefCount > 0 || !_jniObject) {
+        if(_atomicJniObjectRefCount > 0 || (!_jniObject && !_jniObjectHandle)) {
             return;
         }
 
@@ -123,8 +151,13 @@ void JNIObject::releaseJObject() {
             env->ExceptionClear();
         }
 
-        env->DeleteGlobalRef(_jniObject);
-        _jniObject = nullptr;
+        if(_jniObjectHandle) {
+            JNIHandleTable::remove(env, _jniObjectHandle);
+            _jniObjectHandle = JNIHandleTable::kInvalidHandle;
+        } else {
+            env->DeleteGlobalRef(_jniObject);
+            _jniObject = nullptr;
+        }
 
         if(exc) env->Throw(exc);
     }
@@ -186,11 +219,19 @@ extern "C" {
         JNIWrapper::initializeNativeObject(obj, canonicalName);
     }
 
-    JNIEXPORT bool JNICALL Java_ag_boersego_bgjs_JNIObjectReference_disposeNative(JNIEnv *env, jobject obj, jlong nativeHandle) {
-        JNIObject *jniObject = reinterpret_cast<JNIObject*>(nativeHandle);
-        if(jniObject->isRetained()) return false;
-        delete jniObject;
-        return true;
+    JNIEXPORT void JNICALL Java_ag_boersego_bgjs_JNIObjectReference_disposeNatives(JNIEnv *env, jobject obj, jlongArray nativeHandles, jint count) {
+        // handles of disposed objects are set to 0; retained objects are left untouched
+        // destructors use JNI, so the array is copied instead of being accessed in a critical section
+        if(count <= 0) return;
+        std::vector<jlong> handles((size_t)count);
+        env->GetLongArrayRegion(nativeHandles, 0, count, &handles[0]);
+        for(jint i = 0; i < count; i++) {
+            JNIObject *jniObject = reinterpret_cast<JNIObject*>(handles[i]);
+            if(jniObject->isRetained()) continue;
+            delete jniObject;
+            handles[i] = 0;
+        }
+        env->SetLongArrayRegion(nativeHandles, 0, count, &handles[0]);
     }
 }
 
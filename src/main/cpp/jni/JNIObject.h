@@ -17,6 +17,7 @@
  */
 class JNIObject : public JNIBase {
     friend class JNIWrapper;
+    friend class BGJSFinalizationQueue;
     template <typename> friend class JNIRef;
 public:
     JNIObject(jobject obj, JNIClassInfo *info);
@@ -58,6 +59,8 @@ private:
     //pthread_mutex_t _mutex;
     jobject _jniObject;
     jweak _jniObjectWeak;
+    // set instead of _jniObject while retained, if the handle table was enabled at that time
+    jint _jniObjectHandle;
     std::atomic<uint8_t> _atomicJniObjectRefCount;
     std::weak_ptr<JNIObject> _weakPtr;
 };
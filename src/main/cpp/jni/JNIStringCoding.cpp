@@ -0,0 +1,176 @@
+//
+// JNIStringCoding.cpp
+//
+
+#include "JNIStringCoding.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define JNI_STRING_CODING_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define JNI_STRING_CODING_SSE2 1
+#endif
+
+/**
+ * returns true if none of the chars has any of the bits of mask set
+ */
+static inline bool charsFitMask(const jchar *chars, size_t length, uint16_t mask) {
+    size_t i = 0;
+#if defined(JNI_STRING_CODING_SSE2)
+    const __m128i vmask = _mm_set1_epi16((short)mask);
+    const __m128i zero = _mm_setzero_si128();
+    for(; i + 8 <= length; i += 8) {
+        __m128i v = _mm_and_si128(_mm_loadu_si128((const __m128i*)(chars + i)), vmask);
+        if(_mm_movemask_epi8(_mm_cmpeq_epi16(v, zero)) != 0xFFFF) return false;
+    }
+#elif defined(JNI_STRING_CODING_NEON)
+    const uint16x8_t vmask = vdupq_n_u16(mask);
+    for(; i + 8 <= length; i += 8) {
+        uint16x8_t v = vandq_u16(vld1q_u16(chars + i), vmask);
+        uint16x4_t folded = vorr_u16(vget_low_u16(v), vget_high_u16(v));
+        if(vget_lane_u64(vreinterpret_u64_u16(folded), 0)) return false;
+    }
+#endif
+    for(; i < length; i++) {
+        if(chars[i] & mask) return false;
+    }
+    return true;
+}
+
+bool JNIStringCoding::isAscii(const char *bytes, size_t length) {
+    const uint8_t *p = (const uint8_t*)bytes;
+    size_t i = 0;
+#if defined(JNI_STRING_CODING_SSE2)
+    for(; i + 16 <= length; i += 16) {
+        if(_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(p + i)))) return false;
+    }
+#elif defined(JNI_STRING_CODING_NEON)
+    for(; i + 16 <= length; i += 16) {
+        uint8x16_t v = vld1q_u8(p + i);
+        uint8x8_t folded = vorr_u8(vget_low_u8(v), vget_high_u8(v));
+        if(vget_lane_u64(vreinterpret_u64_u8(folded), 0) & 0x8080808080808080ULL) return false;
+    }
+#endif
+    for(; i < length; i++) {
+        if(p[i] & 0x80) return false;
+    }
+    return true;
+}
+
+bool JNIStringCoding::isAscii(const jchar *chars, size_t length) {
+    return charsFitMask(chars, length, 0xFF80);
+}
+
+bool JNIStringCoding::isLatin1(const jchar *chars, size_t length) {
+    return charsFitMask(chars, length, 0xFF00);
+}
+
+void JNIStringCoding::narrow(const jchar *chars, size_t length, uint8_t *target) {
+    // simple enough for the compiler to vectorize
+    for(size_t i = 0; i < length; i++) {
+        target[i] = (uint8_t)chars[i];
+    }
+}
+
+void JNIStringCoding::widen(const uint8_t *bytes, size_t length, jchar *target) {
+    for(size_t i = 0; i < length; i++) {
+        target[i] = bytes[i];
+    }
+}
+
+void JNIStringCoding::utf16ToUtf8(const jchar *chars, size_t length, std::string &target) {
+    const size_t start = target.size();
+
+    if(isAscii(chars, length)) {
+        target.resize(start + length);
+        narrow(chars, length, (uint8_t*)&target[start]);
+        return;
+    }
+
+    // a char is encoded with at most 3 bytes; surrogate pairs take 4 bytes for 2 chars
+    target.resize(start + length * 3);
+    uint8_t *begin = (uint8_t*)&target[start];
+    uint8_t *out = begin;
+
+    for(size_t i = 0; i < length; i++) {
+        uint32_t c = chars[i];
+        if(c < 0x80) {
+            *out++ = (uint8_t)c;
+        } else if(c < 0x800) {
+            *out++ = (uint8_t)(0xC0 | (c >> 6));
+            *out++ = (uint8_t)(0x80 | (c & 0x3F));
+        } else if(c >= 0xD800 && c <= 0xDFFF) {
+            if(c <= 0xDBFF && i + 1 < length && chars[i + 1] >= 0xDC00 && chars[i + 1] <= 0xDFFF) {
+                uint32_t codePoint = 0x10000 + ((c - 0xD800) << 10) + (chars[i + 1] - 0xDC00);
+                i++;
+                *out++ = (uint8_t)(0xF0 | (codePoint >> 18));
+                *out++ = (uint8_t)(0x80 | ((codePoint >> 12) & 0x3F));
+                *out++ = (uint8_t)(0x80 | ((codePoint >> 6) & 0x3F));
+                *out++ = (uint8_t)(0x80 | (codePoint & 0x3F));
+            } else {
+                *out++ = '?';
+            }
+        } else {
+            *out++ = (uint8_t)(0xE0 | (c >> 12));
+            *out++ = (uint8_t)(0x80 | ((c >> 6) & 0x3F));
+            *out++ = (uint8_t)(0x80 | (c & 0x3F));
+        }
+    }
+
+    target.resize(start + (out - begin));
+}
+
+size_t JNIStringCoding::utf8ToUtf16(const char *bytes, size_t length, jchar *target) {
+    const uint8_t *p = (const uint8_t*)bytes;
+
+    if(isAscii(bytes, length)) {
+        widen(p, length, target);
+        return length;
+    }
+
+    jchar *out = target;
+    size_t i = 0;
+    while(i < length) {
+        uint8_t b = p[i];
+        if(b < 0x80) {
+            *out++ = b;
+            i++;
+            continue;
+        }
+
+        uint32_t codePoint, minimum;
+        size_t trailing;
+        if((b & 0xE0) == 0xC0) {
+            codePoint = b & 0x1F; trailing = 1; minimum = 0x80;
+        } else if((b & 0xF0) == 0xE0) {
+            codePoint = b & 0x0F; trailing = 2; minimum = 0x800;
+        } else if((b & 0xF8) == 0xF0) {
+            codePoint = b & 0x07; trailing = 3; minimum = 0x10000;
+        } else {
+            // stray continuation byte or invalid lead byte
+            *out++ = 0xFFFD;
+            i++;
+            continue;
+        }
+
+        size_t j = 1;
+        for(; j <= trailing && i + j < length && (p[i + j] & 0xC0) == 0x80; j++) {
+            codePoint = (codePoint << 6) | (p[i + j] & 0x3F);
+        }
+        i += j;
+
+        // truncated sequences, overlong encodings, surrogates and values beyond the unicode range are malformed
+        if(j <= trailing || codePoint < minimum || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+            *out++ = 0xFFFD;
+        } else if(codePoint >= 0x10000) {
+            codePoint -= 0x10000;
+            *out++ = (jchar)(0xD800 + (codePoint >> 10));
+            *out++ = (jchar)(0xDC00 + (codePoint & 0x3FF));
+        } else {
+            *out++ = (jchar)codePoint;
+        }
+    }
+
+    return (size_t)(out - target);
+}
@@ -0,0 +1,59 @@
+//
+// JNIStringCoding.h
+//
+
+#ifndef __JNISTRINGCODING_H
+#define __JNISTRINGCODING_H
+
+#include <jni.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/**
+ * transcoding between java strings (utf-16), std::strings (utf-8) and one byte (latin-1) buffers
+ * the checks for plain ascii/latin-1 content use SSE2 or NEON where available, because most strings crossing
+ * the bridge (property names, json, urls) never leave that range and can be copied without decoding
+ */
+class JNIStringCoding {
+public:
+    /**
+     * strings up to this length (in chars) are converted using buffers on the stack
+     */
+    static const size_t kStackBufferLength = 256;
+
+    /**
+     * returns true if all bytes / chars are < 0x80
+     */
+    static bool isAscii(const char *bytes, size_t length);
+    static bool isAscii(const jchar *chars, size_t length);
+
+    /**
+     * returns true if all chars are < 0x100, i.e. they can be stored in a one byte string
+     */
+    static bool isLatin1(const jchar *chars, size_t length);
+
+    /**
+     * copies latin-1 chars to a one byte buffer; all chars have to be < 0x100
+     */
+    static void narrow(const jchar *chars, size_t length, uint8_t *target);
+
+    /**
+     * copies a one byte buffer to chars
+     */
+    static void widen(const uint8_t *bytes, size_t length, jchar *target);
+
+    /**
+     * appends the utf-8 encoding of utf-16 chars to a string
+     * unpaired surrogates are replaced with '?', like String.getBytes does
+     */
+    static void utf16ToUtf8(const jchar *chars, size_t length, std::string &target);
+
+    /**
+     * decodes utf-8 to utf-16 and returns the number of chars written
+     * target has to be able to hold `length` chars; malformed sequences are replaced with U+FFFD
+     */
+    static size_t utf8ToUtf16(const char *bytes, size_t length, jchar *target);
+};
+
+#endif //__JNISTRINGCODING_H
@@ -6,20 +6,13 @@
 #include <jni.h>
 #include <cstdlib>
 #include "JNIWrapper.h"
+#include "JNIStringCoding.h"
 
-pthread_mutex_t JNIWrapper::_mutexEnv = PTHREAD_MUTEX_INITIALIZER;
+#include <memory>
 
 void JNIWrapper::init(JavaVM *vm) {
     _jniVM = vm;
 
-    JNIEnv *env = JNIWrapper::getEnvironment();
-
-    _jniStringClass = (jclass)env->NewGlobalRef(env->FindClass("java/lang/String"));
-    _jniStringInit = env->GetMethodID(_jniStringClass, "<init>", "([BLjava/lang/String;)V");
-    _jniStringGetBytes = env->GetMethodID(_jniStringClass, "getBytes",
-                                          "(Ljava/lang/String;)[B");
-    _jniCharsetName = (jstring)env->NewGlobalRef(env->NewStringUTF("UTF-8"));
-
     _registerObject(typeid(JNIObject).hash_code(), JNIObjectType::kAbstract,
                     JNIBase::getCanonicalName<JNIObject>(), "", initialize<JNIObject>, nullptr);
 }
@@ -42,6 +35,18 @@ bool JNIWrapper::isObjectInstanceOf(JNIObject *obj, const std::string &canonical
     return true;
 }
 
+JNIClassInfo* JNIWrapper::_resolveSlot(size_t slot, const std::string& canonicalName) {
+    auto it = _objmap.find(canonicalName);
+    if(it == _objmap.end()) {
+        return nullptr;
+    }
+    // types beyond the slot capacity keep working, they are just looked up by name every time
+    if(slot < JNITypeSlot::kMaxSlots) {
+        _slots[slot].store(it->second, std::memory_order_release);
+    }
+    return it->second;
+}
+
 void JNIWrapper::_registerObject(size_t hashCode, JNIObjectType type,
                                  const std::string &canonicalName, const std::string &baseCanonicalName,
                                  ObjectInitializer i, ObjectConstructor c) {
@@ -136,30 +141,37 @@ void JNIWrapper::_registerObject(size_t hashCode, JNIObjectType type,
 }
 
 JNIEnv* JNIWrapper::getEnvironment() {
-    // currently we just cache the most recently used env in a static variable..
-    // if multiple threads are used frequently this is certainly not optimal
-    // otherwise it should be "okay"
-
-    pthread_mutex_lock(&_mutexEnv);
-
-    pid_t t = gettid();
-    if(_jniThreadId != t) {
-        int r = _jniVM->GetEnv((void **) &_jniEnv, JNI_VERSION_1_6);
-        if (r != JNI_OK) {
-            __android_log_print(ANDROID_LOG_DEBUG, "JNIWrapper", "attached new thread to JNI. Make sure to detach on exit!");
-            int r = _jniVM->AttachCurrentThread(&_jniEnv, nullptr);
-            JNI_ASSERT(r == JNI_OK, "Failed to attach thread to JVM");
-            (void) r;
-        }
-        _jniThreadId = t;
-    }
+    // every thread caches its own env, so this does not need a lock
     JNIEnv *env = _jniEnv;
+    if(env) {
+        return env;
+    }
+    return _attachCurrentThread();
+}
 
-    pthread_mutex_unlock(&_mutexEnv);
-
+JNIEnv* JNIWrapper::_attachCurrentThread() {
+    JNIEnv *env = nullptr;
+    int r = _jniVM->GetEnv((void **) &env, JNI_VERSION_1_6);
+    if (r != JNI_OK) {
+        r = _jniVM->AttachCurrentThread(&env, nullptr);
+        JNI_ASSERT(r == JNI_OK, "Failed to attach thread to JVM");
+        // native threads attached here are detached again when they exit
+        pthread_once(&_detachKeyOnce, _createDetachKey);
+        pthread_setspecific(_detachKey, env);
+    }
+    (void) r;
+    _jniEnv = env;
     return env;
 }
 
+void JNIWrapper::_createDetachKey() {
+    pthread_key_create(&_detachKey, _detachCurrentThread);
+}
+
+void JNIWrapper::_detachCurrentThread(void *env) {
+    _jniVM->DetachCurrentThread();
+}
+
 void JNIWrapper::initializeNativeObject(jobject object, jstring className) {
     JNIEnv* env = JNIWrapper::getEnvironment();
 
@@ -221,14 +233,22 @@ std::string JNIWrapper::jstring2string(jstring string) {
         return "";
     }
 
-    const jbyteArray stringJbytes = (jbyteArray) env->CallObjectMethod(string, _jniStringGetBytes, _jniCharsetName);
-    const jsize length = env->GetArrayLength(stringJbytes);
-    jbyte* pBytes = env->GetByteArrayElements(stringJbytes, NULL);
-
-    std::string ret = std::string((char *)pBytes, (unsigned long)length);
+    std::string ret;
+    const jsize length = env->GetStringLength(string);
+    if(length <= 0) {
+        return ret;
+    }
 
-    env->ReleaseByteArrayElements(stringJbytes, pBytes, JNI_ABORT);
-    env->DeleteLocalRef(stringJbytes);
+    if((size_t)length <= JNIStringCoding::kStackBufferLength) {
+        jchar buffer[JNIStringCoding::kStackBufferLength];
+        env->GetStringRegion(string, 0, length, buffer);
+        JNIStringCoding::utf16ToUtf8(buffer, (size_t)length, ret);
+    } else {
+        // transcoding does not call back into java, so longer strings can be read in place
+        const jchar *chars = env->GetStringCritical(string, nullptr);
+        JNIStringCoding::utf16ToUtf8(chars, (size_t)length, ret);
+        env->ReleaseStringCritical(string, chars);
+    }
 
     return ret;
 }
@@ -240,24 +260,23 @@ jstring JNIWrapper::string2jstring(const std::string& string) {
     JNIEnv *env = JNIWrapper::getEnvironment();
     JNI_ASSERT(env, "JNI Environment not initialized");
 
-    jsize len =  (jsize)string.length();
-
-    const jbyteArray bytes = env->NewByteArray(len);
-    env->SetByteArrayRegion(bytes, 0, len, (jbyte*)string.c_str());
-
-    jstring javaString = (jstring)env->NewObject(_jniStringClass, _jniStringInit, bytes, _jniCharsetName);
-
-    env->DeleteLocalRef(bytes);
+    // utf-16 never needs more chars than utf-8 needs bytes
+    const size_t length = string.length();
+    if(length <= JNIStringCoding::kStackBufferLength) {
+        jchar buffer[JNIStringCoding::kStackBufferLength];
+        size_t count = JNIStringCoding::utf8ToUtf16(string.data(), length, buffer);
+        return env->NewString(buffer, (jsize)count);
+    }
 
-    return javaString;
+    std::unique_ptr<jchar[]> buffer(new jchar[length]);
+    size_t count = JNIStringCoding::utf8ToUtf16(string.data(), length, buffer.get());
+    return env->NewString(buffer.get(), (jsize)count);
 }
 
 std::map<std::string, JNIClassInfo*> JNIWrapper::_objmap;
+std::atomic<JNIClassInfo*> JNIWrapper::_slots[JNITypeSlot::kMaxSlots];
 jfieldID JNIWrapper::_jniNativeHandleFieldID = nullptr;
 JavaVM* JNIWrapper::_jniVM = nullptr;
-JNIEnv* JNIWrapper::_jniEnv = nullptr;
-pid_t JNIWrapper::_jniThreadId = 0;
-jstring JNIWrapper::_jniCharsetName = nullptr;
-jclass JNIWrapper::_jniStringClass = nullptr;
-jmethodID JNIWrapper::_jniStringInit = nullptr;
-jmethodID JNIWrapper::_jniStringGetBytes = nullptr;
\ No newline at end of file
+thread_local JNIEnv* JNIWrapper::_jniEnv = nullptr;
+pthread_key_t JNIWrapper::_detachKey;
+pthread_once_t JNIWrapper::_detachKeyOnce = PTHREAD_ONCE_INIT;
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include "jni_assert.h"
 #include <unistd.h>
 #include <pthread.h>
+#include <atomic>
 
 #include "JNIRef.h"
 #include "JNIClassInfo.h"
@@ -29,7 +30,16 @@ public:
      */
     static bool isObjectInstanceOf(JNIObject *obj, const std::string &canonicalName);
     template<class ObjectType> static bool isObjectInstanceOf(JNIObject *obj) {
-        return isObjectInstanceOf(obj, JNIBase::getCanonicalName<ObjectType>());
+        JNIClassInfo *info = _getClassInfo<ObjectType>();
+        if(!info) return false;
+        JNIClassInfo *info2 = obj->_jniClassInfo;
+        while(info2 != info) {
+            info2 = info2->baseClassInfo;
+            if(!info2) {
+                return false;
+            }
+        }
+        return true;
     }
 
     /**
@@ -49,6 +59,7 @@ public:
     void registerObject(JNIObjectType type = JNIObjectType::kPersistent) {
         _registerObject(typeid(ObjectType).hash_code(), type, JNIBase::getCanonicalName<ObjectType>(), JNIBase::getCanonicalName<JNIObject>(),
                         initialize<ObjectType>, type != JNIObjectType::kTemporary ? instantiate<ObjectType> : nullptr);
+        _getClassInfo<ObjectType>();
     };
 
     /**
@@ -61,6 +72,7 @@ public:
     void registerObject(JNIObjectType type = JNIObjectType::kPersistent) {
         _registerObject(typeid(ObjectType).hash_code(), type, JNIBase::getCanonicalName<ObjectType>(), JNIBase::getCanonicalName<BaseObjectType>(),
                         initialize<ObjectType>, type != JNIObjectType::kTemporary ? instantiate<ObjectType> : nullptr);
+        _getClassInfo<ObjectType>();
     };
 
     /**
@@ -132,11 +144,10 @@ public:
      */
     template <typename ObjectType> static
     JNILocalRef<ObjectType> wrapObject(jobject object) {
-        auto it = _objmap.find(JNIBase::getCanonicalName<ObjectType>());
-        if (!object || it == _objmap.end()){
+        JNIClassInfo *info = object ? _getClassInfo<ObjectType>() : nullptr;
+        if (!info){
             return nullptr;
         } else {
-            JNIClassInfo *info = it->second;
             JNIObject *jniObject;
             JNIEnv* env = JNIWrapper::getEnvironment();
             if(info->type == JNIObjectType::kPersistent || info->type == JNIObjectType::kAbstract) {
@@ -200,18 +211,33 @@ private:
 
     static void _registerObject(size_t hashCode, JNIObjectType type, const std::string& canonicalName, const std::string& baseCanonicalName, ObjectInitializer i, ObjectConstructor c);
 
-    static pthread_mutex_t _mutexEnv;
+    /**
+     * returns the class info registered for a native type, or nullptr if it is not registered
+     * the info is cached in the types slot; the canonical name is only built the first time
+     */
+    template<class ObjectType> static
+    JNIClassInfo* _getClassInfo() {
+        const size_t slot = JNITypeSlot::get<ObjectType>();
+        if(slot < JNITypeSlot::kMaxSlots) {
+            JNIClassInfo *info = _slots[slot].load(std::memory_order_acquire);
+            if(info) return info;
+        }
+        return _resolveSlot(slot, JNIBase::getCanonicalName<ObjectType>());
+    }
+    static JNIClassInfo* _resolveSlot(size_t slot, const std::string& canonicalName);
+
+    static JNIEnv* _attachCurrentThread();
+    static void _createDetachKey();
+    static void _detachCurrentThread(void *env);
+
     static JavaVM *_jniVM;
-    static JNIEnv *_jniEnv;
-    static pid_t _jniThreadId;
+    static thread_local JNIEnv *_jniEnv;
+    static pthread_key_t _detachKey;
+    static pthread_once_t _detachKeyOnce;
     static jfieldID _jniNativeHandleFieldID;
 
-    static jclass _jniStringClass;
-    static jmethodID _jniStringGetBytes;
-    static jmethodID _jniStringInit;
-    static jstring _jniCharsetName;
-
     static std::map<std::string, JNIClassInfo*> _objmap;
+    static std::atomic<JNIClassInfo*> _slots[JNITypeSlot::kMaxSlots];
 
     template<class ObjectType>
     static JNIObject* instantiate(jobject obj, JNIClassInfo *info) {
@@ -3,12 +3,20 @@
 //
 
 #include "JNIV8Array.h"
+#include "JNIV8ArrayElements.h"
 #include "JNIV8Wrapper.h"
 #include "../bgjs/BGJSV8Engine.h"
 
+#include <algorithm>
+#include <cmath>
+
 BGJS_JNI_LINK(JNIV8Array, "ag/boersego/bgjs/JNIV8Array");
 
+// number of elements converted per handle scope (and per JNI region copy) by the bulk methods
+#define BULK_CHUNK_SIZE 256
+
 decltype(JNIV8Array::_jniObject) JNIV8Array::_jniObject = {0};
+std::atomic<bool> JNIV8Array::_wrapTypedArrays(false);
 
 /**
  * cache JNI class references
@@ -25,46 +33,113 @@ void JNIV8Array::initializeJNIBindings(JNIClassInfo *info, bool isReload) {
     info->registerNativeMethod("getV8Length", "()I", (void*)JNIV8Array::jniGetV8Length);
     info->registerNativeMethod("_getV8Elements", "(IILjava/lang/Class;II)[Ljava/lang/Object;", (void*)JNIV8Array::jniGetV8ElementsInRange);
     info->registerNativeMethod("_getV8Element", "(IILjava/lang/Class;I)Ljava/lang/Object;", (void*)JNIV8Array::jniGetV8Element);
+    info->registerNativeMethod("setTypedArrayWrapping", "(Z)V", (void*)JNIV8Array::jniSetTypedArrayWrapping);
+    info->registerNativeMethod("isTypedArrayWrappingEnabled", "()Z", (void*)JNIV8Array::jniIsTypedArrayWrappingEnabled);
+
+    info->registerNativeMethod("getV8ElementsAsDoubles", "(II)[D", (void*)JNIV8Array::jniGetV8PrimitiveElements<jdouble>);
+    info->registerNativeMethod("getV8ElementsAsFloats", "(II)[F", (void*)JNIV8Array::jniGetV8PrimitiveElements<jfloat>);
+    info->registerNativeMethod("getV8ElementsAsInts", "(II)[I", (void*)JNIV8Array::jniGetV8PrimitiveElements<jint>);
+    info->registerNativeMethod("getV8ElementsAsLongs", "(II)[J", (void*)JNIV8Array::jniGetV8PrimitiveElements<jlong>);
+    info->registerNativeMethod("getV8ElementsAsBooleans", "(II)[Z", (void*)JNIV8Array::jniGetV8PrimitiveElements<jboolean>);
+    info->registerNativeMethod("setV8Elements", "(I[D)V", (void*)JNIV8Array::jniSetV8PrimitiveElements<jdouble>);
+    info->registerNativeMethod("setV8Elements", "(I[F)V", (void*)JNIV8Array::jniSetV8PrimitiveElements<jfloat>);
+    info->registerNativeMethod("setV8Elements", "(I[I)V", (void*)JNIV8Array::jniSetV8PrimitiveElements<jint>);
+    info->registerNativeMethod("setV8Elements", "(I[J)V", (void*)JNIV8Array::jniSetV8PrimitiveElements<jlong>);
+    info->registerNativeMethod("setV8Elements", "(I[Z)V", (void*)JNIV8Array::jniSetV8PrimitiveElements<jboolean>);
 }
 
 void JNIV8Array::initializeV8Bindings(JNIV8ClassInfo *info) {
 
 }
 
+bool JNIV8Array::isTypedArrayWrappingEnabled() {
+    return _wrapTypedArrays.load(std::memory_order_relaxed);
+}
+
+void JNIV8Array::jniSetTypedArrayWrapping(JNIEnv *env, jobject obj, jboolean enabled) {
+    _wrapTypedArrays.store(enabled != 0, std::memory_order_relaxed);
+}
+
+jboolean JNIV8Array::jniIsTypedArrayWrappingEnabled(JNIEnv *env, jobject obj) {
+    return (jboolean)isTypedArrayWrappingEnabled();
+}
+
+/**
+ * returns the number of elements of an array or typed array
+ */
+static uint32_t getArrayLength(v8::Local<v8::Object> array) {
+    if(array->IsTypedArray()) {
+        return (uint32_t)array.As<v8::TypedArray>()->Length();
+    }
+    return array.As<v8::Array>()->Length();
+}
+
+/**
+ * clamps the inclusive range [from, to] to an array of the specified length
+ * returns the number of elements in the clamped range
+ */
+static uint32_t clampRange(uint32_t len, jint &from, jint &to) {
+    if(from < 0) from = 0;
+    if(to < 0 || from > to || (uint32_t)from >= len) return 0;
+    if((uint32_t)to >= len) to = (jint)(len - 1);
+    return (uint32_t)(to - from) + 1;
+}
+
+/**
+ * throws the js exception matching a failed conversion of an element
+ */
+static void throwElementError(JNIV8MarshallingError res, uint32_t index, v8::Local<v8::Value> value) {
+    switch(res) {
+        default:
+        case JNIV8MarshallingError::kWrongType:
+            ThrowV8TypeError("wrong type for value of element #" + std::to_string(index));
+            break;
+        case JNIV8MarshallingError::kUndefined:
+            ThrowV8TypeError("value of element #" + std::to_string(index) + " must not be undefined");
+            break;
+        case JNIV8MarshallingError::kNotNullable:
+            ThrowV8TypeError("value of element #" + std::to_string(index) + " is not nullable");
+            break;
+        case JNIV8MarshallingError::kNoNaN:
+            ThrowV8TypeError("value of element #" + std::to_string(index) + " must not be NaN");
+            break;
+        case JNIV8MarshallingError::kVoidNotNull:
+            ThrowV8TypeError("value of element #" + std::to_string(index) + " can only be null or undefined");
+            break;
+        case JNIV8MarshallingError::kOutOfRange:
+            ThrowV8RangeError("value '"+
+                              JNIV8Marshalling::v8string2string(value->ToString())+"' is out of range for element element #" + std::to_string(index));
+            break;
+    }
+}
+
 /**
  * returns the length of the array
  */
 jint JNIV8Array::jniGetV8Length(JNIEnv *env, jobject obj) {
-    JNIV8Object_PrepareJNICall(JNIV8Array, v8::Array, 0);
-    return localRef->Length();
+    JNIV8Object_PrepareJNICall(JNIV8Array, v8::Object, 0);
+    return getArrayLength(localRef);
 }
 
 /**
  * Returns all objects from a specified range inside of the array
  */
 jobjectArray JNIV8Array::jniGetV8ElementsInRange(JNIEnv *env, jobject obj, jint flags, jint type, jclass returnType, jint from, jint to) {
-    JNIV8Object_PrepareJNICall(JNIV8Array, v8::Array, nullptr);
+    JNIV8Object_PrepareJNICall(JNIV8Array, v8::Object, nullptr);
 
     JNIV8JavaValue arg = JNIV8Marshalling::valueWithClass(type, returnType, (JNIV8MarshallingFlags)flags);
 
-    uint32_t len = localRef->Length();
-    uint32_t size;
-
-    // clamp range
-    if(to>=len) to = len - 1;
-    if(from<0) from = 0;
-
-    // now determine size of slice
-    if(from < len && from <= to) {
-        size = (uint32_t)((to-from)+1);
-    } else {
-        size = 0;
-    }
+    uint32_t size = clampRange(getArrayLength(localRef), from, to);
 
     jobjectArray elements = env->NewObjectArray(size, _jniObject.clazz, nullptr);
     if(!size) return elements;
 
-    for(uint32_t i=(uint32_t)from; i<=to; i++) {
+    for(uint32_t i=(uint32_t)from; i<=(uint32_t)to; i++) {
+        // every converted element creates local references; release them right away so large arrays
+        // do not overflow the local reference table
+        env->PushLocalFrame(4);
+        v8::HandleScope elementScope(isolate);
+
         v8::MaybeLocal<v8::Value> maybeValue = localRef->Get(context, i);
         v8::Local<v8::Value> value;
         if(maybeValue.IsEmpty()) {
@@ -99,20 +174,117 @@ jobjectArray JNIV8Array::jniGetV8ElementsInRange(JNIEnv *env, jobject obj, jint
                                       JNIV8Marshalling::v8string2string(value->ToString())+"' is out of range for element element #" + std::to_string(i));
                     break;
             }
+            env->PopLocalFrame(nullptr);
             return nullptr;
         }
 
         env->SetObjectArrayElement(elements, i-from, jval.l);
+        env->PopLocalFrame(nullptr);
     }
     return elements;
 }
 
+/**
+ * copies all elements from a specified range inside of the array into a primitive java array, without boxing them
+ */
+template<typename T>
+jarray JNIV8Array::jniGetV8PrimitiveElements(JNIEnv *env, jobject obj, jint from, jint to) {
+    JNIV8Object_PrepareJNICall(JNIV8Array, v8::Object, nullptr);
+
+    uint32_t size = clampRange(getArrayLength(localRef), from, to);
+
+    jarray elements = JNIV8ArrayElements<T>::newArray(env, size);
+    if(!size || !elements) return elements;
+
+    // typed arrays of the same type are copied straight from their backing store
+    if(localRef->IsTypedArray() && JNIV8ArrayElements<T>::isNativeType(localRef.As<v8::TypedArray>())) {
+        v8::Local<v8::TypedArray> typedArray = localRef.As<v8::TypedArray>();
+        uint8_t *data = (uint8_t*)typedArray->Buffer()->GetContents().Data() + typedArray->ByteOffset();
+        JNIV8ArrayElements<T>::setRegion(env, elements, 0, size, ((T*)data) + from);
+        return elements;
+    }
+
+    // everything else is converted into a buffer on the stack, and copied to java one chunk at a time
+    T buffer[BULK_CHUNK_SIZE];
+    for(uint32_t offset = 0; offset < size; offset += BULK_CHUNK_SIZE) {
+        v8::HandleScope chunkScope(isolate);
+        uint32_t count = std::min<uint32_t>(BULK_CHUNK_SIZE, size - offset);
+        for(uint32_t j = 0; j < count; j++) {
+            uint32_t i = (uint32_t)from + offset + j;
+            v8::Local<v8::Value> value;
+            if(!localRef->Get(context, i).ToLocal(&value)) {
+                engine->forwardV8ExceptionToJNI(&try_catch);
+                return nullptr;
+            }
+            JNIV8MarshallingError res = JNIV8ArrayElements<T>::fromValue(value, &buffer[j]);
+            if(res != JNIV8MarshallingError::kOk) {
+                throwElementError(res, i, value);
+                engine->forwardV8ExceptionToJNI(&try_catch);
+                return nullptr;
+            }
+        }
+        JNIV8ArrayElements<T>::setRegion(env, elements, offset, count, buffer);
+    }
+
+    return elements;
+}
+
+/**
+ * copies all elements of a primitive java array into the array, starting at the specified index
+ * arrays grow as needed, typed arrays throw a RangeError if the elements do not fit
+ */
+template<typename T>
+void JNIV8Array::jniSetV8PrimitiveElements(JNIEnv *env, jobject obj, jint index, jarray elements) {
+    JNIV8Object_PrepareJNICall(JNIV8Array, v8::Object, void());
+
+    if(!elements) {
+        env->ThrowNew(env->FindClass("java/lang/NullPointerException"), "elements must not be null");
+        return;
+    }
+    uint32_t size = (uint32_t)env->GetArrayLength(elements);
+
+    if(index < 0) {
+        ThrowV8RangeError("index " + std::to_string(index) + " is out of range");
+        engine->forwardV8ExceptionToJNI(&try_catch);
+        return;
+    }
+
+    if(localRef->IsTypedArray()) {
+        v8::Local<v8::TypedArray> typedArray = localRef.As<v8::TypedArray>();
+        if((size_t)index + size > typedArray->Length()) {
+            ThrowV8RangeError("elements do not fit into typed array of length " + std::to_string(typedArray->Length()));
+            engine->forwardV8ExceptionToJNI(&try_catch);
+            return;
+        }
+        // typed arrays of the same type are filled straight from java
+        if(JNIV8ArrayElements<T>::isNativeType(typedArray)) {
+            if(!size) return;
+            uint8_t *data = (uint8_t*)typedArray->Buffer()->GetContents().Data() + typedArray->ByteOffset();
+            JNIV8ArrayElements<T>::getRegion(env, elements, 0, size, ((T*)data) + index);
+            return;
+        }
+    }
+
+    T buffer[BULK_CHUNK_SIZE];
+    for(uint32_t offset = 0; offset < size; offset += BULK_CHUNK_SIZE) {
+        v8::HandleScope chunkScope(isolate);
+        uint32_t count = std::min<uint32_t>(BULK_CHUNK_SIZE, size - offset);
+        JNIV8ArrayElements<T>::getRegion(env, elements, offset, count, buffer);
+        for(uint32_t j = 0; j < count; j++) {
+            if(localRef->Set(context, (uint32_t)index + offset + j, JNIV8ArrayElements<T>::toValue(isolate, buffer[j])).IsNothing()) {
+                engine->forwardV8ExceptionToJNI(&try_catch);
+                return;
+            }
+        }
+    }
+}
+
 /**
  * Returns the object at the specified index
  * if index is out of bounds, returns JNIV8Undefined
  */
 jobject JNIV8Array::jniGetV8Element(JNIEnv *env, jobject obj, jint flags, jint type, jclass returnType, jint index) {
-    JNIV8Object_PrepareJNICall(JNIV8Array, v8::Array, JNIV8Marshalling::undefinedInJava());
+    JNIV8Object_PrepareJNICall(JNIV8Array, v8::Object, JNIV8Marshalling::undefinedInJava());
 
     JNIV8JavaValue arg = JNIV8Marshalling::valueWithClass(type, returnType, (JNIV8MarshallingFlags)flags);
 
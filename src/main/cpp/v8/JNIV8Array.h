@@ -7,6 +7,11 @@
 
 #include "JNIV8Wrapper.h"
 
+#include <atomic>
+
+/**
+ * wrapper for js arrays and typed arrays
+ */
 class JNIV8Array : public JNIScope<JNIV8Array, JNIV8Object> {
 public:
     JNIV8Array(jobject obj, JNIClassInfo *info) : JNIScope(obj, info) {};
@@ -28,12 +33,30 @@ public:
      */
     static jobjectArray jniGetV8ElementsInRange(JNIEnv *env, jobject obj, jint flags, jint type, jclass returnType, jint from, jint to);
 
+    /**
+     * copies all elements from a specified range inside of the array into a primitive java array, without boxing them
+     * T is the java element type (jdouble, jfloat, jint, jlong or jboolean)
+     */
+    template<typename T> static jarray jniGetV8PrimitiveElements(JNIEnv *env, jobject obj, jint from, jint to);
+
+    /**
+     * copies all elements of a primitive java array into the array, starting at the specified index
+     */
+    template<typename T> static void jniSetV8PrimitiveElements(JNIEnv *env, jobject obj, jint index, jarray elements);
+
     /**
      * Returns the object at the specified index
      * if index is out of bounds, returns JNIV8Undefined
      */
     static jobject jniGetV8Element(JNIEnv *env, jobject obj, jint flags, jint type, jclass returnType, jint index);
 
+    /**
+     * typed arrays are passed to java as JNIV8Array only if enabled, as JNIV8GenericObject otherwise
+     */
+    static bool isTypedArrayWrappingEnabled();
+    static void jniSetTypedArrayWrapping(JNIEnv *env, jobject obj, jboolean enabled);
+    static jboolean jniIsTypedArrayWrappingEnabled(JNIEnv *env, jobject obj);
+
     /**
      * cache JNI class references
      */
@@ -42,6 +65,7 @@ private:
     static struct {
         jclass clazz;
     } _jniObject;
+    static std::atomic<bool> _wrapTypedArrays;
 };
 
 BGJS_JNI_LINK_DEF(JNIV8Array)
@@ -0,0 +1,244 @@
+//
+// JNIV8ArrayBuffer.cpp
+//
+
+#include "JNIV8ArrayBuffer.h"
+#include "JNIV8Wrapper.h"
+#include "../bgjs/BGJSV8Engine.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+BGJS_JNI_LINK(JNIV8ArrayBuffer, "ag/boersego/bgjs/JNIV8ArrayBuffer");
+
+decltype(JNIV8ArrayBuffer::_jniByteBuffer) JNIV8ArrayBuffer::_jniByteBuffer = {0};
+
+/**
+ * keeps the java ByteBuffer backing an ArrayBuffer alive until the ArrayBuffer was collected
+ */
+struct JNIV8ByteBufferHolder {
+    jobject byteBuffer;
+    void *data;
+    int64_t byteLength;
+    v8::Isolate *isolate;
+    v8::Persistent<v8::ArrayBuffer> arrayBuffer;
+    BGJSFinalizationQueue *finalizationQueue;
+};
+
+/**
+ * keeps an ArrayBuffer alive as long as a ByteBuffer returned by getByteBuffer might still access its memory
+ */
+struct JNIV8ByteBufferPin {
+    jweak byteBuffer;
+    v8::Isolate *isolate;
+    v8::Persistent<v8::ArrayBuffer> arrayBuffer;
+};
+
+// ArrayBuffers created from ByteBuffers, by isolate and address; a ByteBuffer is always shared as the same ArrayBuffer
+static std::map<std::pair<v8::Isolate*, void*>, JNIV8ByteBufferHolder*> byteBufferHolders;
+static std::vector<JNIV8ByteBufferPin*> byteBufferPins;
+static std::mutex byteBufferMutex;
+
+static void byteBufferHolderWeakCallback(const v8::WeakCallbackInfo<JNIV8ByteBufferHolder>& data) {
+    JNIV8ByteBufferHolder *holder = data.GetParameter();
+    holder->arrayBuffer.Reset();
+    data.GetIsolate()->AdjustAmountOfExternalAllocatedMemory(-holder->byteLength);
+    holder->finalizationQueue->enqueueGlobalRef(holder->byteBuffer);
+
+    {
+        std::lock_guard<std::mutex> lock(byteBufferMutex);
+        // the buffer might have been neutered and shared again in the meantime; that holder is not ours to remove
+        auto it = byteBufferHolders.find(std::make_pair(holder->isolate, holder->data));
+        if(it != byteBufferHolders.end() && it->second == holder) {
+            byteBufferHolders.erase(it);
+        }
+    }
+
+    delete holder;
+}
+
+/**
+ * cache JNI class references
+ */
+void JNIV8ArrayBuffer::initJNICache() {
+    JNIEnv *env = JNIWrapper::getEnvironment();
+    _jniByteBuffer.clazz = (jclass)env->NewGlobalRef(env->FindClass("java/nio/ByteBuffer"));
+    _jniByteBuffer.allocateDirectId = env->GetStaticMethodID(_jniByteBuffer.clazz, "allocateDirect", "(I)Ljava/nio/ByteBuffer;");
+}
+
+void JNIV8ArrayBuffer::initializeJNIBindings(JNIClassInfo *info, bool isReload) {
+    info->registerNativeMethod("Create", "(Lag/boersego/bgjs/V8Engine;I)Lag/boersego/bgjs/JNIV8ArrayBuffer;", (void*)JNIV8ArrayBuffer::jniCreate);
+    info->registerNativeMethod("CreateWithByteBuffer", "(Lag/boersego/bgjs/V8Engine;Ljava/nio/ByteBuffer;)Lag/boersego/bgjs/JNIV8ArrayBuffer;", (void*)JNIV8ArrayBuffer::jniCreateWithByteBuffer);
+    info->registerNativeMethod("getByteLength", "()I", (void*)JNIV8ArrayBuffer::jniGetByteLength);
+    info->registerNativeMethod("_getByteBuffer", "()Ljava/nio/ByteBuffer;", (void*)JNIV8ArrayBuffer::jniGetByteBuffer);
+    info->registerNativeMethod("neuter", "()V", (void*)JNIV8ArrayBuffer::jniNeuter);
+}
+
+void JNIV8ArrayBuffer::initializeV8Bindings(JNIV8ClassInfo *info) {
+
+}
+
+v8::MaybeLocal<v8::ArrayBuffer> JNIV8ArrayBuffer::newArrayBuffer(v8::Isolate *isolate, jobject byteBuffer) {
+    JNIEnv *env = JNIWrapper::getEnvironment();
+
+    // only direct buffers have memory outside of the java heap that can not be moved by the java gc
+    void *data = env->GetDirectBufferAddress(byteBuffer);
+    jlong capacity = env->GetDirectBufferCapacity(byteBuffer);
+    if(!data || capacity < 0) {
+        return v8::MaybeLocal<v8::ArrayBuffer>();
+    }
+
+    v8::EscapableHandleScope scope(isolate);
+
+    // passing the same buffer again returns the existing ArrayBuffer, so its memory is only reported to the gc once
+    // NOTE: the lock is not held while v8 allocates; a gc would run the weak callback, which takes it as well
+    const auto key = std::make_pair(isolate, data);
+    {
+        std::lock_guard<std::mutex> lock(byteBufferMutex);
+        auto it = byteBufferHolders.find(key);
+        if(it != byteBufferHolders.end()) {
+            v8::Local<v8::ArrayBuffer> arrayBuffer = v8::Local<v8::ArrayBuffer>::New(isolate, it->second->arrayBuffer);
+            // a neutered buffer is replaced; its holder stays until the ArrayBuffer was collected
+            if((jlong)arrayBuffer->ByteLength() == capacity) {
+                return scope.Escape(arrayBuffer);
+            }
+        }
+    }
+
+    // v8 does not own the memory, it is released by java once the ByteBuffer is no longer referenced
+    v8::Local<v8::ArrayBuffer> arrayBuffer = v8::ArrayBuffer::New(isolate, data, (size_t)capacity,
+                                                                  v8::ArrayBufferCreationMode::kExternalized);
+
+    JNIV8ByteBufferHolder *holder = new JNIV8ByteBufferHolder();
+    holder->byteBuffer = env->NewGlobalRef(byteBuffer);
+    holder->data = data;
+    holder->byteLength = capacity;
+    holder->isolate = isolate;
+    holder->finalizationQueue = BGJSV8Engine::GetInstance(isolate)->getFinalizationQueue();
+    holder->arrayBuffer.Reset(isolate, arrayBuffer);
+    holder->arrayBuffer.SetWeak(holder, byteBufferHolderWeakCallback, v8::WeakCallbackType::kParameter);
+
+    {
+        std::lock_guard<std::mutex> lock(byteBufferMutex);
+        byteBufferHolders[key] = holder;
+    }
+
+    // the memory is kept alive by the js object => let the gc know about it
+    isolate->AdjustAmountOfExternalAllocatedMemory(capacity);
+
+    return scope.Escape(arrayBuffer);
+}
+
+jint JNIV8ArrayBuffer::jniGetByteLength(JNIEnv *env, jobject obj) {
+    JNIV8Object_PrepareJNICall(JNIV8ArrayBuffer, v8::ArrayBuffer, 0);
+    return (jint)localRef->ByteLength();
+}
+
+jobject JNIV8ArrayBuffer::jniGetByteBuffer(JNIEnv *env, jobject obj) {
+    JNIV8Object_PrepareJNICall(JNIV8ArrayBuffer, v8::ArrayBuffer, nullptr);
+
+    // backing stores are never moved by the gc; they are only released once the ArrayBuffer was collected
+    v8::ArrayBuffer::Contents contents = localRef->GetContents();
+    if(!contents.Data() || !contents.ByteLength()) {
+        // neutered or empty buffers have no memory to point to
+        return env->CallStaticObjectMethod(_jniByteBuffer.clazz, _jniByteBuffer.allocateDirectId, 0);
+    }
+
+    jobject byteBuffer = env->NewDirectByteBuffer(contents.Data(), (jlong)contents.ByteLength());
+    if(!byteBuffer) {
+        return nullptr;
+    }
+
+    // the ByteBuffer can outlive this wrapper => the ArrayBuffer is pinned until the ByteBuffer was collected,
+    // see releaseByteBuffers
+    JNIV8ByteBufferPin *pin = new JNIV8ByteBufferPin();
+    pin->byteBuffer = env->NewWeakGlobalRef(byteBuffer);
+    pin->isolate = isolate;
+    pin->arrayBuffer.Reset(isolate, localRef);
+
+    std::lock_guard<std::mutex> lock(byteBufferMutex);
+    byteBufferPins.push_back(pin);
+
+    return byteBuffer;
+}
+
+void JNIV8ArrayBuffer::releaseByteBuffers(v8::Isolate *isolate, bool all) {
+    std::lock_guard<std::mutex> lock(byteBufferMutex);
+    if(byteBufferPins.empty() && (!all || byteBufferHolders.empty())) {
+        return;
+    }
+
+    JNIEnv *env = JNIWrapper::getEnvironment();
+    for(size_t i = 0; i < byteBufferPins.size();) {
+        JNIV8ByteBufferPin *pin = byteBufferPins[i];
+        // a cleared weak reference compares equal to null
+        if(pin->isolate != isolate || (!all && !env->IsSameObject(pin->byteBuffer, nullptr))) {
+            i++;
+            continue;
+        }
+        pin->arrayBuffer.Reset();
+        env->DeleteWeakGlobalRef(pin->byteBuffer);
+        delete pin;
+        byteBufferPins[i] = byteBufferPins.back();
+        byteBufferPins.pop_back();
+    }
+
+    if(!all) return;
+
+    // weak callbacks do not run for objects that are alive when the isolate goes away
+    for(auto it = byteBufferHolders.begin(); it != byteBufferHolders.end();) {
+        JNIV8ByteBufferHolder *holder = it->second;
+        if(it->first.first != isolate) {
+            ++it;
+            continue;
+        }
+        holder->arrayBuffer.Reset();
+        env->DeleteGlobalRef(holder->byteBuffer);
+        delete holder;
+        it = byteBufferHolders.erase(it);
+    }
+}
+
+void JNIV8ArrayBuffer::jniNeuter(JNIEnv *env, jobject obj) {
+    JNIV8Object_PrepareJNICall(JNIV8ArrayBuffer, v8::ArrayBuffer, void());
+
+    // memory owned by v8 can not be taken away from it
+    if(!localRef->IsExternal() || !localRef->IsNeuterable()) {
+        env->ThrowNew(env->FindClass("java/lang/IllegalStateException"), "Only ArrayBuffers created from a ByteBuffer can be neutered");
+        return;
+    }
+    localRef->Neuter();
+}
+
+jobject JNIV8ArrayBuffer::jniCreate(JNIEnv *env, jobject obj, jobject engineObj, jint byteLength) {
+    auto engine = JNIWrapper::wrapObject<BGJSV8Engine>(engineObj);
+
+    v8::Isolate* isolate = engine->getIsolate();
+    v8::Locker l(isolate);
+    v8::Isolate::Scope isolateScope(isolate);
+    v8::HandleScope scope(isolate);
+    v8::Context::Scope ctxScope(engine->getContext());
+
+    v8::Local<v8::Object> objRef = v8::ArrayBuffer::New(isolate, (size_t)byteLength);
+
+    return JNIV8Wrapper::wrapObject<JNIV8ArrayBuffer>(objRef)->getJObject();
+}
+
+jobject JNIV8ArrayBuffer::jniCreateWithByteBuffer(JNIEnv *env, jobject obj, jobject engineObj, jobject byteBuffer) {
+    auto engine = JNIWrapper::wrapObject<BGJSV8Engine>(engineObj);
+
+    v8::Isolate* isolate = engine->getIsolate();
+    v8::Locker l(isolate);
+    v8::Isolate::Scope isolateScope(isolate);
+    v8::HandleScope scope(isolate);
+    v8::Context::Scope ctxScope(engine->getContext());
+
+    v8::Local<v8::ArrayBuffer> objRef;
+    if(!byteBuffer || !newArrayBuffer(isolate, byteBuffer).ToLocal(&objRef)) {
+        env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"), "ByteBuffer must be direct");
+        return nullptr;
+    }
+
+    return JNIV8Wrapper::wrapObject<JNIV8ArrayBuffer>(objRef)->getJObject();
+}
@@ -0,0 +1,73 @@
+//
+// JNIV8ArrayBuffer.h
+//
+
+#ifndef ANDROID_TRADINGLIB_SAMPLE_JNIV8ARRAYBUFFER_H
+#define ANDROID_TRADINGLIB_SAMPLE_JNIV8ARRAYBUFFER_H
+
+#include "JNIV8Wrapper.h"
+
+/**
+ * wrapper for js ArrayBuffers
+ * their memory is shared with java direct ByteBuffers without copying, see JNIV8ArrayBuffer.java for the ownership rules
+ */
+class JNIV8ArrayBuffer : public JNIScope<JNIV8ArrayBuffer, JNIV8Object> {
+public:
+    JNIV8ArrayBuffer(jobject obj, JNIClassInfo *info) : JNIScope(obj, info) {};
+
+    static void initializeJNIBindings(JNIClassInfo *info, bool isReload);
+    static void initializeV8Bindings(JNIV8ClassInfo *info);
+
+    static jobject jniCreate(JNIEnv *env, jobject obj, jobject engineObj, jint byteLength);
+    static jobject jniCreateWithByteBuffer(JNIEnv *env, jobject obj, jobject engineObj, jobject byteBuffer);
+
+    /**
+     * returns the length of the buffer in bytes; 0 if it was neutered
+     */
+    static jint jniGetByteLength(JNIEnv *env, jobject obj);
+
+    /**
+     * returns a direct ByteBuffer referencing the memory of the buffer
+     */
+    static jobject jniGetByteBuffer(JNIEnv *env, jobject obj);
+
+    /**
+     * detaches the memory of an ArrayBuffer created from a ByteBuffer from javascript
+     */
+    static void jniNeuter(JNIEnv *env, jobject obj);
+
+    /**
+     * creates an ArrayBuffer using the memory of a java direct ByteBuffer
+     * the ByteBuffer is kept alive until the ArrayBuffer is collected
+     * returns an empty handle if the ByteBuffer is not direct
+     */
+    static v8::MaybeLocal<v8::ArrayBuffer> newArrayBuffer(v8::Isolate *isolate, jobject byteBuffer);
+
+    /**
+     * lets the ArrayBuffers of the isolate go whose ByteBuffers returned by getByteBuffer were collected by java
+     * if all is set, all references between the isolate and java buffers are dropped, before the isolate goes away
+     * the isolate has to be locked
+     */
+    static void releaseByteBuffers(v8::Isolate *isolate, bool all);
+
+    /**
+     * returns the class java.nio.ByteBuffer
+     */
+    static jclass getByteBufferClass() {
+        return _jniByteBuffer.clazz;
+    }
+
+    /**
+     * cache JNI class references
+     */
+    static void initJNICache();
+private:
+    static struct {
+        jclass clazz;
+        jmethodID allocateDirectId;
+    } _jniByteBuffer;
+};
+
+BGJS_JNI_LINK_DEF(JNIV8ArrayBuffer)
+
+#endif //ANDROID_TRADINGLIB_SAMPLE_JNIV8ARRAYBUFFER_H
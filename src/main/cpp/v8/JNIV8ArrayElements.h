@@ -0,0 +1,105 @@
+//
+// JNIV8ArrayElements.h
+//
+
+#ifndef __JNIV8ARRAYELEMENTS_H
+#define __JNIV8ARRAYELEMENTS_H
+
+#include <jni.h>
+#include <v8.h>
+#include <cmath>
+
+#include "JNIV8Marshalling.h"
+
+/**
+ * element type specific parts of the bulk copies between js values and primitive java arrays
+ * - isNativeType: typed arrays with the same memory layout as the java array can be copied as a whole
+ * - fromValue/toValue: all other elements are converted one by one; like strict single values, numeric arrays only
+ *   accept numbers and boolean arrays only accept booleans, other values fail with kWrongType
+ */
+template<typename T> struct JNIV8ArrayElements;
+
+#define JNIV8ArrayElementsRegion(Type, ArrayType) \
+    static jarray newArray(JNIEnv *env, jsize length) { return env->New##Type##Array(length); }\
+    static void getRegion(JNIEnv *env, jarray array, jsize start, jsize length, ArrayType *buf) {\
+        env->Get##Type##ArrayRegion((ArrayType##Array)array, start, length, buf);\
+    }\
+    static void setRegion(JNIEnv *env, jarray array, jsize start, jsize length, const ArrayType *buf) {\
+        env->Set##Type##ArrayRegion((ArrayType##Array)array, start, length, buf);\
+    }
+
+template<> struct JNIV8ArrayElements<jdouble> {
+    JNIV8ArrayElementsRegion(Double, jdouble)
+    static bool isNativeType(v8::Local<v8::TypedArray> array) { return array->IsFloat64Array(); }
+    static JNIV8MarshallingError fromValue(v8::Local<v8::Value> value, jdouble *target) {
+        if(!value->IsNumber()) return JNIV8MarshallingError::kWrongType;
+        *target = value.As<v8::Number>()->Value();
+        return JNIV8MarshallingError::kOk;
+    }
+    static v8::Local<v8::Value> toValue(v8::Isolate *isolate, jdouble value) { return v8::Number::New(isolate, value); }
+};
+
+template<> struct JNIV8ArrayElements<jfloat> {
+    JNIV8ArrayElementsRegion(Float, jfloat)
+    static bool isNativeType(v8::Local<v8::TypedArray> array) { return array->IsFloat32Array(); }
+    static JNIV8MarshallingError fromValue(v8::Local<v8::Value> value, jfloat *target) {
+        // unlike single values, bulk copies are rounded to the nearest float instead of requiring an exact match
+        if(!value->IsNumber()) return JNIV8MarshallingError::kWrongType;
+        *target = (jfloat)value.As<v8::Number>()->Value();
+        return JNIV8MarshallingError::kOk;
+    }
+    static v8::Local<v8::Value> toValue(v8::Isolate *isolate, jfloat value) { return v8::Number::New(isolate, value); }
+};
+
+template<> struct JNIV8ArrayElements<jint> {
+    JNIV8ArrayElementsRegion(Int, jint)
+    static bool isNativeType(v8::Local<v8::TypedArray> array) { return array->IsInt32Array(); }
+    static JNIV8MarshallingError fromValue(v8::Local<v8::Value> value, jint *target) {
+        if(value->IsInt32()) {
+            *target = value.As<v8::Int32>()->Value();
+            return JNIV8MarshallingError::kOk;
+        }
+        if(!value->IsNumber()) return JNIV8MarshallingError::kWrongType;
+        double numberValue = value.As<v8::Number>()->Value();
+        if(std::isnan(numberValue)) return JNIV8MarshallingError::kNoNaN;
+        if(numberValue < INT32_MIN || numberValue > INT32_MAX) return JNIV8MarshallingError::kOutOfRange;
+        *target = (jint)numberValue;
+        if(*target != numberValue) return JNIV8MarshallingError::kOutOfRange;
+        return JNIV8MarshallingError::kOk;
+    }
+    static v8::Local<v8::Value> toValue(v8::Isolate *isolate, jint value) { return v8::Integer::New(isolate, value); }
+};
+
+template<> struct JNIV8ArrayElements<jlong> {
+    JNIV8ArrayElementsRegion(Long, jlong)
+    // there are no 64bit integer typed arrays yet
+    static bool isNativeType(v8::Local<v8::TypedArray> array) { return false; }
+    static JNIV8MarshallingError fromValue(v8::Local<v8::Value> value, jlong *target) {
+        if(value->IsInt32()) {
+            *target = value.As<v8::Int32>()->Value();
+            return JNIV8MarshallingError::kOk;
+        }
+        if(!value->IsNumber()) return JNIV8MarshallingError::kWrongType;
+        double numberValue = value.As<v8::Number>()->Value();
+        if(std::isnan(numberValue)) return JNIV8MarshallingError::kNoNaN;
+        if(numberValue < -9223372036854775808.0 || numberValue >= 9223372036854775808.0) return JNIV8MarshallingError::kOutOfRange;
+        *target = (jlong)numberValue;
+        if(*target != numberValue) return JNIV8MarshallingError::kOutOfRange;
+        return JNIV8MarshallingError::kOk;
+    }
+    static v8::Local<v8::Value> toValue(v8::Isolate *isolate, jlong value) { return v8::Number::New(isolate, (double)value); }
+};
+
+template<> struct JNIV8ArrayElements<jboolean> {
+    JNIV8ArrayElementsRegion(Boolean, jboolean)
+    // typed arrays only contain numbers, so they can never be copied into boolean arrays
+    static bool isNativeType(v8::Local<v8::TypedArray> array) { return false; }
+    static JNIV8MarshallingError fromValue(v8::Local<v8::Value> value, jboolean *target) {
+        if(!value->IsBoolean()) return JNIV8MarshallingError::kWrongType;
+        *target = (jboolean)value.As<v8::Boolean>()->Value();
+        return JNIV8MarshallingError::kOk;
+    }
+    static v8::Local<v8::Value> toValue(v8::Isolate *isolate, jboolean value) { return v8::Boolean::New(isolate, value != 0); }
+};
+
+#endif //__JNIV8ARRAYELEMENTS_H
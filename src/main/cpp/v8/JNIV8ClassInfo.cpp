@@ -9,11 +9,52 @@
 
 #include <cassert>
 #include <stdlib.h>
+#include <string.h>
 
 using namespace v8;
 
+// calls with up to this many arguments convert them into a buffer on the stack
+#define STACK_ARGUMENTS_COUNT 8
+
 decltype(JNIV8ClassInfo::_jniObject) JNIV8ClassInfo::_jniObject = {0};
 
+void JNIV8ObjectJavaCallbackHolder::addSignature(jmethodID methodId, std::vector<JNIV8JavaValue> *arguments) {
+    int index = (int)signatures.size();
+    signatures.push_back({methodId, arguments});
+
+    // the first overload registered for a number of arguments wins
+    if(!arguments) {
+        if(genericSignature < 0) {
+            genericSignature = index;
+        }
+        return;
+    }
+    size_t arity = arguments->size();
+    if(arity >= signaturesByArity.size()) {
+        signaturesByArity.resize(arity + 1, -1);
+    }
+    if(signaturesByArity[arity] < 0) {
+        signaturesByArity[arity] = index;
+    }
+}
+
+/**
+ * deletes a reference returned by a marshalling routine if it is local
+ * wrapped objects and undefined are returned as global or weak references, which must not be deleted here
+ */
+static inline void deleteLocalArgument(JNIEnv *env, jobject object) {
+    if(object && env->GetObjectRefType(object) == JNILocalRefType) {
+        env->DeleteLocalRef(object);
+    }
+}
+
+JNIV8ObjectJavaSignatureInfo* JNIV8ObjectJavaCallbackHolder::getSignature(int numArguments) {
+    if(numArguments < (int)signaturesByArity.size() && signaturesByArity[numArguments] >= 0) {
+        return &signatures[signaturesByArity[numArguments]];
+    }
+    return genericSignature >= 0 ? &signatures[genericSignature] : nullptr;
+}
+
 /**
  * cache JNI class references
  */
@@ -140,25 +181,14 @@ void JNIV8ClassInfo::v8JavaMethodCallback(const v8::FunctionCallbackInfo<v8::Val
         jobj = v8Object->getJObject();
     }
 
-    // try to find a matching signature
-    JNIV8ObjectJavaSignatureInfo *signature = nullptr;
-
-    for (auto sig : cb->signatures) {
-        if (!sig.arguments) {
-            if (!signature) {
-                signature = &sig;
-            }
-        } else if (sig.arguments->size() == args.Length()) {
-            signature = &sig;
-            break;
-        }
-    }
-
+    JNIV8ObjectJavaSignatureInfo *signature = cb->getSignature(args.Length());
     if(!signature) {
         isolate->ThrowException(v8::Exception::TypeError(String::NewFromUtf8(isolate, ("invalid number of arguments (" + std::to_string(args.Length()) + ") supplied to " + cb->methodName).c_str())));
         return;
     }
 
+    // small argument lists are converted on the stack; async calls own their arguments and always copy them to the heap
+    jvalue stackArgs[STACK_ARGUMENTS_COUNT];
     jvalue *jargs;
     size_t numJArgs;
 
@@ -166,11 +196,12 @@ void JNIV8ClassInfo::v8JavaMethodCallback(const v8::FunctionCallbackInfo<v8::Val
         // generic case: an array of objects!
         // nothing to validate here, this always works
         numJArgs = 1;
-        jargs = (jvalue*)malloc(sizeof(jvalue)*numJArgs);
-        memset(jargs, 0, sizeof(jvalue)*numJArgs);
+        jargs = stackArgs;
         jobjectArray jArray = env->NewObjectArray(args.Length(), _jniObject.clazz, nullptr);
         for (int idx = 0, n = args.Length(); idx < n; idx++) {
-            env->SetObjectArrayElement(jArray, idx, JNIV8Marshalling::v8value2jobject(args[idx]));
+            jobject element = JNIV8Marshalling::v8value2jobject(args[idx]);
+            env->SetObjectArrayElement(jArray, idx, element);
+            deleteLocalArgument(env, element);
         }
         jargs[0].l = jArray;
     } else {
@@ -178,7 +209,7 @@ void JNIV8ClassInfo::v8JavaMethodCallback(const v8::FunctionCallbackInfo<v8::Val
         // arguments might have to be of a certain type, so we need to validate!
         numJArgs = (size_t)args.Length();
         if(numJArgs) {
-            jargs = (jvalue *) malloc(sizeof(jvalue) * numJArgs);
+            jargs = numJArgs <= STACK_ARGUMENTS_COUNT ? stackArgs : (jvalue *) malloc(sizeof(jvalue) * numJArgs);
             memset(jargs, 0, sizeof(jvalue) * numJArgs);
 
             for(int idx = 0, n = args.Length(); idx < n; idx++) {
@@ -188,7 +219,9 @@ void JNIV8ClassInfo::v8JavaMethodCallback(const v8::FunctionCallbackInfo<v8::Val
                 JNIV8MarshallingError res = JNIV8Marshalling::convertV8ValueToJavaValue(env, value, arg, &(jargs[idx]));
                 if(res != JNIV8MarshallingError::kOk) {
                     // conversion failed => simply clean up & throw an exception
-                    free(jargs);
+                    if(jargs != stackArgs) {
+                        free(jargs);
+                    }
                     switch(res) {
                         default:
                         case JNIV8MarshallingError::kWrongType:
@@ -219,11 +252,45 @@ void JNIV8ClassInfo::v8JavaMethodCallback(const v8::FunctionCallbackInfo<v8::Val
         }
     }
 
+    if(cb->isAsync) {
+        // the converted arguments are owned by the call from here on
+        JNIV8AsyncJavaCall *call = new JNIV8AsyncJavaCall();
+        call->engine = BGJSV8Engine::GetInstance(isolate);
+        call->holder = cb;
+        call->javaMethodId = signature->javaMethodId;
+        call->javaObject = jobj;
+        if(jargs == stackArgs) {
+            call->arguments = (jvalue*)malloc(sizeof(jvalue) * numJArgs);
+            memcpy(call->arguments, stackArgs, sizeof(jvalue) * numJArgs);
+        } else {
+            call->arguments = jargs;
+        }
+        call->numArguments = jargs ? numJArgs : 0;
+        call->argumentTypes = signature->arguments;
+        call->result = nullptr;
+        call->exception = nullptr;
+        startAsyncJavaCall(args, call);
+        return;
+    }
+
     v8::Local<v8::Value> result;
 
     result = JNIV8Marshalling::callJavaMethod(env, cb->returnType, cb->javaClass, signature->javaMethodId, jobj, jargs);
 
-    if(jargs) {
+    // release local references right away; a script calling into java in a loop would otherwise
+    // accumulate them until control returns to java
+    for(size_t idx = 0; jargs && idx < numJArgs; idx++) {
+        if(!signature->arguments) {
+            env->DeleteLocalRef(jargs[idx].l);
+            continue;
+        }
+        const JNIV8JavaValue &type = (*signature->arguments)[idx];
+        if(type.clazz || type.valueType == JNIV8JavaValueType::kObject || type.valueType == JNIV8JavaValueType::kString) {
+            deleteLocalArgument(env, jargs[idx].l);
+        }
+    }
+
+    if(jargs && jargs != stackArgs) {
         free(jargs);
     }
 
@@ -294,7 +361,8 @@ void JNIV8ClassInfo::v8MethodCallback(const v8::FunctionCallbackInfo<v8::Value>&
 
 JNIV8ClassInfoContainer::JNIV8ClassInfoContainer(JNIV8ObjectType type, const std::string& canonicalName, JNIV8ObjectInitializer i,
                                            JNIV8ObjectCreator c, size_t s, JNIV8ClassInfoContainer *baseClassInfo) :
-        type(type), canonicalName(canonicalName), initializer(i), creator(c), size(s), baseClassInfo(baseClassInfo) {
+        type(type), canonicalName(canonicalName), initializer(i), creator(c), size(s), baseClassInfo(baseClassInfo),
+        bindingParsed(false), createFromJavaOnly(false) {
     if(baseClassInfo) {
         if (!creator) {
             creator = baseClassInfo->creator;
@@ -332,25 +400,11 @@ JNIV8ClassInfo::~JNIV8ClassInfo() {
     for(auto &it : accessorHolders) {
         delete it;
     }
-    JNIEnv *env = JNIWrapper::getEnvironment();
+    // type information of java methods and accessors is owned by the container, see JNIV8Wrapper::_parseJavaBinding
     for(auto &it : javaAccessorHolders) {
-        env->DeleteGlobalRef(it->javaClass);
-        if(it->propertyType.clazz) {
-            env->DeleteGlobalRef(it->propertyType.clazz);
-        }
         delete it;
     }
     for(auto &it : javaCallbackHolders) {
-        env->DeleteGlobalRef(it->javaClass);
-        for(auto sig : it->signatures) {
-            if(!sig.arguments) continue;
-            for(auto arg : *sig.arguments) {
-                if(arg.clazz) {
-                    env->DeleteGlobalRef(arg.clazz);
-                }
-            }
-            delete sig.arguments;
-        }
         delete it;
     }
 }
@@ -380,15 +434,17 @@ void JNIV8ClassInfo::registerStaticMethod(const std::string& methodName, JNIV8Ob
     _registerMethod(holder);
 }
 
-void JNIV8ClassInfo::registerJavaMethod(const std::string& methodName, jmethodID methodId, const JNIV8JavaValue& returnType, std::vector<JNIV8JavaValue> *arguments) {
+void JNIV8ClassInfo::registerJavaMethod(const std::string& methodName, jmethodID methodId, const JNIV8JavaValue& returnType, std::vector<JNIV8JavaValue> *arguments, bool isAsync) {
     // check if this is an overload for a method that is already registered
     for(auto &it : javaCallbackHolders) {
         if(it->methodName == methodName) {
             // make sure that return types match!
             JNI_ASSERTF(returnType.valueType == it->returnType.valueType && JNIWrapper::getEnvironment()->IsSameObject(returnType.clazz, it->returnType.clazz),
                         "Overload for method '%s' of class '%s' has a different return type", methodName.c_str(), container->canonicalName.c_str());
+            JNI_ASSERTF(isAsync == it->isAsync,
+                        "Overloads of method '%s' of class '%s' must either all be async or not", methodName.c_str(), container->canonicalName.c_str());
             // register overload
-            it->signatures.push_back({methodId, arguments});
+            it->addSignature(methodId, arguments);
             return;
         }
     }
@@ -397,19 +453,22 @@ void JNIV8ClassInfo::registerJavaMethod(const std::string& methodName, jmethodID
     JNIV8ObjectJavaCallbackHolder *holder = new JNIV8ObjectJavaCallbackHolder(returnType);
     holder->methodName = methodName;
     holder->isStatic = false;
-    holder->signatures.push_back({methodId, arguments});
+    holder->isAsync = isAsync;
+    holder->addSignature(methodId, arguments);
     _registerJavaMethod(holder);
 }
 
-void JNIV8ClassInfo::registerStaticJavaMethod(const std::string &methodName, jmethodID methodId, const JNIV8JavaValue& returnType, std::vector<JNIV8JavaValue> *arguments) {
+void JNIV8ClassInfo::registerStaticJavaMethod(const std::string &methodName, jmethodID methodId, const JNIV8JavaValue& returnType, std::vector<JNIV8JavaValue> *arguments, bool isAsync) {
     // check if this is an overload for a method that is already registered
     for(auto &it : javaCallbackHolders) {
         if(it->methodName == methodName) {
             // make sure that return types match!
             JNI_ASSERTF(returnType.valueType == it->returnType.valueType && JNIWrapper::getEnvironment()->IsSameObject(returnType.clazz, it->returnType.clazz),
                         "Overload for method '%s' of class '%s' has a different return type", methodName.c_str(), container->canonicalName.c_str());
+            JNI_ASSERTF(isAsync == it->isAsync,
+                        "Overloads of method '%s' of class '%s' must either all be async or not", methodName.c_str(), container->canonicalName.c_str());
             // register overload
-            it->signatures.push_back({methodId, arguments});
+            it->addSignature(methodId, arguments);
             return;
         }
     }
@@ -418,10 +477,125 @@ void JNIV8ClassInfo::registerStaticJavaMethod(const std::string &methodName, jme
     JNIV8ObjectJavaCallbackHolder *holder = new JNIV8ObjectJavaCallbackHolder(returnType);
     holder->methodName = methodName;
     holder->isStatic = true;
-    holder->signatures.push_back({methodId, arguments});
+    holder->isAsync = isAsync;
+    holder->addSignature(methodId, arguments);
     _registerJavaMethod(holder);
 }
 
+void JNIV8ClassInfo::startAsyncJavaCall(const v8::FunctionCallbackInfo<v8::Value>& args, JNIV8AsyncJavaCall *call) {
+    Isolate *isolate = args.GetIsolate();
+    Local<Context> context = isolate->GetCurrentContext();
+    JNIEnv *env = JNIWrapper::getEnvironment();
+
+    // the call outlives this callback, so all references it holds have to be global
+    if(call->javaObject) {
+        call->javaObject = env->NewGlobalRef(call->javaObject);
+    }
+    for(size_t idx = 0; idx < call->numArguments; idx++) {
+        if(!call->argumentTypes) {
+            // generic methods receive a single Object[]
+            call->arguments[idx].l = env->NewGlobalRef(call->arguments[idx].l);
+            continue;
+        }
+        const JNIV8JavaValue &type = (*call->argumentTypes)[idx];
+        if((type.clazz || type.valueType == JNIV8JavaValueType::kObject || type.valueType == JNIV8JavaValueType::kString) &&
+                call->arguments[idx].l) {
+            call->arguments[idx].l = env->NewGlobalRef(call->arguments[idx].l);
+        }
+    }
+
+    Local<Promise::Resolver> resolver = Promise::Resolver::New(context).ToLocalChecked();
+    call->resolver.Reset(isolate, resolver);
+    args.GetReturnValue().Set(resolver->GetPromise());
+
+    call->engine->startAsyncJavaCall(call);
+
+    // the call could not be handed to an executor; it is still owned by us
+    if(env->ExceptionCheck()) {
+        BGJSV8Engine *engine = call->engine;
+        dropAsyncJavaCall(env, call);
+        engine->forwardJNIExceptionToV8();
+    }
+}
+
+void JNIV8ClassInfo::releaseAsyncJavaCallArguments(JNIEnv *env, JNIV8AsyncJavaCall *call) {
+    for(size_t idx = 0; idx < call->numArguments; idx++) {
+        if(!call->argumentTypes) {
+            env->DeleteGlobalRef(call->arguments[idx].l);
+            continue;
+        }
+        const JNIV8JavaValue &type = (*call->argumentTypes)[idx];
+        if((type.clazz || type.valueType == JNIV8JavaValueType::kObject || type.valueType == JNIV8JavaValueType::kString) &&
+                call->arguments[idx].l) {
+            env->DeleteGlobalRef(call->arguments[idx].l);
+        }
+    }
+    if(call->arguments) {
+        free(call->arguments);
+        call->arguments = nullptr;
+    }
+    call->numArguments = 0;
+    if(call->javaObject) {
+        env->DeleteGlobalRef(call->javaObject);
+        call->javaObject = nullptr;
+    }
+}
+
+void JNIV8ClassInfo::runAsyncJavaCall(JNIEnv *env, JNIV8AsyncJavaCall *call) {
+    jobject result = JNIV8Marshalling::callJavaMethodBoxed(env, call->holder->returnType, call->holder->javaClass,
+                                                           call->javaMethodId, call->javaObject, call->arguments);
+    if(env->ExceptionCheck()) {
+        jthrowable exception = env->ExceptionOccurred();
+        env->ExceptionClear();
+        call->exception = (jthrowable)env->NewGlobalRef(exception);
+        env->DeleteLocalRef(exception);
+    } else if(result) {
+        call->result = env->NewGlobalRef(result);
+        env->DeleteLocalRef(result);
+    }
+
+    // the arguments are not needed anymore; release them here instead of on the engine thread
+    releaseAsyncJavaCallArguments(env, call);
+}
+
+void JNIV8ClassInfo::resolveAsyncJavaCall(JNIV8AsyncJavaCall *call) {
+    Isolate *isolate = Isolate::GetCurrent();
+    HandleScope scope(isolate);
+    Local<Context> context = isolate->GetCurrentContext();
+    JNIEnv *env = JNIWrapper::getEnvironment();
+
+    Local<Promise::Resolver> resolver = Local<Promise::Resolver>::New(isolate, call->resolver);
+
+    if(call->exception) {
+        // reuse the conversion of synchronous calls so that rejections carry the same JavaError
+        TryCatch tryCatch(isolate);
+        env->Throw(call->exception);
+        BGJSV8Engine::GetInstance(isolate)->forwardJNIExceptionToV8();
+        resolver->Reject(context, tryCatch.Exception());
+        env->DeleteGlobalRef(call->exception);
+        call->exception = nullptr;
+    } else if(call->holder->returnType.valueType == JNIV8JavaValueType::kVoid) {
+        resolver->Resolve(context, Undefined(isolate));
+    } else {
+        resolver->Resolve(context, JNIV8Marshalling::jobject2v8value(call->result));
+    }
+
+    call->engine->finishAsyncJavaCall(call);
+    dropAsyncJavaCall(env, call);
+}
+
+void JNIV8ClassInfo::dropAsyncJavaCall(JNIEnv *env, JNIV8AsyncJavaCall *call) {
+    if(call->result) {
+        env->DeleteGlobalRef(call->result);
+    }
+    if(call->exception) {
+        env->DeleteGlobalRef(call->exception);
+    }
+    releaseAsyncJavaCallArguments(env, call);
+    call->resolver.Reset();
+    delete call;
+}
+
 void JNIV8ClassInfo::registerJavaAccessor(const std::string& propertyName, const JNIV8JavaValue& propertyType, jmethodID getterId, jmethodID setterId) {
     JNIV8ObjectJavaAccessorHolder* holder = new JNIV8ObjectJavaAccessorHolder(propertyType);
     holder->propertyName = propertyName;
@@ -471,15 +645,15 @@ void JNIV8ClassInfo::_registerJavaMethod(JNIV8ObjectJavaCallbackHolder *holder)
 
     Local<FunctionTemplate> ft = Local<FunctionTemplate>::New(isolate, functionTemplate);
 
-    JNIEnv *env = JNIWrapper::getEnvironment();
-    holder->javaClass = (jclass)env->NewGlobalRef(env->FindClass(container->canonicalName.c_str()));;
+    // the class reference is owned by the container and outlives all class infos
+    holder->javaClass = container->clsObject;
     javaCallbackHolders.push_back(holder);
 
     Local<External> data = External::New(isolate, (void*)holder);
 
     if(holder->isStatic) {
-        Local<Function> f = ft->GetFunction();
-        f->Set(String::NewFromUtf8(isolate, holder->methodName.c_str()), FunctionTemplate::New(isolate, v8JavaMethodCallback, data, Local<Signature>(), 0, ConstructorBehavior::kThrow)->GetFunction());
+        // static members are stored on the template so that they exist in every context using it
+        ft->Set(String::NewFromUtf8(isolate, holder->methodName.c_str()), FunctionTemplate::New(isolate, v8JavaMethodCallback, data, Local<Signature>(), 0, ConstructorBehavior::kThrow));
     } else {
         // ofc functions belong on the prototype, and not on the actual instance for performance/memory reasons
         // but interestingly enough, we MUST store them there because they simply are not "copied" from the InstanceTemplate when using inherit later
@@ -499,8 +673,8 @@ void JNIV8ClassInfo::_registerJavaAccessor(JNIV8ObjectJavaAccessorHolder *holder
 
     Local<FunctionTemplate> ft = Local<FunctionTemplate>::New(isolate, functionTemplate);
 
-    JNIEnv *env = JNIWrapper::getEnvironment();
-    holder->javaClass = (jclass)env->NewGlobalRef(env->FindClass(container->canonicalName.c_str()));
+    // the class reference is owned by the container and outlives all class infos
+    holder->javaClass = container->clsObject;
     javaAccessorHolders.push_back(holder);
 
     Local<External> data = External::New(isolate, (void*)holder);
@@ -514,10 +688,9 @@ void JNIV8ClassInfo::_registerJavaAccessor(JNIV8ObjectJavaAccessorHolder *holder
     }
 
     if(holder->isStatic) {
-        Local<Function> f = ft->GetFunction();
-        f->SetAccessor(String::NewFromUtf8(isolate, holder->propertyName.c_str()),
-                       v8JavaAccessorGetterCallback, finalSetter,
-                       data, DEFAULT, settings);
+        ft->SetNativeDataProperty(String::NewFromUtf8(isolate, holder->propertyName.c_str()),
+                                  v8JavaAccessorGetterCallback, finalSetter,
+                                  data, settings);
     } else {
         Local<ObjectTemplate> instanceTpl = ft->InstanceTemplate();
         instanceTpl->SetAccessor(String::NewFromUtf8(isolate, holder->propertyName.c_str()),
@@ -536,9 +709,8 @@ void JNIV8ClassInfo::_registerMethod(JNIV8ObjectCallbackHolder *holder) {
     Local<External> data = External::New(isolate, (void*)holder);
 
     if(holder->isStatic) {
-        Local<Function> f = ft->GetFunction();
-        f->Set(String::NewFromUtf8(isolate, holder->methodName.c_str()),
-               FunctionTemplate::New(isolate, v8MethodCallback, data, Local<Signature>(), 0, ConstructorBehavior::kThrow)->GetFunction());
+        ft->Set(String::NewFromUtf8(isolate, holder->methodName.c_str()),
+                FunctionTemplate::New(isolate, v8MethodCallback, data, Local<Signature>(), 0, ConstructorBehavior::kThrow));
     } else {
         // ofc functions belong on the prototype, and not on the actual instance for performance/memory reasons
         // but interestingly enough, we MUST store them there because they simply are not "copied" from the InstanceTemplate when using inherit later
@@ -569,10 +741,9 @@ void JNIV8ClassInfo::_registerAccessor(JNIV8ObjectAccessorHolder *holder) {
     }
 
     if(holder->isStatic) {
-        Local<Function> f = ft->GetFunction();
-        f->SetAccessor(String::NewFromUtf8(isolate, holder->propertyName.c_str()),
-                       v8AccessorGetterCallback, finalSetter,
-                       data, DEFAULT, settings);
+        ft->SetNativeDataProperty(String::NewFromUtf8(isolate, holder->propertyName.c_str()),
+                                  v8AccessorGetterCallback, finalSetter,
+                                  data, settings);
     } else {
         Local<ObjectTemplate> instanceTpl = ft->InstanceTemplate();
         instanceTpl->SetAccessor(String::NewFromUtf8(isolate, holder->propertyName.c_str()),
@@ -584,14 +755,14 @@ void JNIV8ClassInfo::_registerAccessor(JNIV8ObjectAccessorHolder *holder) {
 v8::Local<v8::Object> JNIV8ClassInfo::newInstance() const {
     assert(container->type == JNIV8ObjectType::kPersistent);
 
+    // instances are created in the current context, which might belong to any engine sharing this isolate
     Isolate* isolate = engine->getIsolate();
     Isolate::Scope scope(isolate);
     EscapableHandleScope handleScope(isolate);
-    Context::Scope ctxScope(engine->getContext());
 
     Local<FunctionTemplate> ft = Local<FunctionTemplate>::New(isolate, functionTemplate);
 
-    return handleScope.Escape(ft->InstanceTemplate()->NewInstance());
+    return handleScope.Escape(ft->InstanceTemplate()->NewInstance(isolate->GetCurrentContext()).ToLocalChecked());
 }
 
 v8::Local<v8::Function> JNIV8ClassInfo::getConstructor() const {
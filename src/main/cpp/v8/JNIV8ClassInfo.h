@@ -44,10 +44,45 @@ struct JNIV8ObjectJavaCallbackHolder {
     std::string methodName;
     JNIV8JavaValue returnType;
     std::vector<JNIV8ObjectJavaSignatureInfo> signatures;
+    // index into signatures for each number of arguments; -1 if there is no overload taking that many arguments
+    std::vector<int> signaturesByArity;
+    // index of the first overload receiving all arguments as an Object[]; -1 if there is none
+    int genericSignature;
     jclass javaClass;
     bool isStatic;
+    bool isAsync;
 
-    JNIV8ObjectJavaCallbackHolder(JNIV8JavaValue returnType) : returnType(returnType) {};
+    JNIV8ObjectJavaCallbackHolder(JNIV8JavaValue returnType) : returnType(returnType), genericSignature(-1), isAsync(false) {};
+
+    /**
+     * registers an overload and updates the dispatch table
+     */
+    void addSignature(jmethodID methodId, std::vector<JNIV8JavaValue> *arguments);
+
+    /**
+     * returns the overload to invoke for the specified number of arguments, or null if there is none
+     * overloads with a matching number of arguments take precedence over generic ones
+     */
+    JNIV8ObjectJavaSignatureInfo* getSignature(int numArguments);
+};
+
+/**
+ * internal struct for a call of an async java method that is in flight
+ * created on the engine thread, invoked on an executor and resolved back on the engine thread
+ */
+struct JNIV8AsyncJavaCall {
+    // the engine the call is registered with, see BGJSV8Engine::startAsyncJavaCall
+    BGJSV8Engine *engine;
+    JNIV8ObjectJavaCallbackHolder *holder;
+    jmethodID javaMethodId;
+    jobject javaObject;
+    jvalue *arguments;
+    size_t numArguments;
+    // types of the arguments; null for methods receiving all arguments as an Object[]
+    std::vector<JNIV8JavaValue> *argumentTypes;
+    v8::Persistent<v8::Promise::Resolver> resolver;
+    jobject result;
+    jthrowable exception;
 };
 
 /**
@@ -78,6 +113,30 @@ struct JNIV8ObjectCallbackHolder {
     std::string methodName;
 };
 
+/**
+ * internal struct for a java method exposed by the V8Binding class generated for a java class
+ * bindings are parsed once and shared by the class infos of all engines
+ */
+struct JNIV8JavaMethodBinding {
+    std::string propertyName;
+    jmethodID methodId;
+    JNIV8JavaValue returnType;
+    std::vector<JNIV8JavaValue> *arguments;
+    bool isStatic;
+    bool isAsync;
+};
+
+/**
+ * internal struct for a java accessor exposed by the V8Binding class generated for a java class
+ */
+struct JNIV8JavaAccessorBinding {
+    std::string propertyName;
+    JNIV8JavaValue propertyType;
+    jmethodID getterId;
+    jmethodID setterId;
+    bool isStatic;
+};
+
 enum class JNIV8ObjectType {
     /**
      * Java + native + v8 class are permanently linked together
@@ -92,7 +151,8 @@ enum class JNIV8ObjectType {
     /**
      * Tuple of Java+native class acts as a wrapper for an existing v8 object
      * this can be used to write utility methods for working with existing JavaScript classes, e.g. you could wrap Object, or Array
-     * wrapping the same javascript object will always yield a new instance of a Java + native tuple!
+     * wrapping the same javascript object yields the same Java + native tuple as long as it is alive;
+     * once it was collected from java, wrapping the object again creates a new one
      */
     kWrapper
 };
@@ -106,6 +166,10 @@ struct JNIV8ClassInfo {
     friend class JNIV8Object;
     friend class JNIV8Wrapper;
 public:
+    /**
+     * returns the engine owning the isolate this class info was created for
+     * class infos are shared by all engines running on the same isolate
+     */
     BGJSV8Engine* getEngine() const {
         return engine;
     };
@@ -135,12 +199,29 @@ public:
      * cache JNI class references
      */
     static void initJNICache();
+
+    /**
+     * invokes the java method of an async call; called on the executor thread, does not require an isolate
+     */
+    static void runAsyncJavaCall(JNIEnv *env, JNIV8AsyncJavaCall *call);
+
+    /**
+     * resolves or rejects the promise of an async call and releases it
+     * called on the engine thread, the isolate and context scopes have to be set up by the caller
+     */
+    static void resolveAsyncJavaCall(JNIV8AsyncJavaCall *call);
+
+    /**
+     * releases an async call without settling its promise; used for calls that finish after their engine shut down
+     * the call has to be unregistered from its engine already, and the isolate has to be locked by the caller
+     */
+    static void dropAsyncJavaCall(JNIEnv *env, JNIV8AsyncJavaCall *call);
 private:
     JNIV8ClassInfo(JNIV8ClassInfoContainer *container, BGJSV8Engine *engine);
     ~JNIV8ClassInfo();
 
-    void registerJavaMethod(const std::string& methodName, jmethodID methodId, const JNIV8JavaValue& returnType, std::vector<JNIV8JavaValue> *arguments);
-    void registerStaticJavaMethod(const std::string& methodName, jmethodID methodId, const JNIV8JavaValue& returnType, std::vector<JNIV8JavaValue> *arguments);
+    void registerJavaMethod(const std::string& methodName, jmethodID methodId, const JNIV8JavaValue& returnType, std::vector<JNIV8JavaValue> *arguments, bool isAsync = false);
+    void registerStaticJavaMethod(const std::string& methodName, jmethodID methodId, const JNIV8JavaValue& returnType, std::vector<JNIV8JavaValue> *arguments, bool isAsync = false);
     void registerJavaAccessor(const std::string& propertyName, const JNIV8JavaValue& propertyType, jmethodID getterId, jmethodID setterId);
     void registerStaticJavaAccessor(const std::string& propertyName, const JNIV8JavaValue& propertyType, jmethodID getterId, jmethodID setterId);
 
@@ -167,6 +248,8 @@ private:
     static void v8JavaAccessorGetterCallback(v8::Local<v8::String> property, const v8::PropertyCallbackInfo<v8::Value> &info);
     static void v8JavaAccessorSetterCallback(v8::Local<v8::String> property, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void> &info);
     static void v8JavaMethodCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void startAsyncJavaCall(const v8::FunctionCallbackInfo<v8::Value>& args, JNIV8AsyncJavaCall *call);
+    static void releaseAsyncJavaCallArguments(JNIEnv *env, JNIV8AsyncJavaCall *call);
     static void v8AccessorGetterCallback(v8::Local<v8::String> property, const v8::PropertyCallbackInfo<v8::Value> &info);
     static void v8AccessorSetterCallback(v8::Local<v8::String> property, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void> &info);
     static void v8MethodCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -175,7 +258,7 @@ private:
 
 // internal helper methods for creating and initializing objects
 typedef void(*JNIV8ObjectInitializer)(JNIV8ClassInfo *info);
-typedef JNILocalRef<JNIV8Object>(*JNIV8ObjectCreator)(JNIV8ClassInfo *info, v8::Persistent<v8::Object> *jsObj, jobjectArray arguments);
+typedef JNILocalRef<JNIV8Object>(*JNIV8ObjectCreator)(JNIV8ClassInfo *info, BGJSV8Engine *engine, v8::Persistent<v8::Object> *jsObj, jobjectArray arguments);
 
 /**
  * internal container object for managing all class info instances (one for each v8 engine) of an object
@@ -196,6 +279,12 @@ private:
     std::vector<JNIV8ClassInfo*> classInfos;
 
     jclass clsObject, clsBinding;
+
+    // contents of the V8Binding class; resolved when the class is first materialized for any engine
+    bool bindingParsed;
+    bool createFromJavaOnly;
+    std::vector<JNIV8JavaMethodBinding> javaMethods;
+    std::vector<JNIV8JavaAccessorBinding> javaAccessors;
 };
 
 #endif //TRADINGLIB_SAMPLE_V8CLASSINFO_H
@@ -3,21 +3,40 @@
 //
 
 #include "JNIV8Function.h"
+#include "../jni/JNIHandleTable.h"
 
 #include <stdlib.h>
 
 BGJS_JNI_LINK(JNIV8Function, "ag/boersego/bgjs/JNIV8Function");
 
+/**
+ * the kind of handler a wrapped java function calls; detected once when the function is created
+ */
+enum class JNIV8FunctionHandlerType {
+    kGeneric,       // Handler: (Object, Object[]) -> Object
+    kUnaryDouble,   // UnaryDoubleHandler: (double) -> double
+    kBinaryDouble,  // BinaryDoubleHandler: (double, double) -> double
+    kInt,           // IntHandler: (int) -> void
+    kString         // StringHandler: (String) -> Object
+};
+
 /**
  * internal struct for storing information for wrapped java functions
  */
 struct JNIV8FunctionCallbackHolder {
     v8::Persistent<v8::Function> persistent;
-    jobject jFuncRef;
+    JNIStrongRef jFuncRef;
     jmethodID callbackMethodId;
+    JNIV8FunctionHandlerType type;
+    BGJSFinalizationQueue *finalizationQueue;
 };
 
 decltype(JNIV8Function::_jniObject) JNIV8Function::_jniObject = {0};
+decltype(JNIV8Function::_jniHandler) JNIV8Function::_jniHandler = {0};
+decltype(JNIV8Function::_jniUnaryDoubleHandler) JNIV8Function::_jniUnaryDoubleHandler = {0};
+decltype(JNIV8Function::_jniBinaryDoubleHandler) JNIV8Function::_jniBinaryDoubleHandler = {0};
+decltype(JNIV8Function::_jniIntHandler) JNIV8Function::_jniIntHandler = {0};
+decltype(JNIV8Function::_jniStringHandler) JNIV8Function::_jniStringHandler = {0};
 
 /**
  * cache JNI class references
@@ -25,13 +44,28 @@ decltype(JNIV8Function::_jniObject) JNIV8Function::_jniObject = {0};
 void JNIV8Function::initJNICache() {
     JNIEnv *env = JNIWrapper::getEnvironment();
     _jniObject.clazz = (jclass)env->NewGlobalRef(env->FindClass("java/lang/Object"));
+
+    _jniHandler.clazz = (jclass)env->NewGlobalRef(env->FindClass("ag/boersego/bgjs/JNIV8Function$Handler"));
+    _jniHandler.callbackId = env->GetMethodID(_jniHandler.clazz, "Callback", "(Ljava/lang/Object;[Ljava/lang/Object;)Ljava/lang/Object;");
+
+    _jniUnaryDoubleHandler.clazz = (jclass)env->NewGlobalRef(env->FindClass("ag/boersego/bgjs/JNIV8Function$UnaryDoubleHandler"));
+    _jniUnaryDoubleHandler.callbackId = env->GetMethodID(_jniUnaryDoubleHandler.clazz, "Callback", "(D)D");
+
+    _jniBinaryDoubleHandler.clazz = (jclass)env->NewGlobalRef(env->FindClass("ag/boersego/bgjs/JNIV8Function$BinaryDoubleHandler"));
+    _jniBinaryDoubleHandler.callbackId = env->GetMethodID(_jniBinaryDoubleHandler.clazz, "Callback", "(DD)D");
+
+    _jniIntHandler.clazz = (jclass)env->NewGlobalRef(env->FindClass("ag/boersego/bgjs/JNIV8Function$IntHandler"));
+    _jniIntHandler.callbackId = env->GetMethodID(_jniIntHandler.clazz, "Callback", "(I)V");
+
+    _jniStringHandler.clazz = (jclass)env->NewGlobalRef(env->FindClass("ag/boersego/bgjs/JNIV8Function$StringHandler"));
+    _jniStringHandler.callbackId = env->GetMethodID(_jniStringHandler.clazz, "Callback", "(Ljava/lang/String;)Ljava/lang/Object;");
 }
 
 void JNIV8FunctionWeakPersistentCallback(const v8::WeakCallbackInfo<void>& data) {
-    JNIEnv *env = JNIWrapper::getEnvironment();
-
     JNIV8FunctionCallbackHolder *holder = reinterpret_cast<JNIV8FunctionCallbackHolder*>(data.GetParameter());
-    env->DeleteGlobalRef(holder->jFuncRef);
+
+    // the handler is released with the next batch instead of in the middle of the gc
+    holder->finalizationQueue->enqueueStrongRef(holder->jFuncRef);
 
     holder->persistent.Reset();
     delete holder;
@@ -50,6 +84,73 @@ void JNIV8Function::v8FunctionCallback(const v8::FunctionCallbackInfo<v8::Value>
     JNIEnv *env = JNIWrapper::getEnvironment();
 
     JNIV8FunctionCallbackHolder *holder = static_cast<JNIV8FunctionCallbackHolder*>(ext->Value());
+    JNIStrongRefScope handler(env, holder->jFuncRef);
+
+    // typed handlers: arguments are coerced like javascript would do it, missing arguments are undefined
+    // the first argument is always the external, so the arguments of the actual call start at index 1
+    // if the coercion throws (valueOf, toString), the exception is already scheduled and java is not called
+    v8::Local<v8::Context> context = args.GetIsolate()->GetCurrentContext();
+    switch(holder->type) {
+        case JNIV8FunctionHandlerType::kUnaryDouble: {
+            double arg0;
+            if(!args[1]->NumberValue(context).To(&arg0)) {
+                return;
+            }
+            jdouble result = env->CallDoubleMethod(handler.get(), holder->callbackMethodId, (jdouble)arg0);
+            if(env->ExceptionCheck()) {
+                BGJSV8Engine::GetInstance(args.GetIsolate())->forwardJNIExceptionToV8();
+                return;
+            }
+            args.GetReturnValue().Set(result);
+            return;
+        }
+        case JNIV8FunctionHandlerType::kBinaryDouble: {
+            double arg0, arg1;
+            if(!args[1]->NumberValue(context).To(&arg0) || !args[2]->NumberValue(context).To(&arg1)) {
+                return;
+            }
+            jdouble result = env->CallDoubleMethod(handler.get(), holder->callbackMethodId, (jdouble)arg0, (jdouble)arg1);
+            if(env->ExceptionCheck()) {
+                BGJSV8Engine::GetInstance(args.GetIsolate())->forwardJNIExceptionToV8();
+                return;
+            }
+            args.GetReturnValue().Set(result);
+            return;
+        }
+        case JNIV8FunctionHandlerType::kInt: {
+            int32_t arg0;
+            if(!args[1]->Int32Value(context).To(&arg0)) {
+                return;
+            }
+            env->CallVoidMethod(handler.get(), holder->callbackMethodId, (jint)arg0);
+            if(env->ExceptionCheck()) {
+                BGJSV8Engine::GetInstance(args.GetIsolate())->forwardJNIExceptionToV8();
+            }
+            return;
+        }
+        case JNIV8FunctionHandlerType::kString: {
+            // null and undefined are passed as null instead of their string representation
+            jstring string = nullptr;
+            if(!args[1]->IsNullOrUndefined()) {
+                v8::Local<v8::String> stringRef;
+                if(!args[1]->ToString(context).ToLocal(&stringRef)) {
+                    return;
+                }
+                string = JNIV8Marshalling::v8string2jstring(stringRef);
+            }
+            jobject result = env->CallObjectMethod(handler.get(), holder->callbackMethodId, string);
+            env->DeleteLocalRef(string);
+            if(env->ExceptionCheck()) {
+                BGJSV8Engine::GetInstance(args.GetIsolate())->forwardJNIExceptionToV8();
+                return;
+            }
+            args.GetReturnValue().Set(JNIV8Marshalling::jobject2v8value(result));
+            env->DeleteLocalRef(result);
+            return;
+        }
+        case JNIV8FunctionHandlerType::kGeneric:
+            break;
+    }
 
     jobject receiver = JNIV8Marshalling::v8value2jobject(args.This());
     jobjectArray arguments = nullptr;
@@ -61,7 +162,7 @@ void JNIV8Function::v8FunctionCallback(const v8::FunctionCallbackInfo<v8::Value>
         env->SetObjectArrayElement(arguments, i - 1, value);
     }
 
-    jobject result = env->CallObjectMethod(holder->jFuncRef, holder->callbackMethodId, receiver, arguments);
+    jobject result = env->CallObjectMethod(handler.get(), holder->callbackMethodId, receiver, arguments);
 
     if(env->ExceptionCheck()) {
         BGJSV8Engine::GetInstance(args.GetIsolate())->forwardJNIExceptionToV8();
@@ -73,6 +174,7 @@ void JNIV8Function::v8FunctionCallback(const v8::FunctionCallbackInfo<v8::Value>
 
 void JNIV8Function::initializeJNIBindings(JNIClassInfo *info, bool isReload) {
     info->registerNativeMethod("Create", "(Lag/boersego/bgjs/V8Engine;Lag/boersego/bgjs/JNIV8Function$Handler;)Lag/boersego/bgjs/JNIV8Function;", (void*)JNIV8Function::jniCreate);
+    info->registerNativeMethod("_createTyped", "(Lag/boersego/bgjs/V8Engine;Ljava/lang/Object;)Lag/boersego/bgjs/JNIV8Function;", (void*)JNIV8Function::jniCreate);
     info->registerNativeMethod("_callAsV8Function", "(ZIILjava/lang/Class;Ljava/lang/Object;[Ljava/lang/Object;)Ljava/lang/Object;", (void*)JNIV8Function::jniCallAsV8Function);
 }
 
@@ -235,13 +337,30 @@ jobject JNIV8Function::jniCreate(JNIEnv *env, jobject obj, jobject engineObj, jo
 
     // java reference is stored in the functions data parameter to be retrieved when called
     JNIV8FunctionCallbackHolder *holder = new JNIV8FunctionCallbackHolder();
-    holder->jFuncRef = env->NewGlobalRef(handler);
-    holder->callbackMethodId = env->GetMethodID(env->GetObjectClass(handler), "Callback", "(Ljava/lang/Object;[Ljava/lang/Object;)Ljava/lang/Object;");
+    holder->jFuncRef.set(env, handler);
+    holder->finalizationQueue = engine->getFinalizationQueue();
+    if(env->IsInstanceOf(handler, _jniUnaryDoubleHandler.clazz)) {
+        holder->type = JNIV8FunctionHandlerType::kUnaryDouble;
+        holder->callbackMethodId = _jniUnaryDoubleHandler.callbackId;
+    } else if(env->IsInstanceOf(handler, _jniBinaryDoubleHandler.clazz)) {
+        holder->type = JNIV8FunctionHandlerType::kBinaryDouble;
+        holder->callbackMethodId = _jniBinaryDoubleHandler.callbackId;
+    } else if(env->IsInstanceOf(handler, _jniIntHandler.clazz)) {
+        holder->type = JNIV8FunctionHandlerType::kInt;
+        holder->callbackMethodId = _jniIntHandler.callbackId;
+    } else if(env->IsInstanceOf(handler, _jniStringHandler.clazz)) {
+        holder->type = JNIV8FunctionHandlerType::kString;
+        holder->callbackMethodId = _jniStringHandler.callbackId;
+    } else {
+        holder->type = JNIV8FunctionHandlerType::kGeneric;
+        holder->callbackMethodId = _jniHandler.callbackId;
+    }
 
     v8::Local<v8::External> data = v8::External::New(isolate, (void*)holder);
 
     maybeFuncRef = getJNIV8FunctionBaseFunction();
     if (!maybeFuncRef.ToLocal(&funcRef)) {
+        holder->jFuncRef.reset(env);
         delete holder;
         env->ThrowNew(env->FindClass("java/lang/RuntimeException"), "Failed to retrieve JNIV8Function wrapper function");
         return nullptr;
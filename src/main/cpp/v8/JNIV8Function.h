@@ -25,6 +25,11 @@ private:
     static struct {
         jclass clazz;
     } _jniObject;
+    // handler interfaces; typed handlers receive and return primitives instead of boxed values in an Object[]
+    static struct {
+        jclass clazz;
+        jmethodID callbackId;
+    } _jniHandler, _jniUnaryDoubleHandler, _jniBinaryDoubleHandler, _jniIntHandler, _jniStringHandler;
     static v8::MaybeLocal<v8::Function> getJNIV8FunctionBaseFunction();
     static void v8FunctionCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
 };
@@ -3,13 +3,18 @@
 //
 
 #include "JNIV8Marshalling.h"
+#include <algorithm>
 #include <cmath>
+#include <memory>
+#include <string.h>
 
 #include "../jni/JNIWrapper.h"
+#include "../jni/JNIStringCoding.h"
 #include "JNIV8Wrapper.h"
 
 #include "JNIV8Function.h"
 #include "JNIV8Array.h"
+#include "JNIV8ArrayBuffer.h"
 #include "JNIV8GenericObject.h"
 
 JNIV8JavaValueType getArgumentType(const std::string& type) {
@@ -157,6 +162,11 @@ decltype(JNIV8Marshalling::_jniString) JNIV8Marshalling::_jniString = {0};
 decltype(JNIV8Marshalling::_jniVoid) JNIV8Marshalling::_jniVoid = {0};
 jobject JNIV8Marshalling::_undefined = nullptr;
 std::unordered_map<int, JNIV8JavaValueType> JNIV8Marshalling::_typeMap;
+JNIV8Marshalling::ClassCacheEntry JNIV8Marshalling::_classCache[JNIV8Marshalling::kClassCacheSize];
+decltype(JNIV8Marshalling::_finalClasses) JNIV8Marshalling::_finalClasses = {};
+std::atomic<int> JNIV8Marshalling::_lastClassMatch(0);
+std::mutex JNIV8Marshalling::_classCacheMutex;
+jmethodID JNIV8Marshalling::_hashCodeId = nullptr;
 
 /**
  * cache JNI class references
@@ -166,6 +176,7 @@ void JNIV8Marshalling::initJNICache() {
 
     _jniObject.clazz = (jclass)env->NewGlobalRef(env->FindClass("java/lang/Object"));
     jmethodID hashCodeId = env->GetMethodID(_jniObject.clazz, "hashCode", "()I");
+    _hashCodeId = hashCodeId;
 
     // all classes that support auto-boxing; we need the jclass and the valueOf method for boxing
     InitBoxedType(Boolean, Z);
@@ -191,6 +202,20 @@ void JNIV8Marshalling::initJNICache() {
     _typeMap[env->CallIntMethod(_jniString.clazz, hashCodeId)] = JNIV8JavaValueType::kString;
     _jniVoid.clazz = (jclass)env->NewGlobalRef(env->FindClass("java/lang/Void"));
     _typeMap[env->CallIntMethod(_jniVoid.clazz, hashCodeId)] = JNIV8JavaValueType::kVoid;
+
+    // ordered by how common they are
+    const FinalClassEntry finalClasses[kFinalClassCount] = {
+        { _jniString.clazz, JNIV8JavaObjectKind::kString },
+        { _jniDouble.clazz, JNIV8JavaObjectKind::kNumber },
+        { _jniInteger.clazz, JNIV8JavaObjectKind::kNumber },
+        { _jniBoolean.clazz, JNIV8JavaObjectKind::kBoolean },
+        { _jniLong.clazz, JNIV8JavaObjectKind::kNumber },
+        { _jniFloat.clazz, JNIV8JavaObjectKind::kNumber },
+        { _jniShort.clazz, JNIV8JavaObjectKind::kNumber },
+        { _jniByte.clazz, JNIV8JavaObjectKind::kNumber },
+        { _jniCharacter.clazz, JNIV8JavaObjectKind::kCharacter }
+    };
+    std::copy(finalClasses, finalClasses + kFinalClassCount, _finalClasses);
 }
 
 /**
@@ -410,6 +435,66 @@ v8::Local<v8::Value> JNIV8Marshalling::callJavaMethod(JNIEnv *env, JNIV8JavaValu
     return handleScope.Escape(result);
 }
 
+// the result is only boxed if the method did not throw; no other JNI calls are allowed while an exception is pending
+#define CallBoxedJavaMethod(cls, type) {\
+auto value = object ? env->Call##type##MethodA(object, methodId, args) :\
+             env->CallStatic##type##MethodA(clazz, methodId, args);\
+if (!env->ExceptionCheck()) {\
+result = env->CallStaticObjectMethod(_jni##cls.clazz, _jni##cls.valueOfId, value);\
+}\
+}
+
+jobject JNIV8Marshalling::callJavaMethodBoxed(JNIEnv *env, JNIV8JavaValue returnType, jclass clazz, jmethodID methodId, jobject object, jvalue *args) {
+    jobject result = nullptr;
+
+    // boxed return types are returned as they are
+    JNIV8JavaValueType valueType = returnType.valueType;
+    if (returnType.clazz) {
+        valueType = JNIV8JavaValueType::kObject;
+    }
+
+    switch(valueType) {
+        case JNIV8JavaValueType::kString:
+        case JNIV8JavaValueType::kObject:
+            result = object ? env->CallObjectMethodA(object, methodId, args) :
+                     env->CallStaticObjectMethodA(clazz, methodId, args);
+            break;
+        case JNIV8JavaValueType::kBoolean:
+            CallBoxedJavaMethod(Boolean, Boolean);
+            break;
+        case JNIV8JavaValueType::kByte:
+            CallBoxedJavaMethod(Byte, Byte);
+            break;
+        case JNIV8JavaValueType::kCharacter:
+            CallBoxedJavaMethod(Character, Char);
+            break;
+        case JNIV8JavaValueType::kShort:
+            CallBoxedJavaMethod(Short, Short);
+            break;
+        case JNIV8JavaValueType::kInteger:
+            CallBoxedJavaMethod(Integer, Int);
+            break;
+        case JNIV8JavaValueType::kLong:
+            CallBoxedJavaMethod(Long, Long);
+            break;
+        case JNIV8JavaValueType::kFloat:
+            CallBoxedJavaMethod(Float, Float);
+            break;
+        case JNIV8JavaValueType::kDouble:
+            CallBoxedJavaMethod(Double, Double);
+            break;
+        case JNIV8JavaValueType::kVoid:
+            if (object) {
+                env->CallVoidMethodA(object, methodId, args);
+            } else {
+                env->CallStaticVoidMethodA(clazz, methodId, args);
+            }
+            break;
+    }
+
+    return result;
+}
+
 
 /**
  * convert a jstring to a std::string
@@ -432,9 +517,33 @@ v8::Local<v8::String> JNIV8Marshalling::jstring2v8string(jstring string) {
     len = env->GetStringLength(string);
 
     if(len > 0) {
-        const jchar *chars = env->GetStringChars(string, nullptr);
-        maybeLocal = v8::String::NewFromTwoByte(isolate, chars, v8::NewStringType::kNormal, len);
-        env->ReleaseStringChars(string, chars);
+        // latin-1 content is stored as a one byte string, which takes half the memory and is faster to work with in v8
+        if((size_t)len <= JNIStringCoding::kStackBufferLength) {
+            jchar chars[JNIStringCoding::kStackBufferLength];
+            env->GetStringRegion(string, 0, len, chars);
+            if(JNIStringCoding::isLatin1(chars, (size_t)len)) {
+                uint8_t bytes[JNIStringCoding::kStackBufferLength];
+                JNIStringCoding::narrow(chars, (size_t)len, bytes);
+                maybeLocal = v8::String::NewFromOneByte(isolate, bytes, v8::NewStringType::kNormal, len);
+            } else {
+                maybeLocal = v8::String::NewFromTwoByte(isolate, chars, v8::NewStringType::kNormal, len);
+            }
+        } else {
+            // the chars are copied out before creating the string: v8 allocations can trigger gc callbacks
+            // that call into java, which is not allowed inside of a critical region
+            const jchar *chars = env->GetStringCritical(string, nullptr);
+            if(JNIStringCoding::isLatin1(chars, (size_t)len)) {
+                std::unique_ptr<uint8_t[]> bytes(new uint8_t[len]);
+                JNIStringCoding::narrow(chars, (size_t)len, bytes.get());
+                env->ReleaseStringCritical(string, chars);
+                maybeLocal = v8::String::NewFromOneByte(isolate, bytes.get(), v8::NewStringType::kNormal, len);
+            } else {
+                std::unique_ptr<jchar[]> copy(new jchar[len]);
+                memcpy(copy.get(), chars, len * sizeof(jchar));
+                env->ReleaseStringCritical(string, chars);
+                maybeLocal = v8::String::NewFromTwoByte(isolate, copy.get(), v8::NewStringType::kNormal, len);
+            }
+        }
     }
 
     // if string is empty or if conversion failed we return an empty string
@@ -453,8 +562,15 @@ v8::Local<v8::String> JNIV8Marshalling::jstring2v8string(jstring string) {
  */
 jstring JNIV8Marshalling::v8string2jstring(v8::Local<v8::String> string) {
     JNIEnv *env = JNIWrapper::getEnvironment();
-    return env->NewString(*v8::String::Value(string), string->Length()); // returns "" when called with NULL,0
-
+    const int length = string->Length();
+    if(length <= (int)JNIStringCoding::kStackBufferLength) {
+        jchar chars[JNIStringCoding::kStackBufferLength];
+        string->Write(chars, 0, length, v8::String::NO_NULL_TERMINATION);
+        return env->NewString(chars, length); // returns "" when called with 0
+    }
+    std::unique_ptr<jchar[]> chars(new jchar[length]);
+    string->Write(chars.get(), 0, length, v8::String::NO_NULL_TERMINATION);
+    return env->NewString(chars.get(), length);
 }
 
 /**
@@ -468,8 +584,11 @@ jobject JNIV8Marshalling::v8value2jobject(v8::Local<v8::Value> valueRef) {
     } else if(valueRef->IsObject()) {
         if (valueRef->IsFunction()) {
             return JNIV8Wrapper::wrapObject<JNIV8Function>(valueRef->ToObject())->getJObject();
-        } else if (valueRef->IsArray()) {
+        } else if (valueRef->IsArray() || (valueRef->IsTypedArray() && JNIV8Array::isTypedArrayWrappingEnabled())) {
+            // typed arrays are only exposed as arrays on request, existing code expects them to be generic objects
             return JNIV8Wrapper::wrapObject<JNIV8Array>(valueRef->ToObject())->getJObject();
+        } else if (valueRef->IsArrayBuffer()) {
+            return JNIV8Wrapper::wrapObject<JNIV8ArrayBuffer>(valueRef->ToObject())->getJObject();
         }
         auto ptr = JNIV8Wrapper::wrapObject<JNIV8Object>(valueRef->ToObject());
         if (ptr) {
@@ -508,23 +627,40 @@ v8::Local<v8::Value> JNIV8Marshalling::jobject2v8value(jobject object) {
 
     // jobject referencing "null" can actually be non-null..
     if(env->IsSameObject(object, NULL) || !object) {
-        resultRef = v8::Null(isolate);
-    } else if(env->IsInstanceOf(object, _jniString.clazz)) {
-        resultRef = JNIV8Marshalling::jstring2v8string((jstring)object);
-    } else if(env->IsInstanceOf(object, _jniCharacter.clazz)) {
-        jchar c = env->CallCharMethod(object, _jniCharacter.charValueId);
-        v8::MaybeLocal<v8::String> maybeLocal = v8::String::NewFromTwoByte(isolate, &c, v8::NewStringType::kNormal, 1);
-        if(!maybeLocal.IsEmpty()) {
-            resultRef = maybeLocal.ToLocalChecked();
-        }
-    } else if(env->IsInstanceOf(object, _jniNumber.clazz)) {
-        jdouble n = env->CallDoubleMethod(object, _jniNumber.doubleValueId);
-        resultRef = v8::Number::New(isolate, n);
-    } else if(env->IsInstanceOf(object, _jniBoolean.clazz)) {
-        jboolean b = env->CallBooleanMethod(object, _jniBoolean.booleanValueId);
-        resultRef = v8::Boolean::New(isolate, b);
-    } else if(env->IsInstanceOf(object, _jniV8Object.clazz)) {
-        resultRef = JNIV8Wrapper::wrapObject<JNIV8Object>(object)->getJSObject();
+        return scope.Escape(v8::Null(isolate));
+    }
+
+    switch(getObjectKind(env, object)) {
+        case JNIV8JavaObjectKind::kString:
+            resultRef = JNIV8Marshalling::jstring2v8string((jstring)object);
+            break;
+        case JNIV8JavaObjectKind::kCharacter: {
+            jchar c = env->CallCharMethod(object, _jniCharacter.charValueId);
+            v8::MaybeLocal<v8::String> maybeLocal = v8::String::NewFromTwoByte(isolate, &c, v8::NewStringType::kNormal, 1);
+            if(!maybeLocal.IsEmpty()) {
+                resultRef = maybeLocal.ToLocalChecked();
+            }
+            break;
+        }
+        case JNIV8JavaObjectKind::kBoolean:
+            resultRef = v8::Boolean::New(isolate, env->CallBooleanMethod(object, _jniBoolean.booleanValueId));
+            break;
+        case JNIV8JavaObjectKind::kNumber:
+            resultRef = v8::Number::New(isolate, env->CallDoubleMethod(object, _jniNumber.doubleValueId));
+            break;
+        case JNIV8JavaObjectKind::kV8Object:
+            resultRef = JNIV8Wrapper::wrapObject<JNIV8Object>(object)->getJSObject();
+            break;
+        case JNIV8JavaObjectKind::kByteBuffer: {
+            // direct buffers are shared with js without copying; other buffers are not supported
+            v8::Local<v8::ArrayBuffer> arrayBuffer;
+            if(JNIV8ArrayBuffer::newArrayBuffer(isolate, object).ToLocal(&arrayBuffer)) {
+                resultRef = arrayBuffer;
+            }
+            break;
+        }
+        case JNIV8JavaObjectKind::kUnsupported:
+            break;
     }
     if(resultRef.IsEmpty()) {
         resultRef = v8::Undefined(isolate);
@@ -532,6 +668,88 @@ v8::Local<v8::Value> JNIV8Marshalling::jobject2v8value(jobject object) {
     return scope.Escape(resultRef);
 }
 
+JNIV8JavaObjectKind JNIV8Marshalling::getObjectKind(JNIEnv *env, jobject object) {
+    // consecutive values mostly share their class, e.g. the elements of a List<Double>
+    // all subclasses of a supported class have the same kind, so an instance check is enough to reuse the last match
+    const int lastMatch = _lastClassMatch.load(std::memory_order_relaxed);
+    jclass lastClazz;
+    JNIV8JavaObjectKind lastKind;
+    if(lastMatch < 0) {
+        lastClazz = _finalClasses[-1 - lastMatch].clazz;
+        lastKind = _finalClasses[-1 - lastMatch].kind;
+    } else {
+        lastClazz = _classCache[lastMatch].clazz.load(std::memory_order_acquire);
+        lastKind = _classCache[lastMatch].kind;
+    }
+    if(lastClazz && lastKind != JNIV8JavaObjectKind::kUnsupported && env->IsInstanceOf(object, lastClazz)) {
+        return lastKind;
+    }
+
+    jclass clazz = env->GetObjectClass(object);
+
+    // the most common classes are final, so comparing the class is enough; hashing it below takes a call into java
+    for(int i = 0; i < kFinalClassCount; i++) {
+        if(env->IsSameObject(clazz, _finalClasses[i].clazz)) {
+            _lastClassMatch.store(-1 - i, std::memory_order_relaxed);
+            env->DeleteLocalRef(clazz);
+            return _finalClasses[i].kind;
+        }
+    }
+
+    // local refs to the same class differ from each other, so the identity hash of the class is used as the key
+    const size_t mask = kClassCacheSize - 1;
+    const size_t start = ((uint32_t)env->CallIntMethod(clazz, _hashCodeId) * 2654435761u) & mask;
+
+    size_t slot = start;
+    for(size_t i = 0; i < kClassCacheSize; i++, slot = (slot + 1) & mask) {
+        jclass cachedClazz = _classCache[slot].clazz.load(std::memory_order_acquire);
+        if(!cachedClazz) break;
+        if(env->IsSameObject(cachedClazz, clazz)) {
+            JNIV8JavaObjectKind kind = _classCache[slot].kind;
+            _lastClassMatch.store((int)slot, std::memory_order_relaxed);
+            env->DeleteLocalRef(clazz);
+            return kind;
+        }
+    }
+
+    JNIV8JavaObjectKind kind = resolveObjectKind(env, clazz);
+
+    // the table only grows, so a class is inserted at most once; if it is full, classes are resolved every time
+    std::lock_guard<std::mutex> lock(_classCacheMutex);
+    slot = start;
+    for(size_t i = 0; i < kClassCacheSize; i++, slot = (slot + 1) & mask) {
+        jclass cachedClazz = _classCache[slot].clazz.load(std::memory_order_relaxed);
+        if(!cachedClazz) {
+            _classCache[slot].kind = kind;
+            _classCache[slot].clazz.store((jclass)env->NewGlobalRef(clazz), std::memory_order_release);
+            _lastClassMatch.store((int)slot, std::memory_order_relaxed);
+            break;
+        }
+        if(env->IsSameObject(cachedClazz, clazz)) break;
+    }
+
+    env->DeleteLocalRef(clazz);
+    return kind;
+}
+
+JNIV8JavaObjectKind JNIV8Marshalling::resolveObjectKind(JNIEnv *env, jclass clazz) {
+    if(env->IsAssignableFrom(clazz, _jniString.clazz)) {
+        return JNIV8JavaObjectKind::kString;
+    } else if(env->IsAssignableFrom(clazz, _jniCharacter.clazz)) {
+        return JNIV8JavaObjectKind::kCharacter;
+    } else if(env->IsAssignableFrom(clazz, _jniNumber.clazz)) {
+        // e.g. BigDecimal or AtomicInteger; the boxed types never get here
+        return JNIV8JavaObjectKind::kNumber;
+    } else if(env->IsAssignableFrom(clazz, _jniBoolean.clazz)) {
+        return JNIV8JavaObjectKind::kBoolean;
+    } else if(env->IsAssignableFrom(clazz, _jniV8Object.clazz)) {
+        return JNIV8JavaObjectKind::kV8Object;
+    } else if(env->IsAssignableFrom(clazz, JNIV8ArrayBuffer::getByteBufferClass())) {
+        return JNIV8JavaObjectKind::kByteBuffer;
+    }
+    return JNIV8JavaObjectKind::kUnsupported;
+}
+
 /**
  * return an object representing undefined in java
  */
@@ -543,5 +761,24 @@ jobject JNIV8Marshalling::undefinedInJava() {
  * convert a v8::String to a std::string
  */
 std::string JNIV8Marshalling::v8string2string(v8::Local<v8::Value> value) {
-    return (value.IsEmpty() ? std::string("") : std::string(*v8::String::Utf8Value(value->ToString())));
+    if(value.IsEmpty()) {
+        return std::string("");
+    }
+    v8::Local<v8::String> string = value->ToString();
+    if(string.IsEmpty()) {
+        return std::string("");
+    }
+    // short strings are encoded on the stack; every char takes at most 3 bytes
+    const int length = string->Length();
+    if(length <= (int)JNIStringCoding::kStackBufferLength) {
+        char bytes[JNIStringCoding::kStackBufferLength * 3];
+        int size = string->WriteUtf8(bytes, sizeof(bytes), nullptr,
+                                     v8::String::NO_NULL_TERMINATION | v8::String::REPLACE_INVALID_UTF8);
+        return std::string(bytes, (size_t)size);
+    }
+    // longer strings are encoded straight into the result instead of through a temporary Utf8Value
+    std::string ret((size_t)string->Utf8Length(), '\0');
+    string->WriteUtf8(&ret[0], (int)ret.size(), nullptr,
+                      v8::String::NO_NULL_TERMINATION | v8::String::REPLACE_INVALID_UTF8);
+    return ret;
 }
\ No newline at end of file
@@ -7,6 +7,8 @@
 
 #include <v8.h>
 #include <jni.h>
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
@@ -38,6 +40,19 @@ enum class JNIV8JavaValueType {
     kVoid = 10
 };
 
+/**
+ * kinds of java objects that can be converted to a v8 value; resolved once per class by jobject2v8value
+ */
+enum class JNIV8JavaObjectKind : uint8_t {
+    kUnsupported = 0,
+    kString,
+    kCharacter,
+    kBoolean,
+    kNumber,
+    kV8Object,
+    kByteBuffer
+};
+
 enum JNIV8MarshallingFlags {
     kDefault = 0,
     /*
@@ -106,6 +121,13 @@ public:
      */
     static v8::Local<v8::Value> callJavaMethod(JNIEnv *env, JNIV8JavaValue returnType, jclass clazz, jmethodID methodId, jobject object, jvalue *args);
 
+    /**
+     * calls a java method with the provided arguments and returns the result as a local reference
+     * primitive results are boxed, void methods return null
+     * does not touch v8, so it can be used on threads without an isolate
+     */
+    static jobject callJavaMethodBoxed(JNIEnv *env, JNIV8JavaValue returnType, jclass clazz, jmethodID methodId, jobject object, jvalue *args);
+
     /**
      * convert a v8 value to an instance of Object
      */
@@ -144,6 +166,31 @@ private:
     static jobject _undefined;
     static std::unordered_map<int, JNIV8JavaValueType> _typeMap;
 
+    /**
+     * returns the kind of a non-null java object
+     * String and the boxed types are compared directly; the kind of other classes is cached in a table of global
+     * class refs, open addressed by the identity hash of the class
+     * entries are added once and never removed; the class of the last match - final or cached - is tried first with a
+     * single IsInstanceOf, so homogeneous collections take one jni call per element
+     */
+    static JNIV8JavaObjectKind getObjectKind(JNIEnv *env, jobject object);
+    static JNIV8JavaObjectKind resolveObjectKind(JNIEnv *env, jclass clazz);
+
+    static const size_t kClassCacheSize = 64;
+    static struct ClassCacheEntry {
+        std::atomic<jclass> clazz;
+        JNIV8JavaObjectKind kind;
+    } _classCache[kClassCacheSize];
+    static const int kFinalClassCount = 9;
+    static struct FinalClassEntry {
+        jclass clazz;
+        JNIV8JavaObjectKind kind;
+    } _finalClasses[kFinalClassCount];
+    // the last match: a slot of _classCache if >= 0, otherwise the index -1 - _lastClassMatch of _finalClasses
+    static std::atomic<int> _lastClassMatch;
+    static std::mutex _classCacheMutex;
+    static jmethodID _hashCodeId;
+
     static struct {
         jclass clazz;
         jmethodID valueOfId;
@@ -3,13 +3,19 @@
 //
 
 #include "JNIV8Object.h"
+#include "JNIV8ArrayElements.h"
 #include "JNIV8Wrapper.h"
 #include "../bgjs/BGJSV8Engine.h"
 
+#include <algorithm>
 #include <stdlib.h>
+#include <vector>
 
 #define LOG_TAG "JNIV8Object"
 
+// number of fields converted per handle scope and local reference frame by the bulk field accessors
+#define FIELD_CHUNK_SIZE 64
+
 using namespace v8;
 
 BGJS_JNI_LINK(JNIV8Object, "ag/boersego/bgjs/JNIV8Object");
@@ -54,6 +60,7 @@ void JNIV8Object::initJNICache() {
 
 JNIV8Object::JNIV8Object(jobject obj, JNIClassInfo *info) : JNIObject(obj, info) {
     _externalMemory = 0;
+    _isolateOwner = nullptr;
     // __android_log_print(ANDROID_LOG_INFO, "JNIV8Object", "created v8 object: %s", getCanonicalName().c_str());
 }
 
@@ -64,6 +71,10 @@ JNIV8Object::~JNIV8Object() {
         JNI_ASSERT(!_jsObject.IsWeak(), "JNIV8Object deleted while still referenced by JavaScript");
         _jsObject.Reset();
     }
+    // might dispose the isolate, if the engine was already destroyed
+    if(_isolateOwner) {
+        _isolateOwner->release();
+    }
 }
 
 void JNIV8Object::weakPersistentCallback(const WeakCallbackInfo<void>& data) {
@@ -80,13 +91,14 @@ void JNIV8Object::weakPersistentCallback(const WeakCallbackInfo<void>& data) {
     jniV8Object->_bgjsEngine->getIsolate()->AdjustAmountOfExternalAllocatedMemory(-jniV8Object->_externalMemory);
 
     // finally: the js object is no longer being used => release the strong reference to the java object
-    // NOTE: object might be deleted by another thread after calling this
-    jniV8Object->releaseJObject();
+    // this is deferred to the next idle point of the engine, the object stays retained until then
+    // NOTE: object might be deleted by another thread after the queue released it
+    jniV8Object->_bgjsEngine->getFinalizationQueue()->enqueueRelease(jniV8Object);
 }
 
 void JNIV8Object::makeWeak() {
     // wrapper type objects are not directly linked to the lifecycle of the js object
-    // they can be destroyed / gced from java at any time, and there can exist multiple
+    // they can be destroyed / gced from java at any time, and are then recreated on demand
     if(_v8ClassInfo->container->type == JNIV8ObjectType::kWrapper || _jsObject.IsWeak()) return;
     _jsObject.SetWeak((void*)this, JNIV8Object::weakPersistentCallback, WeakCallbackType::kFinalizer);
     // create a strong reference to the java object as long as the JS object is referenced from somewhere
@@ -150,6 +162,10 @@ void JNIV8Object::setJSObject(BGJSV8Engine *engine, JNIV8ClassInfo *cls,
 
     _bgjsEngine = engine;
     _v8ClassInfo = cls;
+    if(!_isolateOwner) {
+        _isolateOwner = engine->getIsolateOwner();
+        _isolateOwner->retain();
+    }
 
     if (!jsObject.IsEmpty()) {
         linkJSObject(jsObject);
@@ -178,14 +194,37 @@ void JNIV8Object::initializeJNIBindings(JNIClassInfo *info, bool isReload) {
     info->registerNativeMethod("setV8Fields", "(Ljava/util/Map;)V", (void*)JNIV8Object::jniSetV8Fields);
 
     info->registerNativeMethod("hasV8Field", "(Ljava/lang/String;Z)Z", (void*)JNIV8Object::jniHasV8Field);
+
+    info->registerNativeMethod("_applyV8MethodByKey", "(IIILjava/lang/Class;[Ljava/lang/Object;)Ljava/lang/Object;", (void*)JNIV8Object::jniCallV8MethodByKeyWithReturnType);
+    info->registerNativeMethod("_getV8FieldByKey", "(IIILjava/lang/Class;)Ljava/lang/Object;", (void*)JNIV8Object::jniGetV8FieldByKeyWithReturnType);
+    info->registerNativeMethod("_setV8FieldByKey", "(ILjava/lang/Object;)V", (void*)JNIV8Object::jniSetV8FieldByKey);
+    info->registerNativeMethod("_hasV8FieldByKey", "(IZ)Z", (void*)JNIV8Object::jniHasV8FieldByKey);
     info->registerNativeMethod("getV8Keys", "(Z)[Ljava/lang/String;", (void*)JNIV8Object::jniGetV8Keys);
     info->registerNativeMethod("getV8Fields", "(ZIILjava/lang/Class;)Ljava/util/Map;", (void*)JNIV8Object::jniGetV8Fields);
 
+    info->registerNativeMethod("_getV8FieldArray", "([Ljava/lang/String;[IIILjava/lang/Class;)[Ljava/lang/Object;", (void*)JNIV8Object::jniGetV8FieldArray);
+    info->registerNativeMethod("_getV8FieldsAsDoubles", "([Ljava/lang/String;[I)[D", (void*)JNIV8Object::jniGetV8PrimitiveFields<jdouble>);
+    info->registerNativeMethod("_getV8FieldsAsFloats", "([Ljava/lang/String;[I)[F", (void*)JNIV8Object::jniGetV8PrimitiveFields<jfloat>);
+    info->registerNativeMethod("_getV8FieldsAsInts", "([Ljava/lang/String;[I)[I", (void*)JNIV8Object::jniGetV8PrimitiveFields<jint>);
+    info->registerNativeMethod("_getV8FieldsAsLongs", "([Ljava/lang/String;[I)[J", (void*)JNIV8Object::jniGetV8PrimitiveFields<jlong>);
+    info->registerNativeMethod("_getV8FieldsAsBooleans", "([Ljava/lang/String;[I)[Z", (void*)JNIV8Object::jniGetV8PrimitiveFields<jboolean>);
+    info->registerNativeMethod("_setV8FieldArray", "([Ljava/lang/String;[I[Ljava/lang/Object;)V", (void*)JNIV8Object::jniSetV8FieldArray);
+    info->registerNativeMethod("_setV8FieldArray", "([Ljava/lang/String;[I[D)V", (void*)JNIV8Object::jniSetV8PrimitiveFields<jdouble>);
+    info->registerNativeMethod("_setV8FieldArray", "([Ljava/lang/String;[I[F)V", (void*)JNIV8Object::jniSetV8PrimitiveFields<jfloat>);
+    info->registerNativeMethod("_setV8FieldArray", "([Ljava/lang/String;[I[I)V", (void*)JNIV8Object::jniSetV8PrimitiveFields<jint>);
+    info->registerNativeMethod("_setV8FieldArray", "([Ljava/lang/String;[I[J)V", (void*)JNIV8Object::jniSetV8PrimitiveFields<jlong>);
+    info->registerNativeMethod("_setV8FieldArray", "([Ljava/lang/String;[I[Z)V", (void*)JNIV8Object::jniSetV8PrimitiveFields<jboolean>);
+
     info->registerNativeMethod("toNumber", "()D", (void*)JNIV8Object::jniToNumber);
     info->registerNativeMethod("toString", "()Ljava/lang/String;", (void*)JNIV8Object::jniToString);
     info->registerNativeMethod("toJSON", "()Ljava/lang/String;", (void*)JNIV8Object::jniToJSON);
+    info->registerNativeMethod("serialize", "()[B", (void*)JNIV8Object::jniSerialize);
+    info->registerNativeMethod("setV8FieldsSerialized", "([B)V", (void*)JNIV8Object::jniSetV8FieldsSerialized);
 
     info->registerNativeMethod("RegisterV8Class", "(Ljava/lang/String;Ljava/lang/String;)V", (void*)JNIV8Object::jniRegisterV8Class);
+    info->registerNativeMethod("setWrapperCaching", "(Z)V", (void*)JNIV8Object::jniSetWrapperCaching);
+    info->registerNativeMethod("isWrapperCachingEnabled", "()Z", (void*)JNIV8Object::jniIsWrapperCachingEnabled);
+    info->registerNativeMethod("getWrapperStats", "()[J", (void*)JNIV8Object::jniGetWrapperStats);
 }
 
 void JNIV8Object::jniAdjustJSExternalMemory(JNIEnv *env, jobject obj, jlong change) {
@@ -193,12 +232,42 @@ void JNIV8Object::jniAdjustJSExternalMemory(JNIEnv *env, jobject obj, jlong chan
     ptr->adjustJSExternalMemory(change);
 }
 
+/**
+ * resolves the name of a property: either a java string, or - if name is null - a key created by V8Engine.getV8Key
+ * throws an IllegalArgumentException and returns false if the key is not valid for the engine
+ */
+static bool getPropertyKey(JNIEnv *env, BGJSV8Engine *engine, jstring name, jint key, Local<String> *keyRef) {
+    if(name) {
+        *keyRef = JNIV8Marshalling::jstring2v8string(name);
+        return true;
+    }
+    *keyRef = engine->getPropertyKey(key);
+    if(keyRef->IsEmpty()) {
+        env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"), "V8Key does not belong to this engine");
+        return false;
+    }
+    return true;
+}
+
 jobject JNIV8Object::jniGetV8FieldWithReturnType(JNIEnv *env, jobject obj, jstring name, jint flags, jint type, jclass returnType) {
+    return getV8FieldWithReturnType(env, obj, name, -1, flags, type, returnType);
+}
+
+jobject JNIV8Object::jniGetV8FieldByKeyWithReturnType(JNIEnv *env, jobject obj, jint key, jint flags, jint type, jclass returnType) {
+    return getV8FieldWithReturnType(env, obj, nullptr, key, flags, type, returnType);
+}
+
+jobject JNIV8Object::getV8FieldWithReturnType(JNIEnv *env, jobject obj, jstring name, jint key, jint flags, jint type, jclass returnType) {
     JNIV8Object_PrepareJNICall(JNIV8Object, Object, nullptr);
 
+    Local<String> keyRef;
+    if(!getPropertyKey(env, engine, name, key, &keyRef)) {
+        return nullptr;
+    }
+
     JNIV8JavaValue arg = JNIV8Marshalling::valueWithClass(type, returnType, (JNIV8MarshallingFlags)flags);
 
-    MaybeLocal<Value> valueRef = localRef->Get(context, JNIV8Marshalling::jstring2v8string(name));
+    MaybeLocal<Value> valueRef = localRef->Get(context, keyRef);
     if(valueRef.IsEmpty()) {
         ptr->getEngine()->forwardV8ExceptionToJNI(&try_catch);
         return nullptr;
@@ -208,7 +277,7 @@ jobject JNIV8Object::jniGetV8FieldWithReturnType(JNIEnv *env, jobject obj, jstri
     memset(&jval, 0, sizeof(jvalue));
     JNIV8MarshallingError res = JNIV8Marshalling::convertV8ValueToJavaValue(env, valueRef.ToLocalChecked(), arg, &jval);
     if(res != JNIV8MarshallingError::kOk) {
-        std::string strFieldName = JNIWrapper::jstring2string(name);
+        std::string strFieldName = JNIV8Marshalling::v8string2string(keyRef);
         switch(res) {
             default:
             case JNIV8MarshallingError::kWrongType:
@@ -238,9 +307,22 @@ jobject JNIV8Object::jniGetV8FieldWithReturnType(JNIEnv *env, jobject obj, jstri
 }
 
 void JNIV8Object::jniSetV8Field(JNIEnv *env, jobject obj, jstring name, jobject value) {
+    setV8Field(env, obj, name, -1, value);
+}
+
+void JNIV8Object::jniSetV8FieldByKey(JNIEnv *env, jobject obj, jint key, jobject value) {
+    setV8Field(env, obj, nullptr, key, value);
+}
+
+void JNIV8Object::setV8Field(JNIEnv *env, jobject obj, jstring name, jint key, jobject value) {
     JNIV8Object_PrepareJNICall(JNIV8Object, Object, void());
 
-    Maybe<bool> res = localRef->Set(context, JNIV8Marshalling::jstring2v8string(name), JNIV8Marshalling::jobject2v8value(value));
+    Local<String> keyRef;
+    if(!getPropertyKey(env, engine, name, key, &keyRef)) {
+        return;
+    }
+
+    Maybe<bool> res = localRef->Set(context, keyRef, JNIV8Marshalling::jobject2v8value(value));
     if(res.IsNothing()) {
         ptr->getEngine()->forwardV8ExceptionToJNI(&try_catch);
     }
@@ -276,14 +358,273 @@ void JNIV8Object::jniSetV8Fields(JNIEnv *env, jobject obj, jobject map) {
     }
 }
 
+/**
+ * copies the V8Key indices of a bulk field access; fields are named either by an array of java strings,
+ * or - if names is null - by an array of indices
+ * returns the number of fields
+ */
+static jsize getPropertyKeyList(JNIEnv *env, jobjectArray names, jintArray keys, std::vector<jint> *indices) {
+    if(names) {
+        return env->GetArrayLength(names);
+    }
+    jsize length = env->GetArrayLength(keys);
+    indices->resize((size_t)length);
+    if(length) {
+        env->GetIntArrayRegion(keys, 0, length, indices->data());
+    }
+    return length;
+}
+
+/**
+ * resolves the name of the field at the specified position of a bulk field access
+ * throws a java exception and returns false if the name is null or the key is not valid for the engine
+ */
+static bool getPropertyKeyAt(JNIEnv *env, BGJSV8Engine *engine, jobjectArray names, const std::vector<jint> &indices, jsize index, Local<String> *keyRef) {
+    if(!names) {
+        return getPropertyKey(env, engine, nullptr, indices[index], keyRef);
+    }
+    jstring name = (jstring)env->GetObjectArrayElement(names, index);
+    if(!name) {
+        env->ThrowNew(env->FindClass("java/lang/NullPointerException"), "field names must not be null");
+        return false;
+    }
+    *keyRef = JNIV8Marshalling::jstring2v8string(name);
+    env->DeleteLocalRef(name);
+    return true;
+}
+
+/**
+ * throws the js exception matching a failed conversion of a field value
+ */
+static void throwFieldError(JNIV8MarshallingError res, Local<String> keyRef, Local<Value> valueRef) {
+    std::string strFieldName = JNIV8Marshalling::v8string2string(keyRef);
+    switch(res) {
+        default:
+        case JNIV8MarshallingError::kWrongType:
+            ThrowV8TypeError("wrong type for field '" + strFieldName + "'");
+            break;
+        case JNIV8MarshallingError::kUndefined:
+            ThrowV8TypeError("field '" + strFieldName + "' must not be undefined");
+            break;
+        case JNIV8MarshallingError::kNotNullable:
+            ThrowV8TypeError("field '" + strFieldName + "' is not nullable");
+            break;
+        case JNIV8MarshallingError::kNoNaN:
+            ThrowV8TypeError("field '" + strFieldName + "' must not be NaN");
+            break;
+        case JNIV8MarshallingError::kVoidNotNull:
+            ThrowV8TypeError("field '" + strFieldName + "' can only be null or undefined");
+            break;
+        case JNIV8MarshallingError::kOutOfRange:
+            ThrowV8RangeError("value '"+
+                              JNIV8Marshalling::v8string2string(valueRef->ToString())+"' is out of range for field '" + strFieldName + "'");
+            break;
+    }
+}
+
+/**
+ * returns the values of the specified fields, in the order of the names
+ * all fields are read within a single call; local references are released one chunk of fields at a time
+ */
+jobjectArray JNIV8Object::jniGetV8FieldArray(JNIEnv *env, jobject obj, jobjectArray names, jintArray keys, jint flags, jint type, jclass returnType) {
+    JNIV8Object_PrepareJNICall(JNIV8Object, Object, nullptr);
+
+    JNIV8JavaValue arg = JNIV8Marshalling::valueWithClass(type, returnType, (JNIV8MarshallingFlags)flags);
+
+    std::vector<jint> indices;
+    jsize size = getPropertyKeyList(env, names, keys, &indices);
+
+    jobjectArray result = env->NewObjectArray(size, returnType ? returnType : _jniObject.clazz, nullptr);
+    if(!size || !result) return result;
+
+    for(jsize offset = 0; offset < size; offset += FIELD_CHUNK_SIZE) {
+        jsize count = std::min<jsize>(FIELD_CHUNK_SIZE, size - offset);
+        if(env->PushLocalFrame(count * 2) != 0) {
+            return nullptr;
+        }
+        v8::HandleScope chunkScope(isolate);
+
+        for(jsize i = offset; i < offset + count; i++) {
+            Local<String> keyRef;
+            if(!getPropertyKeyAt(env, engine, names, indices, i, &keyRef)) {
+                env->PopLocalFrame(nullptr);
+                return nullptr;
+            }
+
+            Local<Value> valueRef;
+            if(!localRef->Get(context, keyRef).ToLocal(&valueRef)) {
+                env->PopLocalFrame(nullptr);
+                engine->forwardV8ExceptionToJNI(&try_catch);
+                return nullptr;
+            }
+
+            jvalue jval;
+            memset(&jval, 0, sizeof(jvalue));
+            JNIV8MarshallingError res = JNIV8Marshalling::convertV8ValueToJavaValue(env, valueRef, arg, &jval);
+            if(res != JNIV8MarshallingError::kOk) {
+                throwFieldError(res, keyRef, valueRef);
+            }
+            if(try_catch.HasCaught()) {
+                // converting objects can invoke valueOf
+                env->PopLocalFrame(nullptr);
+                engine->forwardV8ExceptionToJNI(&try_catch);
+                return nullptr;
+            }
+
+            env->SetObjectArrayElement(result, i, jval.l);
+            if(jval.l) {
+                env->DeleteLocalRef(jval.l);
+            }
+        }
+
+        env->PopLocalFrame(nullptr);
+    }
+
+    return result;
+}
+
+/**
+ * copies the values of the specified fields into a primitive java array, without boxing them
+ */
+template<typename T>
+jarray JNIV8Object::jniGetV8PrimitiveFields(JNIEnv *env, jobject obj, jobjectArray names, jintArray keys) {
+    JNIV8Object_PrepareJNICall(JNIV8Object, Object, nullptr);
+
+    std::vector<jint> indices;
+    jsize size = getPropertyKeyList(env, names, keys, &indices);
+
+    jarray result = JNIV8ArrayElements<T>::newArray(env, size);
+    if(!size || !result) return result;
+
+    T buffer[FIELD_CHUNK_SIZE];
+    for(jsize offset = 0; offset < size; offset += FIELD_CHUNK_SIZE) {
+        v8::HandleScope chunkScope(isolate);
+        jsize count = std::min<jsize>(FIELD_CHUNK_SIZE, size - offset);
+        for(jsize j = 0; j < count; j++) {
+            Local<String> keyRef;
+            if(!getPropertyKeyAt(env, engine, names, indices, offset + j, &keyRef)) {
+                return nullptr;
+            }
+            Local<Value> valueRef;
+            if(!localRef->Get(context, keyRef).ToLocal(&valueRef)) {
+                engine->forwardV8ExceptionToJNI(&try_catch);
+                return nullptr;
+            }
+            JNIV8MarshallingError res = JNIV8ArrayElements<T>::fromValue(valueRef, &buffer[j]);
+            if(!try_catch.HasCaught() && res != JNIV8MarshallingError::kOk) {
+                throwFieldError(res, keyRef, valueRef);
+            }
+            if(try_catch.HasCaught()) {
+                engine->forwardV8ExceptionToJNI(&try_catch);
+                return nullptr;
+            }
+        }
+        JNIV8ArrayElements<T>::setRegion(env, result, offset, count, buffer);
+    }
+
+    return result;
+}
+
+/**
+ * checks that a bulk field assignment has exactly one value per field
+ * throws a java exception and returns false otherwise
+ */
+static bool checkFieldValues(JNIEnv *env, jsize size, jarray values) {
+    if(!values) {
+        env->ThrowNew(env->FindClass("java/lang/NullPointerException"), "values must not be null");
+        return false;
+    }
+    if(env->GetArrayLength(values) != size) {
+        env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"), "number of values does not match number of fields");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * assigns the values to the specified fields, in the order of the names
+ */
+void JNIV8Object::jniSetV8FieldArray(JNIEnv *env, jobject obj, jobjectArray names, jintArray keys, jobjectArray values) {
+    JNIV8Object_PrepareJNICall(JNIV8Object, Object, void());
+
+    std::vector<jint> indices;
+    jsize size = getPropertyKeyList(env, names, keys, &indices);
+    if(!checkFieldValues(env, size, values)) return;
+
+    for(jsize offset = 0; offset < size; offset += FIELD_CHUNK_SIZE) {
+        jsize count = std::min<jsize>(FIELD_CHUNK_SIZE, size - offset);
+        if(env->PushLocalFrame(count) != 0) {
+            return;
+        }
+        v8::HandleScope chunkScope(isolate);
+
+        for(jsize i = offset; i < offset + count; i++) {
+            Local<String> keyRef;
+            if(!getPropertyKeyAt(env, engine, names, indices, i, &keyRef)) {
+                env->PopLocalFrame(nullptr);
+                return;
+            }
+            if(localRef->Set(context, keyRef, JNIV8Marshalling::jobject2v8value(env->GetObjectArrayElement(values, i))).IsNothing()) {
+                env->PopLocalFrame(nullptr);
+                engine->forwardV8ExceptionToJNI(&try_catch);
+                return;
+            }
+        }
+
+        env->PopLocalFrame(nullptr);
+    }
+}
+
+/**
+ * assigns the values of a primitive java array to the specified fields, in the order of the names
+ */
+template<typename T>
+void JNIV8Object::jniSetV8PrimitiveFields(JNIEnv *env, jobject obj, jobjectArray names, jintArray keys, jarray values) {
+    JNIV8Object_PrepareJNICall(JNIV8Object, Object, void());
+
+    std::vector<jint> indices;
+    jsize size = getPropertyKeyList(env, names, keys, &indices);
+    if(!checkFieldValues(env, size, values)) return;
+
+    T buffer[FIELD_CHUNK_SIZE];
+    for(jsize offset = 0; offset < size; offset += FIELD_CHUNK_SIZE) {
+        v8::HandleScope chunkScope(isolate);
+        jsize count = std::min<jsize>(FIELD_CHUNK_SIZE, size - offset);
+        JNIV8ArrayElements<T>::getRegion(env, values, offset, count, buffer);
+        for(jsize j = 0; j < count; j++) {
+            Local<String> keyRef;
+            if(!getPropertyKeyAt(env, engine, names, indices, offset + j, &keyRef)) {
+                return;
+            }
+            if(localRef->Set(context, keyRef, JNIV8ArrayElements<T>::toValue(isolate, buffer[j])).IsNothing()) {
+                engine->forwardV8ExceptionToJNI(&try_catch);
+                return;
+            }
+        }
+    }
+}
+
 jobject JNIV8Object::jniCallV8MethodWithReturnType(JNIEnv *env, jobject obj, jstring name, jint flags, jint type, jclass returnType, jobjectArray arguments) {
+    return callV8MethodWithReturnType(env, obj, name, -1, flags, type, returnType, arguments);
+}
+
+jobject JNIV8Object::jniCallV8MethodByKeyWithReturnType(JNIEnv *env, jobject obj, jint key, jint flags, jint type, jclass returnType, jobjectArray arguments) {
+    return callV8MethodWithReturnType(env, obj, nullptr, key, flags, type, returnType, arguments);
+}
+
+jobject JNIV8Object::callV8MethodWithReturnType(JNIEnv *env, jobject obj, jstring name, jint key, jint flags, jint type, jclass returnType, jobjectArray arguments) {
     JNIV8Object_PrepareJNICall(JNIV8Object, Object, nullptr);
 
+    Local<String> keyRef;
+    if(!getPropertyKey(env, engine, name, key, &keyRef)) {
+        return nullptr;
+    }
+
     JNIV8JavaValue arg = JNIV8Marshalling::valueWithClass(type, returnType, (JNIV8MarshallingFlags)flags);
 
     MaybeLocal<Value> maybeLocal;
     Local<Value> funcRef;
-    maybeLocal = localRef->Get(context, JNIV8Marshalling::jstring2v8string(name));
+    maybeLocal = localRef->Get(context, keyRef);
     if (!maybeLocal.ToLocal<Value>(&funcRef)) {
         ptr->getEngine()->forwardV8ExceptionToJNI(&try_catch);
         return nullptr;
@@ -323,7 +664,7 @@ jobject JNIV8Object::jniCallV8MethodWithReturnType(JNIEnv *env, jobject obj, jst
     memset(&jval, 0, sizeof(jvalue));
     JNIV8MarshallingError res = JNIV8Marshalling::convertV8ValueToJavaValue(env, resultRef, arg, &jval);
     if(res != JNIV8MarshallingError::kOk) {
-        std::string strMethodName = JNIWrapper::jstring2string(name);
+        std::string strMethodName = JNIV8Marshalling::v8string2string(keyRef);
         switch(res) {
             default:
             case JNIV8MarshallingError::kWrongType:
@@ -353,9 +694,20 @@ jobject JNIV8Object::jniCallV8MethodWithReturnType(JNIEnv *env, jobject obj, jst
 }
 
 jboolean JNIV8Object::jniHasV8Field(JNIEnv *env, jobject obj, jstring name, jboolean ownOnly) {
+    return hasV8Field(env, obj, name, -1, ownOnly);
+}
+
+jboolean JNIV8Object::jniHasV8FieldByKey(JNIEnv *env, jobject obj, jint key, jboolean ownOnly) {
+    return hasV8Field(env, obj, nullptr, key, ownOnly);
+}
+
+jboolean JNIV8Object::hasV8Field(JNIEnv *env, jobject obj, jstring name, jint key, jboolean ownOnly) {
     JNIV8Object_PrepareJNICall(JNIV8Object, Object, false);
 
-    Local<String> keyRef = JNIV8Marshalling::jstring2v8string(name);
+    Local<String> keyRef;
+    if(!getPropertyKey(env, engine, name, key, &keyRef)) {
+        return (jboolean)false;
+    }
     Maybe<bool> res = ownOnly ? localRef->HasOwnProperty(context, keyRef) : localRef->Has(context, keyRef);
     if(res.IsNothing()) {
         ptr->getEngine()->forwardV8ExceptionToJNI(&try_catch);
@@ -486,6 +838,60 @@ jstring JNIV8Object::jniToJSON(JNIEnv *env, jobject obj) {
     return JNIV8Marshalling::v8string2jstring(stringValue.As<v8::String>());
 }
 
+jbyteArray JNIV8Object::jniSerialize(JNIEnv *env, jobject obj) {
+    JNIV8Object_PrepareJNICall(JNIV8Object, Object, nullptr);
+
+    std::vector<uint8_t> buffer;
+    if(!engine->serialize(localRef, &buffer)) {
+        engine->forwardV8ExceptionToJNI(&try_catch);
+        return nullptr;
+    }
+
+    jbyteArray result = env->NewByteArray((jsize)buffer.size());
+    if(result && !buffer.empty()) {
+        env->SetByteArrayRegion(result, 0, (jsize)buffer.size(), (const jbyte*)&buffer[0]);
+    }
+    return result;
+}
+
+void JNIV8Object::jniSetV8FieldsSerialized(JNIEnv *env, jobject obj, jbyteArray data) {
+    JNIV8Object_PrepareJNICall(JNIV8Object, Object, void());
+
+    // the deserializer allocates js objects while reading, so the data is copied instead of pinning the array
+    std::vector<uint8_t> bytes((size_t)env->GetArrayLength(data));
+    if(!bytes.empty()) {
+        env->GetByteArrayRegion(data, 0, (jsize)bytes.size(), (jbyte*)&bytes[0]);
+    }
+
+    Local<Value> value;
+    if(!engine->deserialize(bytes.data(), bytes.size()).ToLocal(&value)) {
+        engine->forwardV8ExceptionToJNI(&try_catch);
+        return;
+    }
+    if(!value->IsObject()) {
+        ptr = nullptr; // release shared_ptr before throwing an exception!
+        env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"), "Serialized value is not an object");
+        return;
+    }
+
+    // all fields are copied without returning to java
+    Local<Object> fields = value.As<Object>();
+    Local<Array> keys;
+    if(!fields->GetOwnPropertyNames(context).ToLocal(&keys)) {
+        engine->forwardV8ExceptionToJNI(&try_catch);
+        return;
+    }
+    const uint32_t numKeys = keys->Length();
+    for(uint32_t i = 0; i < numKeys; i++) {
+        Local<Value> key, fieldValue;
+        if(!keys->Get(context, i).ToLocal(&key) || !fields->Get(context, key).ToLocal(&fieldValue) ||
+           localRef->Set(context, key, fieldValue).IsNothing()) {
+            engine->forwardV8ExceptionToJNI(&try_catch);
+            return;
+        }
+    }
+}
+
 jstring JNIV8Object::jniToString(JNIEnv *env, jobject obj) {
     JNIV8Object_PrepareJNICall(JNIV8Object, Object, nullptr);
     MaybeLocal<String> maybeLocal = localRef->ToString(context);
@@ -506,6 +912,25 @@ void JNIV8Object::jniRegisterV8Class(JNIEnv *env, jobject obj, jstring derivedCl
     JNIV8Wrapper::registerJavaObject(strDerivedClass, strBaseClass);
 }
 
+void JNIV8Object::jniSetWrapperCaching(JNIEnv *env, jobject obj, jboolean enabled) {
+    JNIV8Wrapper::setWrapperCaching(enabled != 0);
+}
+
+jboolean JNIV8Object::jniIsWrapperCachingEnabled(JNIEnv *env, jobject obj) {
+    return (jboolean)JNIV8Wrapper::isWrapperCachingEnabled();
+}
+
+jlongArray JNIV8Object::jniGetWrapperStats(JNIEnv *env, jobject obj) {
+    uint64_t created, reused;
+    JNIV8Wrapper::getWrapperStats(&created, &reused);
+    const jlong stats[] = { (jlong)created, (jlong)reused };
+    jlongArray result = env->NewLongArray(2);
+    if(result) {
+        env->SetLongArrayRegion(result, 0, 2, stats);
+    }
+    return result;
+}
+
 //--------------------------------------------------------------------------------------------------
 // Exports
 //--------------------------------------------------------------------------------------------------
@@ -10,6 +10,7 @@
 #include "../jni/jni.h"
 
 class BGJSV8Engine;
+class BGJSIsolateOwner;
 class JNIV8Object;
 
 #define JNIV8Object_PrepareJNICall(T, L, R)\
@@ -86,12 +87,32 @@ private:
     static void jniSetV8Fields(JNIEnv *env, jobject obj, jobject map);
     static jobject jniCallV8MethodWithReturnType(JNIEnv *env, jobject obj, jstring name, jint flags, jint type, jclass returnType, jobjectArray arguments);
     static jboolean jniHasV8Field(JNIEnv *env, jobject obj, jstring name, jboolean ownOnly);
+    static jobject jniGetV8FieldByKeyWithReturnType(JNIEnv *env, jobject obj, jint key, jint flags, jint type, jclass returnType);
+    static void jniSetV8FieldByKey(JNIEnv *env, jobject obj, jint key, jobject value);
+    static jobject jniCallV8MethodByKeyWithReturnType(JNIEnv *env, jobject obj, jint key, jint flags, jint type, jclass returnType, jobjectArray arguments);
+    static jboolean jniHasV8FieldByKey(JNIEnv *env, jobject obj, jint key, jboolean ownOnly);
     static jobjectArray jniGetV8Keys(JNIEnv *env, jobject obj, jboolean ownOnly);
     static jobject jniGetV8Fields(JNIEnv *env, jobject obj, jboolean ownOnly, jint flags, jint type, jclass returnType);
+    // bulk field accessors; fields are named by an array of java strings, or - if names is null - of V8Key indices
+    static jobjectArray jniGetV8FieldArray(JNIEnv *env, jobject obj, jobjectArray names, jintArray keys, jint flags, jint type, jclass returnType);
+    template<typename T> static jarray jniGetV8PrimitiveFields(JNIEnv *env, jobject obj, jobjectArray names, jintArray keys);
+    static void jniSetV8FieldArray(JNIEnv *env, jobject obj, jobjectArray names, jintArray keys, jobjectArray values);
+    template<typename T> static void jniSetV8PrimitiveFields(JNIEnv *env, jobject obj, jobjectArray names, jintArray keys, jarray values);
     static jdouble jniToNumber(JNIEnv *env, jobject obj);
     static jstring jniToString(JNIEnv *env, jobject obj);
     static jstring jniToJSON(JNIEnv *env, jobject obj);
+    static jbyteArray jniSerialize(JNIEnv *env, jobject obj);
+    static void jniSetV8FieldsSerialized(JNIEnv *env, jobject obj, jbyteArray data);
     static void jniRegisterV8Class(JNIEnv *env, jobject obj, jstring derivedClass, jstring baseClass);
+    static void jniSetWrapperCaching(JNIEnv *env, jobject obj, jboolean enabled);
+    static jboolean jniIsWrapperCachingEnabled(JNIEnv *env, jobject obj);
+    static jlongArray jniGetWrapperStats(JNIEnv *env, jobject obj);
+
+    // shared implementations of the callbacks above; properties are named either by a java string or a V8Key index
+    static jobject getV8FieldWithReturnType(JNIEnv *env, jobject obj, jstring name, jint key, jint flags, jint type, jclass returnType);
+    static void setV8Field(JNIEnv *env, jobject obj, jstring name, jint key, jobject value);
+    static jobject callV8MethodWithReturnType(JNIEnv *env, jobject obj, jstring name, jint key, jint flags, jint type, jclass returnType, jobjectArray arguments);
+    static jboolean hasV8Field(JNIEnv *env, jobject obj, jstring name, jint key, jboolean ownOnly);
 
     // v8 callbacks
     static void weakPersistentCallback(const v8::WeakCallbackInfo<void>& data);
@@ -130,6 +151,8 @@ private:
     int64_t _externalMemory;
     JNIV8ClassInfo *_v8ClassInfo;
     BGJSV8Engine *_bgjsEngine;
+    // keeps the isolate alive until the handle was reset, the engine might be finalized first
+    BGJSIsolateOwner *_isolateOwner;
     v8::Persistent<v8::Object> _jsObject;
 };
 
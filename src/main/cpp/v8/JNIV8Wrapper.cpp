@@ -7,16 +7,41 @@ using namespace v8;
 
 #include "JNIV8Wrapper.h"
 #include "JNIV8Array.h"
+#include "JNIV8ArrayBuffer.h"
 #include "JNIV8GenericObject.h"
 #include "JNIV8Function.h"
 #include "v8.h"
 
 #include <string>
 #include <algorithm>
+#include <time.h>
+#include <mutex>
+
+#define LOG_TAG "JNIV8Wrapper"
 
 std::map<std::string, JNIV8ClassInfoContainer*> JNIV8Wrapper::_objmap;
+std::atomic<JNIV8ClassInfoContainer*> JNIV8Wrapper::_slots[JNITypeSlot::kMaxSlots];
+std::atomic<uint64_t> JNIV8Wrapper::_wrappersCreated(0);
+std::atomic<uint64_t> JNIV8Wrapper::_wrappersReused(0);
+std::atomic<bool> JNIV8Wrapper::_cacheWrappers(false);
+
+/**
+ * cache for the java wrapper of a js object, stored in a private of the js object
+ * the wrapper is only referenced weakly; the cell is deleted once the js object is collected
+ */
+struct JNIV8WrapperCacheCell {
+    jweak wrapper;
+    v8::Persistent<v8::Object> jsObject;
+};
 
-//const char* JNIV8Wrapper::_v8PrivateKey = "JNIV8WrapperPrivate";
+static void wrapperCacheCellWeakCallback(const v8::WeakCallbackInfo<JNIV8WrapperCacheCell>& data) {
+    JNIV8WrapperCacheCell *cell = data.GetParameter();
+    cell->jsObject.Reset();
+    if(cell->wrapper) {
+        JNIWrapper::getEnvironment()->DeleteWeakGlobalRef(cell->wrapper);
+    }
+    delete cell;
+}
 
 decltype(JNIV8Wrapper::_jniObject) JNIV8Wrapper::_jniObject = {0};
 decltype(JNIV8Wrapper::_jniV8FunctionInfo) JNIV8Wrapper::_jniV8FunctionInfo = {0};
@@ -24,6 +49,7 @@ decltype(JNIV8Wrapper::_jniV8AccessorInfo) JNIV8Wrapper::_jniV8AccessorInfo = {0
 decltype(JNIV8Wrapper::_jniV8FunctionArgumentInfo) JNIV8Wrapper::_jniV8FunctionArgumentInfo = {0};
 
 pthread_mutex_t JNIV8Wrapper::_mutexEnv;
+std::once_flag JNIV8Wrapper::_jniCacheFlag;
 
 void JNIV8Wrapper::init() {
     pthread_mutexattr_t Attr;
@@ -36,9 +62,19 @@ void JNIV8Wrapper::init() {
                     nullptr, createJavaClass<JNIV8Object>, sizeof(JNIV8Object));
 
     JNIV8Wrapper::registerObject<JNIV8Array>(JNIV8ObjectType::kWrapper);
+    JNIV8Wrapper::registerObject<JNIV8ArrayBuffer>(JNIV8ObjectType::kWrapper);
     JNIV8Wrapper::registerObject<JNIV8GenericObject>(JNIV8ObjectType::kWrapper);
     JNIV8Wrapper::registerObject<JNIV8Function>(JNIV8ObjectType::kWrapper);
 
+    // JNI class references and ids are resolved later, see initJNICaches()
+}
+
+void JNIV8Wrapper::initJNICaches() {
+    // JNI_OnLoad only registers classes; everything else is resolved the first time an engine or object needs it
+    std::call_once(_jniCacheFlag, _initJNICaches);
+}
+
+void JNIV8Wrapper::_initJNICaches() {
     JNIEnv *env = JNIWrapper::getEnvironment();
 
     _jniObject.clazz = (jclass)env->NewGlobalRef(env->FindClass("java/lang/Object"));
@@ -47,7 +83,9 @@ void JNIV8Wrapper::init() {
     _jniV8FunctionInfo.propertyId = env->GetFieldID(_jniV8FunctionInfo.clazz, "property", "Ljava/lang/String;");
     _jniV8FunctionInfo.methodId = env->GetFieldID(_jniV8FunctionInfo.clazz, "method", "Ljava/lang/String;");
     _jniV8FunctionInfo.isStaticId = env->GetFieldID(_jniV8FunctionInfo.clazz, "isStatic", "Z");
+    _jniV8FunctionInfo.isAsyncId = env->GetFieldID(_jniV8FunctionInfo.clazz, "isAsync", "Z");
     _jniV8FunctionInfo.returnTypeId = env->GetFieldID(_jniV8FunctionInfo.clazz, "returnType", "Ljava/lang/String;");
+    _jniV8FunctionInfo.signatureId = env->GetFieldID(_jniV8FunctionInfo.clazz, "signature", "Ljava/lang/String;");
     _jniV8FunctionInfo.argumentsId = env->GetFieldID(_jniV8FunctionInfo.clazz, "arguments", "[Lag/boersego/v8annotations/generated/V8FunctionInfo$V8FunctionArgumentInfo;");
 
     _jniV8FunctionArgumentInfo.clazz = (jclass)env->NewGlobalRef(env->FindClass("ag/boersego/v8annotations/generated/V8FunctionInfo$V8FunctionArgumentInfo"));
@@ -67,6 +105,7 @@ void JNIV8Wrapper::init() {
     JNIV8Object::initJNICache();
     JNIV8Function::initJNICache();
     JNIV8Array::initJNICache();
+    JNIV8ArrayBuffer::initJNICache();
     JNIV8ClassInfo::initJNICache();
     JNIV8Marshalling::initJNICache();
     BGJSV8Engine::initJNICache();
@@ -108,8 +147,9 @@ void JNIV8Wrapper::v8ConstructorCallback(const v8::FunctionCallbackInfo<v8::Valu
     }
 
     // create temporary persistent for the js object and then call the constructor
+    // the object belongs to the engine of the calling context, which is not necessarily the one owning the class info
     v8::Persistent<Object>* jsObj = new v8::Persistent<v8::Object>(isolate, args.This());
-    auto ptr = info->container->creator(info, jsObj, arguments);
+    auto ptr = info->container->creator(info, BGJSV8Engine::GetInstance(isolate), jsObj, arguments);
 
     // also forward arguments to optional native constructor handler (if one was registered)
     if(info->constructorCallback) {
@@ -118,22 +158,69 @@ void JNIV8Wrapper::v8ConstructorCallback(const v8::FunctionCallbackInfo<v8::Valu
 }
 
 JNIV8ClassInfo* JNIV8Wrapper::_getV8ClassInfo(const std::string& canonicalName, BGJSV8Engine *engine) {
-    pthread_mutex_lock(&_mutexEnv);
-
     // find class info container
     auto it = _objmap.find(canonicalName);
     JNI_ASSERTF(it != _objmap.end(), "Attempt to retrieve class info for unregistered class: %s", canonicalName.c_str());
 
+    return _getV8ClassInfo(it->second, engine);
+}
+
+JNIV8ClassInfo* JNIV8Wrapper::_getV8ClassInfo(JNIV8ClassInfoContainer *container, BGJSV8Engine *engine) {
+    // class infos only contain templates, so they are shared by all engines (contexts) running on the same isolate
+    engine = engine->getIsolateHost();
+
+    pthread_mutex_lock(&_mutexEnv);
+
     // check if class info object already exists for this engine!
-    for(auto &it2 : it->second->classInfos) {
+    JNIV8ClassInfo *v8ClassInfo = nullptr;
+    for(auto &it2 : container->classInfos) {
         if(it2->engine == engine) {
-            pthread_mutex_unlock(&_mutexEnv);
-            return it2;
+            v8ClassInfo = it2;
+            break;
         }
     }
     // if it was not found we have to create it now & link it with the container
-    auto v8ClassInfo = new JNIV8ClassInfo(it->second, engine);
-    it->second->classInfos.push_back(v8ClassInfo);
+    if(!v8ClassInfo) {
+        v8ClassInfo = new JNIV8ClassInfo(container, engine);
+        container->classInfos.push_back(v8ClassInfo);
+    }
+
+    // wrappers never instantiate their template, so it is only built if a persistent subclass inherits from it
+    if(container->type != JNIV8ObjectType::kWrapper) {
+        _materializeV8ClassInfo(v8ClassInfo);
+    }
+
+    pthread_mutex_unlock(&_mutexEnv);
+
+    return v8ClassInfo;
+}
+
+JNIV8ClassInfoContainer* JNIV8Wrapper::_resolveSlot(size_t slot, const std::string& canonicalName) {
+    auto it = _objmap.find(canonicalName);
+    if(it == _objmap.end()) {
+        return nullptr;
+    }
+    // types beyond the slot capacity keep working, they are just looked up by name every time
+    if(slot < JNITypeSlot::kMaxSlots) {
+        _slots[slot].store(it->second, std::memory_order_release);
+    }
+    return it->second;
+}
+
+void JNIV8Wrapper::_materializeV8ClassInfo(JNIV8ClassInfo *v8ClassInfo) {
+    // templates are built once per engine, the first time js or java touches the class
+    if(!v8ClassInfo->functionTemplate.IsEmpty()) {
+        return;
+    }
+
+    BGJSV8Engine *engine = v8ClassInfo->engine;
+    JNIV8ClassInfoContainer *container = v8ClassInfo->container;
+    const std::string &canonicalName = container->canonicalName;
+
+    struct timespec start;
+    if(engine->_debug) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+    }
 
     // initialize class info: template with constructor and general setup created here
     // individual methods and accessors handled by static method on subclass
@@ -153,17 +240,11 @@ JNIV8ClassInfo* JNIV8Wrapper::_getV8ClassInfo(const std::string& canonicalName,
     ft->SetClassName(String::NewFromUtf8(isolate, strV8ClassName.c_str()));
 
     // inherit from baseclass
-    if(v8ClassInfo->container->baseClassInfo) {
-        JNIV8ClassInfo *baseInfo = nullptr;
+    if(container->baseClassInfo) {
         // base classinfo might not have been initialized yet => do so now!
-        _getV8ClassInfo(v8ClassInfo->container->baseClassInfo->canonicalName, engine);
-        for(auto &it2 : v8ClassInfo->container->baseClassInfo->classInfos) {
-            if(it2->engine == engine) {
-                baseInfo = it2;
-                break;
-            }
-        }
+        JNIV8ClassInfo *baseInfo = _getV8ClassInfo(container->baseClassInfo->canonicalName, engine);
         JNI_ASSERT(baseInfo, "Failed to retrieve baseclass info");
+        _materializeV8ClassInfo(baseInfo);
         Local<FunctionTemplate> baseFT = Local<FunctionTemplate>::New(isolate, baseInfo->functionTemplate);
         ft->Inherit(baseFT);
     }
@@ -175,130 +256,188 @@ JNIV8ClassInfo* JNIV8Wrapper::_getV8ClassInfo(const std::string& canonicalName,
     v8ClassInfo->functionTemplate.Reset(isolate, ft);
 
     // if this is a pure java class it might not have an initializer
-    if(it->second->initializer) {
-        it->second->initializer(v8ClassInfo);
+    if(container->initializer) {
+        container->initializer(v8ClassInfo);
     }
 
     // but it might have bindings on java that need to be processed
-    // binding classes + methods do not need to be cached here, because they are only used once per Engine upon initialization!
-    JNIEnv *env = JNIWrapper::getEnvironment();
-    jclass clsObject = it->second->clsObject;
-    jclass clsBinding = it->second->clsBinding;
-    if(clsBinding && clsObject) {
-        jfieldID createFromJavaOnlyId = env->GetStaticFieldID(clsBinding, "createFromJavaOnly", "Z");
-        v8ClassInfo->createFromJavaOnly = env->GetStaticBooleanField(clsBinding, createFromJavaOnlyId);
-
-        jmethodID getFunctionsMethodId = env->GetStaticMethodID(clsBinding, "getV8Functions",
-                                                                "()[Lag/boersego/v8annotations/generated/V8FunctionInfo;");
-        jmethodID getAccessorsMethodId = env->GetStaticMethodID(clsBinding, "getV8Accessors",
-                                                                "()[Lag/boersego/v8annotations/generated/V8AccessorInfo;");
-
-        // first register functions
-        jobjectArray functionInfos = (jobjectArray) env->CallStaticObjectMethod(clsBinding,
-                                                                                getFunctionsMethodId);
-        for(jsize idx=0,n=env->GetArrayLength(functionInfos);idx<n;idx++) {
-            jobject functionInfo = env->GetObjectArrayElement(functionInfos, idx);
-            const std::string strFunctionName = JNIWrapper::jstring2string((jstring)env->GetObjectField(functionInfo, _jniV8FunctionInfo.propertyId));
-            const std::string strMethodName = JNIWrapper::jstring2string((jstring)env->GetObjectField(functionInfo, _jniV8FunctionInfo.methodId));
-            const std::string strReturnType = JNIWrapper::jstring2string((jstring)env->GetObjectField(functionInfo, _jniV8FunctionInfo.returnTypeId));
-            jobjectArray argumentInfos = (jobjectArray)env->GetObjectField(functionInfo, _jniV8FunctionInfo.argumentsId);
-            std::vector<JNIV8JavaValue>* arguments = nullptr;
-
-            // return type information
-            const JNIV8JavaValue returnType = JNIV8Marshalling::persistentValueWithTypeSignature(strReturnType);
-
-            // build signature string and collect argument information
-            std::string strSignature = "(";
-            if(env->IsSameObject(argumentInfos, nullptr)) {
-                strSignature = "([Ljava/lang/Object;)" + strReturnType;
+    // they are parsed once per class; every further engine only creates the templates
+    if(container->clsBinding && container->clsObject) {
+        _parseJavaBinding(container);
+
+        v8ClassInfo->createFromJavaOnly = container->createFromJavaOnly;
+        for(auto &method : container->javaMethods) {
+            if(method.isStatic) {
+                v8ClassInfo->registerStaticJavaMethod(method.propertyName, method.methodId, method.returnType,
+                                                      method.arguments, method.isAsync);
             } else {
-                jsize numArguments = env->GetArrayLength(argumentInfos);
-                // collect arguments
-                // ownership of malloc'ed memory is implicitly transferred to JNIV8ClassInfo!
-                if(numArguments>0) {
-                    arguments = new std::vector<JNIV8JavaValue>();
-                    for(jsize argIdx=0; argIdx<numArguments; argIdx++) {
-                        const jobject argumentInfo = env->GetObjectArrayElement(argumentInfos, argIdx);
-                        const std::string strArgumentType = JNIWrapper::jstring2string((jstring)env->GetObjectField(argumentInfo, _jniV8FunctionArgumentInfo.typeId));
-                        JNIV8MarshallingFlags flags = JNIV8MarshallingFlags::kDefault;
-                        if(!(bool)env->GetBooleanField(argumentInfo, _jniV8FunctionArgumentInfo.isNullableId)) flags = JNIV8MarshallingFlags::kNonNull;
-                        if((bool)env->GetBooleanField(argumentInfo, _jniV8FunctionArgumentInfo.undefinedIsNullId)) flags = (JNIV8MarshallingFlags)(flags|JNIV8MarshallingFlags::kUndefinedIsNull);
-                        JNIV8JavaValue argument = JNIV8Marshalling::persistentArgumentWithTypeSignature(strArgumentType, flags);
-                        arguments->push_back(argument);
-                        strSignature += strArgumentType;
-                    }
-                }
-                strSignature += ")" + strReturnType;
-            }
-
-            // finally register the method
-            jmethodID javaMethodId;
-            if(env->GetBooleanField(functionInfo, _jniV8FunctionInfo.isStaticId)) {
-                javaMethodId = env->GetStaticMethodID(clsObject, strMethodName.c_str(),
-                                                strSignature.c_str());
-                v8ClassInfo->registerStaticJavaMethod(strFunctionName, javaMethodId,
-                                                      returnType,
-                                                      arguments);
-            } else {
-                javaMethodId = env->GetMethodID(clsObject, strMethodName.c_str(),
-                                                strSignature.c_str());
-                v8ClassInfo->registerJavaMethod(strFunctionName, javaMethodId,
-                                                returnType,
-                                                arguments);
+                v8ClassInfo->registerJavaMethod(method.propertyName, method.methodId, method.returnType,
+                                                method.arguments, method.isAsync);
             }
         }
-
-        // now register all property accessors
-        jobjectArray accessorInfos = (jobjectArray) env->CallStaticObjectMethod(clsBinding,
-                                                                                getAccessorsMethodId);
-        for(jsize idx=0,n=env->GetArrayLength(accessorInfos);idx<n;idx++) {
-            jobject accessorInfo = env->GetObjectArrayElement(accessorInfos, idx);
-            const std::string strPropertyType = JNIWrapper::jstring2string((jstring)env->GetObjectField(accessorInfo, _jniV8AccessorInfo.typeId));
-            JNIV8MarshallingFlags flags = JNIV8MarshallingFlags::kDefault;
-            if(!(bool)env->GetBooleanField(accessorInfo, _jniV8AccessorInfo.isNullableId)) flags = JNIV8MarshallingFlags::kNonNull;
-            if((bool)env->GetBooleanField(accessorInfo, _jniV8AccessorInfo.undefinedIsNullId)) flags = (JNIV8MarshallingFlags)(flags|JNIV8MarshallingFlags::kUndefinedIsNull);
-            const JNIV8JavaValue property = JNIV8Marshalling::persistentArgumentWithTypeSignature(strPropertyType, flags);
-
-            const std::string strPropertyName = JNIWrapper::jstring2string((jstring)env->GetObjectField(accessorInfo, _jniV8AccessorInfo.propertyId));
-            const std::string strGetterName = JNIWrapper::jstring2string((jstring)env->GetObjectField(accessorInfo, _jniV8AccessorInfo.getterId));
-            const std::string strSetterName = JNIWrapper::jstring2string((jstring)env->GetObjectField(accessorInfo, _jniV8AccessorInfo.setterId));
-            jmethodID javaGetterId = NULL, javaSetterId = NULL;
-            if(env->GetBooleanField(accessorInfo, _jniV8AccessorInfo.isStaticId)) {
-                if (!strGetterName.empty()) { javaGetterId = env->GetStaticMethodID(clsObject, strGetterName.c_str(), ("()" + strPropertyType).c_str()); }
-                if (!strSetterName.empty()) { javaSetterId = env->GetStaticMethodID(clsObject, strSetterName.c_str(), ("(" + strPropertyType + ")V").c_str()); }
-                v8ClassInfo->registerStaticJavaAccessor(strPropertyName, property, javaGetterId, javaSetterId);
+        for(auto &accessor : container->javaAccessors) {
+            if(accessor.isStatic) {
+                v8ClassInfo->registerStaticJavaAccessor(accessor.propertyName, accessor.propertyType, accessor.getterId, accessor.setterId);
             } else {
-                if (!strGetterName.empty()) { javaGetterId = env->GetMethodID(clsObject, strGetterName.c_str(), ("()" + strPropertyType).c_str()); }
-                if (!strSetterName.empty()) { javaSetterId = env->GetMethodID(clsObject, strSetterName.c_str(), ("(" + strPropertyType + ")V").c_str()); }
-                v8ClassInfo->registerJavaAccessor(strPropertyName, property, javaGetterId, javaSetterId);
+                v8ClassInfo->registerJavaAccessor(accessor.propertyName, accessor.propertyType, accessor.getterId, accessor.setterId);
             }
         }
     }
 
     // make sure that constructors exist!
 #ifdef ENABLE_JNI_ASSERT
+    JNIEnv *env = JNIWrapper::getEnvironment();
     jmethodID constructorId;
     if(!v8ClassInfo->createFromJavaOnly) {
         // if creation from javascript is allowed, we need the constructor!
-        constructorId = env->GetMethodID(it->second->clsObject, "<init>",
+        constructorId = env->GetMethodID(container->clsObject, "<init>",
                                          "(Lag/boersego/bgjs/V8Engine;J[Ljava/lang/Object;)V");
         JNI_ASSERTF(constructorId,
                    "Constructor '(V8Engine, long, Object[])' does not exist on registered class '%s'", canonicalName.c_str());
     } else {
         // if creation from javascript is not allowed, we need the other one...
-        constructorId = env->GetMethodID(it->second->clsObject, "<init>",
+        constructorId = env->GetMethodID(container->clsObject, "<init>",
                                          "(Lag/boersego/bgjs/V8Engine;)V");
         JNI_ASSERTF(constructorId,
                    "Constructor '(V8Engine)' does not exist on registered class '%s'", canonicalName.c_str());
     }
 #endif
 
-    pthread_mutex_unlock(&_mutexEnv);
+    // startup trace: shows which classes a screen actually pulls into an engine and what they cost
+    if(engine->_debug) {
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double duration = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+        LOGD("materialized class %s for engine %p in %.3fms (%zu java methods, %zu java accessors)", canonicalName.c_str(),
+             engine, duration, v8ClassInfo->javaCallbackHolders.size(), v8ClassInfo->javaAccessorHolders.size());
+    }
+}
 
-    return v8ClassInfo;
+void JNIV8Wrapper::_parseJavaBinding(JNIV8ClassInfoContainer *container) {
+    // called with _mutexEnv held
+    if(container->bindingParsed) {
+        return;
+    }
+    container->bindingParsed = true;
+
+    // binding classes + methods do not need to be cached here, because they are only used once per class
+    JNIEnv *env = JNIWrapper::getEnvironment();
+    jclass clsObject = container->clsObject;
+    jclass clsBinding = container->clsBinding;
+
+    jfieldID createFromJavaOnlyId = env->GetStaticFieldID(clsBinding, "createFromJavaOnly", "Z");
+    container->createFromJavaOnly = env->GetStaticBooleanField(clsBinding, createFromJavaOnlyId);
+
+    jmethodID getFunctionsMethodId = env->GetStaticMethodID(clsBinding, "getV8Functions",
+                                                            "()[Lag/boersego/v8annotations/generated/V8FunctionInfo;");
+    jmethodID getAccessorsMethodId = env->GetStaticMethodID(clsBinding, "getV8Accessors",
+                                                            "()[Lag/boersego/v8annotations/generated/V8AccessorInfo;");
+
+    // first parse functions
+    jobjectArray functionInfos = (jobjectArray) env->CallStaticObjectMethod(clsBinding,
+                                                                            getFunctionsMethodId);
+    for(jsize idx=0,n=env->GetArrayLength(functionInfos);idx<n;idx++) {
+        jobject functionInfo = env->GetObjectArrayElement(functionInfos, idx);
+        const std::string strFunctionName = JNIWrapper::jstring2string((jstring)env->GetObjectField(functionInfo, _jniV8FunctionInfo.propertyId));
+        const std::string strMethodName = JNIWrapper::jstring2string((jstring)env->GetObjectField(functionInfo, _jniV8FunctionInfo.methodId));
+        const std::string strReturnType = JNIWrapper::jstring2string((jstring)env->GetObjectField(functionInfo, _jniV8FunctionInfo.returnTypeId));
+        jstring signature = (jstring)env->GetObjectField(functionInfo, _jniV8FunctionInfo.signatureId);
+        jobjectArray argumentInfos = (jobjectArray)env->GetObjectField(functionInfo, _jniV8FunctionInfo.argumentsId);
+        std::vector<JNIV8JavaValue>* arguments = nullptr;
+
+        // return type information
+        const JNIV8JavaValue returnType = JNIV8Marshalling::persistentValueWithTypeSignature(strReturnType);
+
+        // collect argument information
+        // the annotation processor provides the signature; it is only assembled here for bindings generated by older versions
+        const bool buildSignature = env->IsSameObject(signature, nullptr);
+        std::string strSignature;
+        if(!buildSignature) {
+            strSignature = JNIWrapper::jstring2string(signature);
+        }
+        if(env->IsSameObject(argumentInfos, nullptr)) {
+            if(buildSignature) {
+                strSignature = "([Ljava/lang/Object;)" + strReturnType;
+            }
+        } else {
+            jsize numArguments = env->GetArrayLength(argumentInfos);
+            if(buildSignature) {
+                strSignature = "(";
+            }
+            // collect arguments
+            // ownership of allocated memory is implicitly transferred to the container!
+            if(numArguments>0) {
+                arguments = new std::vector<JNIV8JavaValue>();
+                arguments->reserve((size_t)numArguments);
+                for(jsize argIdx=0; argIdx<numArguments; argIdx++) {
+                    const jobject argumentInfo = env->GetObjectArrayElement(argumentInfos, argIdx);
+                    const std::string strArgumentType = JNIWrapper::jstring2string((jstring)env->GetObjectField(argumentInfo, _jniV8FunctionArgumentInfo.typeId));
+                    JNIV8MarshallingFlags flags = JNIV8MarshallingFlags::kDefault;
+                    if(!(bool)env->GetBooleanField(argumentInfo, _jniV8FunctionArgumentInfo.isNullableId)) flags = JNIV8MarshallingFlags::kNonNull;
+                    if((bool)env->GetBooleanField(argumentInfo, _jniV8FunctionArgumentInfo.undefinedIsNullId)) flags = (JNIV8MarshallingFlags)(flags|JNIV8MarshallingFlags::kUndefinedIsNull);
+                    JNIV8JavaValue argument = JNIV8Marshalling::persistentArgumentWithTypeSignature(strArgumentType, flags);
+                    arguments->push_back(argument);
+                    if(buildSignature) {
+                        strSignature += strArgumentType;
+                    }
+                    env->DeleteLocalRef(argumentInfo);
+                }
+            }
+            if(buildSignature) {
+                strSignature += ")" + strReturnType;
+            }
+        }
+
+        // resolve the method
+        jmethodID javaMethodId;
+        const bool isStatic = (bool)env->GetBooleanField(functionInfo, _jniV8FunctionInfo.isStaticId);
+        const bool isAsync = (bool)env->GetBooleanField(functionInfo, _jniV8FunctionInfo.isAsyncId);
+        if(isStatic) {
+            javaMethodId = env->GetStaticMethodID(clsObject, strMethodName.c_str(), strSignature.c_str());
+        } else {
+            javaMethodId = env->GetMethodID(clsObject, strMethodName.c_str(), strSignature.c_str());
+        }
+        container->javaMethods.push_back({strFunctionName, javaMethodId, returnType, arguments, isStatic, isAsync});
+
+        env->DeleteLocalRef(argumentInfos);
+        env->DeleteLocalRef(signature);
+        env->DeleteLocalRef(functionInfo);
+    }
+    env->DeleteLocalRef(functionInfos);
+
+    // now parse all property accessors
+    jobjectArray accessorInfos = (jobjectArray) env->CallStaticObjectMethod(clsBinding,
+                                                                            getAccessorsMethodId);
+    for(jsize idx=0,n=env->GetArrayLength(accessorInfos);idx<n;idx++) {
+        jobject accessorInfo = env->GetObjectArrayElement(accessorInfos, idx);
+        const std::string strPropertyType = JNIWrapper::jstring2string((jstring)env->GetObjectField(accessorInfo, _jniV8AccessorInfo.typeId));
+        JNIV8MarshallingFlags flags = JNIV8MarshallingFlags::kDefault;
+        if(!(bool)env->GetBooleanField(accessorInfo, _jniV8AccessorInfo.isNullableId)) flags = JNIV8MarshallingFlags::kNonNull;
+        if((bool)env->GetBooleanField(accessorInfo, _jniV8AccessorInfo.undefinedIsNullId)) flags = (JNIV8MarshallingFlags)(flags|JNIV8MarshallingFlags::kUndefinedIsNull);
+        const JNIV8JavaValue property = JNIV8Marshalling::persistentArgumentWithTypeSignature(strPropertyType, flags);
+
+        const std::string strPropertyName = JNIWrapper::jstring2string((jstring)env->GetObjectField(accessorInfo, _jniV8AccessorInfo.propertyId));
+        const std::string strGetterName = JNIWrapper::jstring2string((jstring)env->GetObjectField(accessorInfo, _jniV8AccessorInfo.getterId));
+        const std::string strSetterName = JNIWrapper::jstring2string((jstring)env->GetObjectField(accessorInfo, _jniV8AccessorInfo.setterId));
+        jmethodID javaGetterId = NULL, javaSetterId = NULL;
+        const bool isStatic = (bool)env->GetBooleanField(accessorInfo, _jniV8AccessorInfo.isStaticId);
+        if(isStatic) {
+            if (!strGetterName.empty()) { javaGetterId = env->GetStaticMethodID(clsObject, strGetterName.c_str(), ("()" + strPropertyType).c_str()); }
+            if (!strSetterName.empty()) { javaSetterId = env->GetStaticMethodID(clsObject, strSetterName.c_str(), ("(" + strPropertyType + ")V").c_str()); }
+        } else {
+            if (!strGetterName.empty()) { javaGetterId = env->GetMethodID(clsObject, strGetterName.c_str(), ("()" + strPropertyType).c_str()); }
+            if (!strSetterName.empty()) { javaSetterId = env->GetMethodID(clsObject, strSetterName.c_str(), ("(" + strPropertyType + ")V").c_str()); }
+        }
+        container->javaAccessors.push_back({strPropertyName, property, javaGetterId, javaSetterId, isStatic});
+
+        env->DeleteLocalRef(accessorInfo);
+    }
+    env->DeleteLocalRef(accessorInfos);
 }
 
 void JNIV8Wrapper::initializeNativeJNIV8Object(jobject obj, jobject engineObj, jlong jsObjPtr) {
+    initJNICaches();
+
     auto v8Object = JNIWrapper::wrapObject<JNIV8Object>(obj);
     auto engine = JNIWrapper::wrapObject<BGJSV8Engine>(engineObj);
     JNI_ASSERT(v8Object && engine, "Invalid parameters");
@@ -372,6 +511,82 @@ void JNIV8Wrapper::_registerObject(JNIV8ObjectType type, const std::string& cano
     _objmap[canonicalName] = info;
 }
 
+JNILocalRef<JNIV8Object> JNIV8Wrapper::_getCachedWrapper(BGJSV8Engine *engine, v8::Local<v8::Object> object, JNIV8WrapperCacheCell **cellOut, jobject *localRef) {
+    Isolate *isolate = engine->getIsolate();
+    Local<Context> context = isolate->GetCurrentContext();
+    Local<Private> privateKey = engine->getWrapperCacheKey();
+
+    JNIV8WrapperCacheCell *cell;
+    Local<Value> privateValue;
+    if(object->GetPrivate(context, privateKey).ToLocal(&privateValue) && privateValue->IsExternal()) {
+        cell = reinterpret_cast<JNIV8WrapperCacheCell*>(privateValue.As<External>()->Value());
+    } else {
+        // the cell must not keep the js object alive, it only lives as long as the object itself
+        cell = new JNIV8WrapperCacheCell();
+        cell->wrapper = nullptr;
+        cell->jsObject.Reset(isolate, object);
+        cell->jsObject.SetWeak(cell, wrapperCacheCellWeakCallback, WeakCallbackType::kParameter);
+        object->SetPrivate(context, privateKey, External::New(isolate, cell));
+    }
+    *cellOut = cell;
+
+    if(!cell->wrapper) {
+        return nullptr;
+    }
+
+    // the weak reference is cleared once the java wrapper was collected, before its native object is disposed
+    // while we are holding the local reference, the native object can not be disposed either
+    JNIEnv *env = JNIWrapper::getEnvironment();
+    jobject wrapper = env->NewLocalRef(cell->wrapper);
+    if(!wrapper) {
+        return nullptr;
+    }
+    auto ptr = JNIWrapper::wrapObject<JNIV8Object>(wrapper);
+
+    // the private is shared by all contexts of the isolate, but a wrapper belongs to the engine that created it
+    if(!ptr || ptr->getEngine() != engine) {
+        env->DeleteLocalRef(wrapper);
+        return nullptr;
+    }
+
+    *localRef = wrapper;
+    return ptr;
+}
+
+void JNIV8Wrapper::_cacheWrapper(JNIV8WrapperCacheCell *cell, JNIV8Object *wrapper) {
+    if(!wrapper) {
+        return;
+    }
+    _wrappersCreated++;
+    if(!cell) {
+        return;
+    }
+
+    // the last created wrapper wins, e.g. if an object was wrapped as a different type before
+    JNIEnv *env = JNIWrapper::getEnvironment();
+    if(cell->wrapper) {
+        env->DeleteWeakGlobalRef(cell->wrapper);
+    }
+    cell->wrapper = env->NewWeakGlobalRef(wrapper->getJObject());
+}
+
+void JNIV8Wrapper::setWrapperCaching(bool enabled) {
+    _cacheWrappers.store(enabled, std::memory_order_relaxed);
+}
+
+bool JNIV8Wrapper::isWrapperCachingEnabled() {
+    return _cacheWrappers.load(std::memory_order_relaxed);
+}
+
+void JNIV8Wrapper::getWrapperStats(uint64_t *created, uint64_t *reused) {
+    if(created) {
+        *created = _wrappersCreated;
+    }
+    if(reused) {
+        *reused = _wrappersReused;
+    }
+}
+
 // persistent classes can also be accessed as JNIV8Object directly!
 template<> JNILocalRef<JNIV8Object> JNIV8Wrapper::wrapObject<JNIV8Object>(v8::Local<v8::Object> object) {
     v8::Local<v8::External> ext;
@@ -393,6 +608,11 @@ template<> JNILocalRef<JNIV8Object> JNIV8Wrapper::wrapObject<JNIV8Object>(v8::Lo
  * internal helper function called by V8Engine on destruction
  */
 void JNIV8Wrapper::cleanupV8Engine(BGJSV8Engine *engine) {
+    if(engine->_debug) {
+        LOGD("wrapper objects: %llu created, %llu reused", (unsigned long long)_wrappersCreated.load(),
+             (unsigned long long)_wrappersReused.load());
+    }
+
     pthread_mutex_lock(&_mutexEnv);
     for(auto it : _objmap) {
         for (auto it2 = it.second->classInfos.begin(); it2 != it.second->classInfos.end(); ++it2) {
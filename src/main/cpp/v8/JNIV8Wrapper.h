@@ -10,12 +10,25 @@
 
 #include "../jni/jni.h"
 
+#include <atomic>
+#include <mutex>
+
 #include "JNIV8Object.h"
 
+struct JNIV8WrapperCacheCell;
+
 class JNIV8Wrapper {
 public:
     static void init();
 
+    /**
+     * resolves the cached JNI class references and ids of all v8 related classes
+     * this is done on demand when the first engine or object is initialized;
+     * calling it ahead of time (e.g. from a background thread) takes the cost off the thread that creates the first engine
+     * safe to call from multiple threads and multiple times
+     */
+    static void initJNICaches();
+
     /**
      * returns the canonical name of the v8 enabled java class associated with the specified native object
      */
@@ -42,6 +55,7 @@ public:
         JNIWrapper::registerObject<ObjectType, JNIV8Object>(type == JNIV8ObjectType::kAbstract ? JNIObjectType::kAbstract : JNIObjectType::kPersistent);
         _registerObject(type, JNIBase::getCanonicalName<ObjectType>(), JNIBase::getCanonicalName<JNIV8Object>(),
                         type == JNIV8ObjectType::kWrapper ? nullptr : initialize<ObjectType>, createJavaClass<ObjectType>, sizeof(ObjectType));
+        _getContainer<ObjectType>();
     };
 
     /**
@@ -55,6 +69,7 @@ public:
         JNIWrapper::registerObject<ObjectType, BaseObjectType>(type == JNIV8ObjectType::kAbstract ? JNIObjectType::kAbstract : JNIObjectType::kPersistent);
         _registerObject(type, JNIBase::getCanonicalName<ObjectType>(), JNIBase::getCanonicalName<BaseObjectType>(),
                         type == JNIV8ObjectType::kWrapper ? nullptr : initialize<ObjectType>, createJavaClass<ObjectType>, sizeof(ObjectType));
+        _getContainer<ObjectType>();
     };
 
     /**
@@ -113,8 +128,8 @@ public:
      */
     template <typename ObjectType> static
     JNILocalRef<ObjectType> wrapObject(v8::Local<v8::Object> object) {
-        auto it = _objmap.find(JNIBase::getCanonicalName<ObjectType>());
-        if (it == _objmap.end()){
+        JNIV8ClassInfoContainer *info = _getContainer<ObjectType>();
+        if (!info){
             return nullptr;
         }
 
@@ -126,32 +141,29 @@ public:
         // we still need a handle scope however...
         v8::HandleScope scope(isolate);
 
-        JNIV8ClassInfoContainer *info = it->second;
-
         if(info->type == JNIV8ObjectType::kWrapper) {
-            /*
-            // does the object have a native object stored in a private key?
-            auto privateKey = v8::Private::ForApi(isolate, v8::String::NewFromUtf8(isolate, _v8PrivateKey));
-            auto privateValue = object->GetPrivate(isolate->GetCurrentContext(), privateKey);
-            if (!privateValue.IsEmpty()) {
-                ext = privateValue.ToLocalChecked().As<v8::External>();
-            } else {
-                // the private key was empty so we have to create a new object
-                v8::Persistent<v8::Object>* persistent = new v8::Persistent<v8::Object>(isolate, object);
-                auto sharedPtr = info->creator(_getV8ClassInfo(JNIBase::getCanonicalName<ObjectType>(), BGJSV8Engine::GetInstance(isolate)), persistent);
-
-                // store in private
-                object->SetPrivate(isolate->GetCurrentContext(), privateKey, v8::External::New(isolate, sharedPtr.get()));
-
-                return std::static_pointer_cast<ObjectType>(sharedPtr);
+            BGJSV8Engine *engine = BGJSV8Engine::GetInstance(isolate);
+            // if enabled, wrapping the same js object again yields the same wrapper, as long as the java side is still alive
+            JNIV8WrapperCacheCell *cell = nullptr;
+            if(_cacheWrappers.load(std::memory_order_relaxed)) {
+                jobject cachedRef;
+                JNILocalRef<JNIV8Object> cached = _getCachedWrapper(engine, object, &cell, &cachedRef);
+                if(cached) {
+                    if(JNIWrapper::isObjectInstanceOf<ObjectType>(cached.get())) {
+                        _wrappersReused++;
+                        return JNILocalRef<ObjectType>::Cast(cached);
+                    }
+                    JNIWrapper::getEnvironment()->DeleteLocalRef(cachedRef);
+                }
             }
-             */
-            // a new wrapper object is created every time!
+            // otherwise a new wrapper object is created and remembered in the cache
             v8::Persistent<v8::Object>* persistent = new v8::Persistent<v8::Object>(isolate, object);
             JNIEnv *env = JNIWrapper::getEnvironment();
             jobjectArray arguments = env->NewObjectArray(0, _jniObject.clazz, nullptr);
             // __android_log_print(ANDROID_LOG_WARN, "JNIV8Wrapper", "Creating %s", JNIBase::getCanonicalName<ObjectType>().c_str());
-            return JNILocalRef<ObjectType>::Cast(info->creator(_getV8ClassInfo(JNIBase::getCanonicalName<ObjectType>(), BGJSV8Engine::GetInstance(isolate)), persistent, arguments));
+            JNILocalRef<JNIV8Object> wrapper = info->creator(_getV8ClassInfo(info, engine), engine, persistent, arguments);
+            _cacheWrapper(cell, wrapper.get());
+            return JNILocalRef<ObjectType>::Cast(wrapper);
         } else {
             if (object->InternalFieldCount() >= 1) {
                 // does the object have internal fields? if so use it!
@@ -169,11 +181,17 @@ public:
     };
 
     /**
-     * retrieves the JNIV8ClassInfo for a native class in the specified engine
+     * retrieves the JS constructor of a native class in the current context of the specified engine
+     * returns an empty handle if the class is not registered
      */
     template <typename ObjectType> static
     v8::Local<v8::Function> getJSConstructor(BGJSV8Engine *engine) {
-        return _getV8ClassInfo(JNIBase::getCanonicalName<ObjectType>(), engine)->getConstructor();
+        JNIV8ClassInfoContainer *container = _getContainer<ObjectType>();
+        JNI_ASSERTF(container, "Attempt to retrieve constructor of unregistered class: %s", JNIBase::getCanonicalName<ObjectType>().c_str());
+        if(!container) {
+            return v8::Local<v8::Function>();
+        }
+        return _getV8ClassInfo(container, engine)->getConstructor();
     }
     static v8::Local<v8::Function> getJSConstructor(BGJSV8Engine *engine, const std::string &canonicalName) {
         return _getV8ClassInfo(canonicalName, engine)->getConstructor();
@@ -195,15 +213,61 @@ public:
      * internal helper function called by V8Engine on destruction
      */
     static void cleanupV8Engine(BGJSV8Engine *engine);
-private:
-    //static const char* _v8PrivateKey;
 
+    /**
+     * returns how many wrapper objects (kWrapper types) were created, and how often an existing one was reused
+     * since the library was loaded
+     */
+    static void getWrapperStats(uint64_t *created, uint64_t *reused);
+
+    /**
+     * if enabled, wrapping a js object that already has a live java wrapper returns that wrapper instead of a new one
+     * disabled by default: callers then share the wrapper and must not dispose it
+     */
+    static void setWrapperCaching(bool enabled);
+    static bool isWrapperCachingEnabled();
+private:
+    static void _initJNICaches();
     static void _registerObject(JNIV8ObjectType type, const std::string& canonicalName, const std::string& baseCanonicalName, JNIV8ObjectInitializer i, JNIV8ObjectCreator c, size_t size);
     static JNIV8ClassInfo* _getV8ClassInfo(const std::string& canonicalName, BGJSV8Engine *engine);
+    static JNIV8ClassInfo* _getV8ClassInfo(JNIV8ClassInfoContainer *container, BGJSV8Engine *engine);
+    static void _materializeV8ClassInfo(JNIV8ClassInfo *info);
+    static void _parseJavaBinding(JNIV8ClassInfoContainer *container);
 
     static std::map<std::string, JNIV8ClassInfoContainer*> _objmap;
+    static std::atomic<JNIV8ClassInfoContainer*> _slots[JNITypeSlot::kMaxSlots];
+
+    /**
+     * looks up the wrapper cached for a js object; returns nullptr if there is none or it was already collected
+     * the cache cell of the object is returned in any case, and created if necessary
+     * a found wrapper is kept alive by a new local reference (like a newly created one by the reference NewObject returned);
+     * it is stored in localRef and has to be deleted by the caller if the wrapper is not used
+     */
+    static JNILocalRef<JNIV8Object> _getCachedWrapper(BGJSV8Engine *engine, v8::Local<v8::Object> object, JNIV8WrapperCacheCell **cell, jobject *localRef);
+    /**
+     * counts a created wrapper and remembers it in the cache cell, if there is one
+     */
+    static void _cacheWrapper(JNIV8WrapperCacheCell *cell, JNIV8Object *wrapper);
+    static std::atomic<uint64_t> _wrappersCreated, _wrappersReused;
+    static std::atomic<bool> _cacheWrappers;
+
+    /**
+     * returns the container registered for a native type, or nullptr if it is not registered
+     * the container is cached in the types slot; the canonical name is only built the first time
+     */
+    template<class ObjectType> static
+    JNIV8ClassInfoContainer* _getContainer() {
+        const size_t slot = JNITypeSlot::get<ObjectType>();
+        if(slot < JNITypeSlot::kMaxSlots) {
+            JNIV8ClassInfoContainer *container = _slots[slot].load(std::memory_order_acquire);
+            if(container) return container;
+        }
+        return _resolveSlot(slot, JNIBase::getCanonicalName<ObjectType>());
+    }
+    static JNIV8ClassInfoContainer* _resolveSlot(size_t slot, const std::string& canonicalName);
 
     static pthread_mutex_t _mutexEnv;
+    static std::once_flag _jniCacheFlag;
 
     template<class ObjectType>
     static void initialize(JNIV8ClassInfo *info) {
@@ -211,8 +275,8 @@ private:
     }
 
     template<class ObjectType>
-    static JNILocalRef<JNIV8Object> createJavaClass(JNIV8ClassInfo *info, v8::Persistent<v8::Object> *jsObj, jobjectArray arguments) {
-        return JNILocalRef<JNIV8Object>::Cast(JNIV8Wrapper::createDerivedObject<ObjectType>(info->container->canonicalName, "<JNIV8ObjectInit>", info->engine->getJObject(), (jlong)(void*)jsObj, arguments));
+    static JNILocalRef<JNIV8Object> createJavaClass(JNIV8ClassInfo *info, BGJSV8Engine *engine, v8::Persistent<v8::Object> *jsObj, jobjectArray arguments) {
+        return JNILocalRef<JNIV8Object>::Cast(JNIV8Wrapper::createDerivedObject<ObjectType>(info->container->canonicalName, "<JNIV8ObjectInit>", engine->getJObject(), (jlong)(void*)jsObj, arguments));
     }
     
     // cache of classes + ids
@@ -224,7 +288,9 @@ private:
         jfieldID propertyId;
         jfieldID methodId;
         jfieldID isStaticId;
+        jfieldID isAsyncId;
         jfieldID returnTypeId;
+        jfieldID signatureId;
         jfieldID argumentsId;
     } _jniV8FunctionInfo;
     static struct {
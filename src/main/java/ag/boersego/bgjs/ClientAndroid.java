@@ -12,11 +12,50 @@ import android.content.res.AssetManager;
 
 public class ClientAndroid {
 	// BGJSV8Engine
-	public static native void timeoutCB(V8Engine engine, long jsCb, long thisObj, boolean cleanup, boolean runCallback);
+	/**
+	 * @return false if the callback was not run because it would delay the next animation frame
+	 */
+	public static native boolean timeoutCB(V8Engine engine, long jsCb, long thisObj, boolean cleanup, boolean runCallback);
 
-	public static native void initialize(AssetManager am, V8Engine engine, String locale, String lang, String timezone, float density, final String deviceClass, final boolean debug);
+	public static native void initialize(AssetManager am, V8Engine engine, String locale, String lang, String timezone, float density, final String deviceClass, final boolean debug, V8Engine isolateHost);
+
+	public static native void prewarm();
 
     public static native void runCBBoolean (V8Engine engine, long cbPtr, long thisPtr, boolean b);
+
+	/**
+	 * Run a batch of callbacks with a single transition into JS, see V8CallbackBatch
+	 * result receives the number of records that ran (the remaining ones were deferred to the next frame)
+	 * and the number of records whose callback threw; the first exception is rethrown after all records ran
+	 */
+	public static native void runCallbackBatch(V8Engine engine, int count, int[] types, long[] pointers, int[] values, Object[] payloads, int[] result);
+
+	// frame scheduler, see V8FrameStats
+	public static native void setFrameBudget(V8Engine engine, double budgetMs);
+	public static native void getFrameStats(V8Engine engine, double[] stats);
+
+	/**
+	 * Release a batch of the java references collected by the gc and pass canvas memory on to it
+	 * @return true if references are still waiting, because the batch was deferred or did not cover all of them
+	 */
+	public static native boolean runIdleWork(V8Engine engine);
+
+	/**
+	 * Invoke the java method of an async JS call on the current (executor) thread.
+	 * The result is kept with the call until it is delivered with V8CallbackBatch.addAsyncJavaCall
+	 */
+	public static native void runAsyncJavaCall(long callPtr);
+
+	/**
+	 * Release an async JS call whose result will not be delivered, because its engine shut down.
+	 * The promise is never settled.
+	 */
+	public static native void dropAsyncJavaCall(long callPtr);
+
+	/**
+	 * Release the context of an engine and all objects it keeps alive. Called on the engine thread right before it ends.
+	 */
+	public static native void shutdownEngine(V8Engine engine);
 	
     // AjaxModule
 	public static native boolean ajaxDone(V8Engine engine, String data, int responseCode, long jsCbPtr, long thisObj,
@@ -0,0 +1,31 @@
+package ag.boersego.bgjs;
+
+/**
+ * Controls how native code keeps java objects alive.
+ *
+ * By default every java object that native code holds on to - retained JNIObjects, handlers of JNIV8Functions and
+ * java exceptions passed through javascript - is kept alive by a JNI global reference. The number of global
+ * references is limited, and creating or deleting one takes a lock of the vm.
+ * With the handle table enabled these objects are stored in a single java array instead, and native code only keeps
+ * their index. Retaining and releasing becomes an array store, at the cost of an extra lookup when a handler is called.
+ *
+ * The mode applies to references created after it was changed; existing references keep working either way.
+ * Enable it before creating the first engine to cover all references.
+ */
+final public class JNIHandleTable {
+    static {
+        System.loadLibrary("bgjs");
+    }
+
+    public static native void setEnabled(boolean enabled);
+
+    public static native boolean isEnabled();
+
+    /**
+     * returns the number of objects currently kept alive by the table
+     */
+    public static native int getSize();
+
+    private JNIHandleTable() {
+    }
+}
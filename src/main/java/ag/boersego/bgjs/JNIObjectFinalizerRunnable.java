@@ -7,9 +7,15 @@ import java.lang.ref.ReferenceQueue;
 
 /**
  * Running in the FinalizingDaemon thread (managed by JNIObject) to free native objects.
+ * References are collected in batches: the thread blocks until one is enqueued, then takes everything else
+ * that is already waiting (up to BATCH_SIZE) and frees all of them with a single native call.
  */
 final class JNIObjectFinalizerRunnable implements Runnable {
+    private static final int BATCH_SIZE = 64;
+
     private ReferenceQueue<JNIObject> referenceQueue;
+    private final JNIObjectReference[] batch = new JNIObjectReference[BATCH_SIZE];
+    private final long[] handles = new long[BATCH_SIZE];
 
     JNIObjectFinalizerRunnable(ReferenceQueue<JNIObject> referenceQueue) {
         this.referenceQueue = referenceQueue;
@@ -19,9 +25,21 @@ final class JNIObjectFinalizerRunnable implements Runnable {
     public void run() {
         while (true) {
             try {
-                JNIObjectReference reference = (JNIObjectReference) referenceQueue.remove();
-                if(!reference.cleanup()) {
-                    Log.e("JNIObject", "GCd JNIObject failed to free native resources");
+                int count = 0;
+                batch[count++] = (JNIObjectReference) referenceQueue.remove();
+                Reference<? extends JNIObject> reference;
+                while (count < BATCH_SIZE && (reference = referenceQueue.poll()) != null) {
+                    batch[count++] = (JNIObjectReference) reference;
+                }
+
+                final int failed = JNIObjectReference.cleanup(batch, handles, count);
+                if (failed > 0) {
+                    Log.e("JNIObject", failed + " GCd JNIObject(s) failed to free native resources");
+                }
+
+                // do not keep the references reachable until the next batch
+                for (int i = 0; i < count; i++) {
+                    batch[i] = null;
                 }
             } catch (InterruptedException e) {
                 // Restores the interrupted status.
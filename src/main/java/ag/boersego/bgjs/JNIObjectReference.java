@@ -34,6 +34,17 @@ final class JNIObjectReference extends PhantomReference<JNIObject> {
             length++;
         }
 
+        /**
+         * removes all references whose native object was disposed (handle set to 0) under a single lock
+         */
+        synchronized void removeDisposed(JNIObjectReference[] refs, long[] handles, int count) {
+            for (int i = 0; i < count; i++) {
+                if (handles[i] == 0) {
+                    remove(refs[i]);
+                }
+            }
+        }
+
         synchronized void remove(JNIObjectReference ref) {
             JNIObjectReference next = ref.next;
             JNIObjectReference prev = ref.prev;
@@ -56,7 +67,11 @@ final class JNIObjectReference extends PhantomReference<JNIObject> {
 
     private static ReferencePool referencePool = new ReferencePool();
 
-    protected static native boolean disposeNative(long nativeHandle);
+    /**
+     * deletes the native objects of the specified handles; handles of deleted objects are set to 0,
+     * objects that are still retained by native code are skipped
+     */
+    protected static native void disposeNatives(long[] nativeHandles, int count);
 
     public JNIObjectReference(JNIObject obj, long nativeHandle, ReferenceQueue<JNIObject> referenceQueue) {
         super(obj, referenceQueue);
@@ -65,14 +80,35 @@ final class JNIObjectReference extends PhantomReference<JNIObject> {
     }
 
     public boolean cleanup() {
-        if(!disposeNative(nativeHandle)) return false;
+        final JNIObjectReference[] refs = {this};
+        return cleanup(refs, new long[1], 1) == 0;
+    }
+
+    /**
+     * frees the native objects of a batch of references with a single native call
+     * @param handles buffer for the native handles, at least count long
+     * @return the number of references whose native object could not be freed
+     */
+    static int cleanup(JNIObjectReference[] refs, long[] handles, int count) {
+        for (int i = 0; i < count; i++) {
+            handles[i] = refs[i].nativeHandle;
+        }
+        disposeNatives(handles, count);
+
+        referencePool.removeDisposed(refs, handles, count);
 
-        referencePool.remove(this);
-        clear();
+        int failed = 0;
+        for (int i = 0; i < count; i++) {
+            if (handles[i] == 0) {
+                refs[i].clear();
+            } else {
+                failed++;
+            }
+        }
 
         if(referencePool.length == 0) {
             Log.d("JNIObject", "reference pool was completely drained!");
         }
-        return true;
+        return failed;
     }
 };
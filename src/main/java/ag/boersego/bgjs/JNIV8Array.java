@@ -9,6 +9,8 @@ import ag.boersego.v8annotations.V8Flags;
 
 /**
  * Created by martin on 26.09.17.
+ *
+ * Wraps a javascript array, or a typed array if enabled with setTypedArrayWrapping
  */
 
 final public class JNIV8Array extends JNIV8Object implements Iterable<Object> {
@@ -19,6 +21,14 @@ final public class JNIV8Array extends JNIV8Object implements Iterable<Object> {
         return CreateWithArray(engine, elements);
     }
 
+    /**
+     * Pass typed arrays to java as JNIV8Array instead of JNIV8GenericObject, so the bulk element methods can be used on them.
+     * Disabled by default; applies to values converted after it was changed.
+     */
+    public static native void setTypedArrayWrapping(boolean enabled);
+
+    public static native boolean isTypedArrayWrappingEnabled();
+
     public boolean isEmpty() {
         return getV8Length() == 0;
     }
@@ -60,6 +70,28 @@ final public class JNIV8Array extends JNIV8Object implements Iterable<Object> {
         return (T[]) _getV8Elements(V8Flags.Default, returnType.hashCode(), returnType, from, to);
     }
 
+    /**
+     * Returns all elements from a specified range inside of the array as a primitive array, without boxing them
+     * Typed arrays of the matching type (Float64Array, Float32Array, Int32Array) are copied directly from their backing store.
+     * Other elements have to be numbers (booleans for getV8ElementsAsBooleans), any other value throws a TypeError;
+     * floats are rounded to the nearest representable value.
+     */
+    public native @NonNull double[] getV8ElementsAsDoubles(int from, int to);
+    public native @NonNull float[] getV8ElementsAsFloats(int from, int to);
+    public native @NonNull int[] getV8ElementsAsInts(int from, int to);
+    public native @NonNull long[] getV8ElementsAsLongs(int from, int to);
+    public native @NonNull boolean[] getV8ElementsAsBooleans(int from, int to);
+
+    /**
+     * Copies all elements of a primitive array into the array, starting at the specified index
+     * Arrays grow as needed, for typed arrays the elements have to fit into the existing length.
+     */
+    public native void setV8Elements(int index, @NonNull double[] elements);
+    public native void setV8Elements(int index, @NonNull float[] elements);
+    public native void setV8Elements(int index, @NonNull int[] elements);
+    public native void setV8Elements(int index, @NonNull long[] elements);
+    public native void setV8Elements(int index, @NonNull boolean[] elements);
+
     /**
      * Returns the object at the specified index
      * if index is out of bounds, returns JNIV8Undefined
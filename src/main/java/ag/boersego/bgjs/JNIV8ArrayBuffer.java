@@ -0,0 +1,61 @@
+package ag.boersego.bgjs;
+
+import android.support.annotation.NonNull;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+/**
+ * Wraps a javascript ArrayBuffer
+ *
+ * The memory of an ArrayBuffer is shared with java without copying it:
+ * - CreateWithByteBuffer uses the memory of a direct ByteBuffer. Java stays the owner of the memory; the ByteBuffer is
+ *   kept alive until the ArrayBuffer was collected by javascript. Call neuter() to take the memory away from javascript
+ *   before reusing it for something else. Direct ByteBuffers passed to javascript as arguments or fields are shared the same way;
+ *   passing the same ByteBuffer again results in the same ArrayBuffer as long as it was not neutered.
+ * - getByteBuffer returns a direct ByteBuffer pointing to the memory of the ArrayBuffer. The ArrayBuffer is kept alive
+ *   until the returned ByteBuffer was collected; this is noticed at the next idle point of the engine.
+ *
+ * The memory of an ArrayBuffer is never moved by the garbage collector, so it can be accessed from any thread.
+ * Accesses from java and javascript are not synchronized however, the caller has to make sure that they do not overlap.
+ */
+final public class JNIV8ArrayBuffer extends JNIV8Object {
+    public static native JNIV8ArrayBuffer Create(V8Engine engine, int byteLength);
+
+    /**
+     * creates an ArrayBuffer that uses the memory of the whole capacity of the specified buffer
+     * @throws IllegalArgumentException if the buffer is not direct
+     */
+    public static native JNIV8ArrayBuffer CreateWithByteBuffer(V8Engine engine, @NonNull ByteBuffer buffer);
+
+    /**
+     * returns the length of the buffer in bytes; 0 if it was neutered
+     */
+    public native int getByteLength();
+
+    /**
+     * returns a direct ByteBuffer pointing to the memory of the ArrayBuffer, in native byte order like typed arrays use it
+     * the returned buffer must not be used after the ArrayBuffer was neutered or the engine was shut down
+     */
+    public @NonNull ByteBuffer getByteBuffer() {
+        return _getByteBuffer().order(ByteOrder.nativeOrder());
+    }
+
+    /**
+     * detaches the memory from javascript; the ArrayBuffer and all its views have a length of 0 afterwards
+     * @throws IllegalStateException if the memory is owned by v8, i.e. the buffer was not created from a ByteBuffer
+     */
+    public native void neuter();
+
+    public void dispose() throws RuntimeException {
+        super.dispose();
+    }
+
+    //------------------------------------------------------------------------
+    // internal fields & methods
+    private native ByteBuffer _getByteBuffer();
+
+    protected JNIV8ArrayBuffer(V8Engine engine, long jsObjPtr, Object[] arguments) {
+        super(engine, jsObjPtr, arguments);
+    }
+}
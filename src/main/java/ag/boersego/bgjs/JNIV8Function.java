@@ -15,8 +15,48 @@ final public class JNIV8Function extends JNIV8Object {
         Object Callback(Object receiver, Object[] arguments);
     }
 
+    /*
+     * typed handlers receive their arguments as primitives and are called without allocating an Object[] or boxing values;
+     * arguments are coerced the way javascript would do it (e.g. a missing argument is NaN for a double)
+     * each of them has its own factory method, so that lambdas passed to Create always resolve to Handler
+     */
+    public interface UnaryDoubleHandler {
+        double Callback(double value);
+    }
+
+    public interface BinaryDoubleHandler {
+        double Callback(double a, double b);
+    }
+
+    public interface IntHandler {
+        void Callback(int value);
+    }
+
+    /**
+     * null and undefined are passed as null, everything else is converted using the javascript "toString" method
+     */
+    public interface StringHandler {
+        Object Callback(String value);
+    }
+
     public static native JNIV8Function Create(V8Engine engine, JNIV8Function.Handler handler);
 
+    public static JNIV8Function CreateUnaryDouble(V8Engine engine, JNIV8Function.UnaryDoubleHandler handler) {
+        return _createTyped(engine, handler);
+    }
+
+    public static JNIV8Function CreateBinaryDouble(V8Engine engine, JNIV8Function.BinaryDoubleHandler handler) {
+        return _createTyped(engine, handler);
+    }
+
+    public static JNIV8Function CreateInt(V8Engine engine, JNIV8Function.IntHandler handler) {
+        return _createTyped(engine, handler);
+    }
+
+    public static JNIV8Function CreateString(V8Engine engine, JNIV8Function.StringHandler handler) {
+        return _createTyped(engine, handler);
+    }
+
     public @Nullable Object callAsV8Function(@Nullable Object... arguments) {
         return _callAsV8Function(false, 0, 0, Object.class,null, arguments);
     }
@@ -89,6 +129,7 @@ final public class JNIV8Function extends JNIV8Object {
 
     //------------------------------------------------------------------------
     // internal fields & methods
+    private static native JNIV8Function _createTyped(V8Engine engine, Object handler);
     private native Object _callAsV8Function(boolean asConstructor, int flags, int type, Class returnType, Object receiver, Object... arguments);
 
     protected JNIV8Function(V8Engine engine, long jsObjPtr, Object[] arguments) {
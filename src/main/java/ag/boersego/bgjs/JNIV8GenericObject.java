@@ -11,6 +11,9 @@ import java.util.Map;
 final public class JNIV8GenericObject extends JNIV8Object {
     public static native JNIV8GenericObject Create(V8Engine engine);
 
+    /**
+     * releases the native side right away; must not be used if wrapper caching is enabled, see JNIV8Object.setWrapperCaching
+     */
     public void dispose() throws RuntimeException {
         super.dispose();
     }
@@ -30,10 +30,61 @@ abstract public class JNIV8Object extends JNIObject {
 
     static private native void RegisterV8Class(String derivedClass, String baseClass);
 
+    /**
+     * Pass the existing wrapper (JNIV8GenericObject, JNIV8Array, JNIV8Function) to java when a JS object is converted
+     * again while its previous wrapper is still alive, instead of creating a new one.
+     * Disabled by default. If enabled, callers share wrappers and must not dispose() them.
+     */
+    public static native void setWrapperCaching(boolean enabled);
+
+    public static native boolean isWrapperCachingEnabled();
+
+    /**
+     * @return the number of wrappers created and the number of wrappers reused from the cache since the library was loaded
+     */
+    public static native long[] getWrapperStats();
+
     public native double toNumber();
     public native String toString();
     public native String toJSON();
 
+    /**
+     * serializes the object and everything reachable from it with v8::ValueSerializer in a single native call
+     * the result can be decoded with V8ValueCodec or passed to V8Engine.deserialize
+     * @throws V8Exception if the object graph contains values that can not be cloned, e.g. functions or native objects
+     */
+    public native @NonNull byte[] serialize();
+
+    /**
+     * assigns all own fields of a serialized object to this object in a single native call
+     * @see V8ValueCodec#encode(Object)
+     * @throws IllegalArgumentException if the data does not contain an object
+     */
+    public native void setV8FieldsSerialized(@NonNull byte[] data);
+
+    /**
+     * returns all fields of the object as plain java values, converting nested objects and arrays as well
+     * unlike getV8Fields the result is independent of the engine and needs a single native call for the whole graph
+     * @see V8ValueCodec#decode(byte[])
+     */
+    @SuppressWarnings({"unchecked"})
+    public @NonNull Map<String,Object> getV8FieldsDeep() {
+        final Object result = V8ValueCodec.decode(serialize());
+        if (!(result instanceof Map)) {
+            throw new IllegalStateException("Object can not be converted to a map");
+        }
+        return (Map<String,Object>) result;
+    }
+
+    /**
+     * assigns fields from plain java values, converting nested maps and lists to objects and arrays
+     * the whole map is transferred in a single native call
+     * @see V8ValueCodec#encode(Object)
+     */
+    public void setV8FieldsDeep(@NonNull Map<String, ?> fields) {
+        setV8FieldsSerialized(V8ValueCodec.encode(fields));
+    }
+
     public V8Engine getV8Engine() {
         return _engine;
     }
@@ -52,6 +103,18 @@ abstract public class JNIV8Object extends JNIObject {
 
     private native Object _applyV8Method(@NonNull String name, int flags, int type, Class returnType, Object[] arguments);
 
+    public @Nullable Object applyV8Method(@NonNull V8Key key, Object[] arguments) {
+        return _applyV8MethodByKey(checkKey(key), 0, 0, Object.class, arguments);
+    }
+    @SuppressWarnings({"unchecked"})
+    public @Nullable <T> T applyV8MethodTyped(@NonNull V8Key key, int flags, @NonNull Class<T> returnType, @NonNull Object[] arguments) {
+        return (T) _applyV8MethodByKey(checkKey(key), flags, returnType.hashCode(), returnType, arguments);
+    }
+    @SuppressWarnings({"unchecked"})
+    public @Nullable <T> T applyV8MethodTyped(@NonNull V8Key key, @NonNull Class<T> returnType, @NonNull Object[] arguments) {
+        return (T) _applyV8MethodByKey(checkKey(key), V8Flags.Default, returnType.hashCode(), returnType, arguments);
+    }
+
     public @Nullable Object callV8Method(@NonNull String name, Object... arguments) {
         return _applyV8Method(name, 0, 0, Object.class, arguments);
     }
@@ -64,6 +127,18 @@ abstract public class JNIV8Object extends JNIObject {
         return (T) _applyV8Method(name, V8Flags.Default, returnType.hashCode(), returnType, arguments);
     }
 
+    public @Nullable Object callV8Method(@NonNull V8Key key, Object... arguments) {
+        return _applyV8MethodByKey(checkKey(key), 0, 0, Object.class, arguments);
+    }
+    @SuppressWarnings({"unchecked"})
+    public @Nullable <T> T callV8MethodTyped(@NonNull V8Key key, int flags, @NonNull Class<T> returnType, @Nullable Object... arguments) {
+        return (T) _applyV8MethodByKey(checkKey(key), flags, returnType.hashCode(), returnType, arguments);
+    }
+    @SuppressWarnings({"unchecked"})
+    public @Nullable <T> T callV8MethodTyped(@NonNull V8Key key, @NonNull Class<T> returnType, @Nullable Object... arguments) {
+        return (T) _applyV8MethodByKey(checkKey(key), V8Flags.Default, returnType.hashCode(), returnType, arguments);
+    }
+
     public @Nullable Object getV8Field(@NonNull String name) {
         return _getV8Field(name, 0, 0, Object.class);
     }
@@ -77,12 +152,30 @@ abstract public class JNIV8Object extends JNIObject {
     }
     private native Object _getV8Field(String name, int flags, int type, Class returnType);
 
+    public @Nullable Object getV8Field(@NonNull V8Key key) {
+        return _getV8FieldByKey(checkKey(key), 0, 0, Object.class);
+    }
+    @SuppressWarnings({"unchecked"})
+    public @Nullable <T> T getV8FieldTyped(@NonNull V8Key key, int flags, @NonNull Class<T> returnType) {
+        return (T) _getV8FieldByKey(checkKey(key), flags, returnType.hashCode(), returnType);
+    }
+    @SuppressWarnings({"unchecked"})
+    public @Nullable <T> T getV8FieldTyped(@NonNull V8Key key, @NonNull Class<T> returnType) {
+        return (T) _getV8FieldByKey(checkKey(key), V8Flags.Default, returnType.hashCode(), returnType);
+    }
+
     public boolean hasV8Field(@NonNull String name) {
         return hasV8Field(name, false);
     }
     public boolean hasV8OwnField(@NonNull String name) {
         return hasV8Field(name, true);
     }
+    public boolean hasV8Field(@NonNull V8Key key) {
+        return _hasV8FieldByKey(checkKey(key), false);
+    }
+    public boolean hasV8OwnField(@NonNull V8Key key) {
+        return _hasV8FieldByKey(checkKey(key), true);
+    }
 
     public @NonNull String[] getV8Keys() {
         return getV8Keys(false);
@@ -117,6 +210,112 @@ abstract public class JNIV8Object extends JNIObject {
 
     public native void setV8Field(@NonNull String name, @Nullable Object value);
     public native void setV8Fields(@NonNull Map< String, Object> fields);
+    public void setV8Field(@NonNull V8Key key, @Nullable Object value) {
+        _setV8FieldByKey(checkKey(key), value);
+    }
+
+    /**
+     * Returns the values of the specified fields, in the order of the names
+     * All fields are read within a single native call, which is a lot cheaper than reading them one by one.
+     */
+    public @NonNull Object[] getV8Fields(@NonNull String[] names) {
+        return _getV8FieldArray(names, null, 0, 0, Object.class);
+    }
+    @SuppressWarnings({"unchecked"})
+    public @NonNull <T> T[] getV8FieldsTyped(@NonNull String[] names, int flags, @NonNull Class<T> returnType) {
+        return (T[]) _getV8FieldArray(names, null, flags, returnType.hashCode(), returnType);
+    }
+    @SuppressWarnings({"unchecked"})
+    public @NonNull <T> T[] getV8FieldsTyped(@NonNull String[] names, @NonNull Class<T> returnType) {
+        return (T[]) _getV8FieldArray(names, null, V8Flags.Default, returnType.hashCode(), returnType);
+    }
+    public @NonNull Object[] getV8Fields(@NonNull V8Key[] keys) {
+        return _getV8FieldArray(null, checkKeys(keys), 0, 0, Object.class);
+    }
+    @SuppressWarnings({"unchecked"})
+    public @NonNull <T> T[] getV8FieldsTyped(@NonNull V8Key[] keys, int flags, @NonNull Class<T> returnType) {
+        return (T[]) _getV8FieldArray(null, checkKeys(keys), flags, returnType.hashCode(), returnType);
+    }
+    @SuppressWarnings({"unchecked"})
+    public @NonNull <T> T[] getV8FieldsTyped(@NonNull V8Key[] keys, @NonNull Class<T> returnType) {
+        return (T[]) _getV8FieldArray(null, checkKeys(keys), V8Flags.Default, returnType.hashCode(), returnType);
+    }
+
+    /**
+     * Returns the values of the specified fields as a primitive array, without boxing them
+     * Values are converted like the elements in JNIV8Array.getV8ElementsAsDoubles etc.
+     */
+    public @NonNull double[] getV8FieldsAsDoubles(@NonNull String[] names) {
+        return _getV8FieldsAsDoubles(names, null);
+    }
+    public @NonNull float[] getV8FieldsAsFloats(@NonNull String[] names) {
+        return _getV8FieldsAsFloats(names, null);
+    }
+    public @NonNull int[] getV8FieldsAsInts(@NonNull String[] names) {
+        return _getV8FieldsAsInts(names, null);
+    }
+    public @NonNull long[] getV8FieldsAsLongs(@NonNull String[] names) {
+        return _getV8FieldsAsLongs(names, null);
+    }
+    public @NonNull boolean[] getV8FieldsAsBooleans(@NonNull String[] names) {
+        return _getV8FieldsAsBooleans(names, null);
+    }
+    public @NonNull double[] getV8FieldsAsDoubles(@NonNull V8Key[] keys) {
+        return _getV8FieldsAsDoubles(null, checkKeys(keys));
+    }
+    public @NonNull float[] getV8FieldsAsFloats(@NonNull V8Key[] keys) {
+        return _getV8FieldsAsFloats(null, checkKeys(keys));
+    }
+    public @NonNull int[] getV8FieldsAsInts(@NonNull V8Key[] keys) {
+        return _getV8FieldsAsInts(null, checkKeys(keys));
+    }
+    public @NonNull long[] getV8FieldsAsLongs(@NonNull V8Key[] keys) {
+        return _getV8FieldsAsLongs(null, checkKeys(keys));
+    }
+    public @NonNull boolean[] getV8FieldsAsBooleans(@NonNull V8Key[] keys) {
+        return _getV8FieldsAsBooleans(null, checkKeys(keys));
+    }
+
+    /**
+     * Assigns the values to the specified fields within a single native call
+     * @throws IllegalArgumentException if the number of values does not match the number of fields
+     */
+    public void setV8Fields(@NonNull String[] names, @NonNull Object[] values) {
+        _setV8FieldArray(names, null, values);
+    }
+    public void setV8Fields(@NonNull String[] names, @NonNull double[] values) {
+        _setV8FieldArray(names, null, values);
+    }
+    public void setV8Fields(@NonNull String[] names, @NonNull float[] values) {
+        _setV8FieldArray(names, null, values);
+    }
+    public void setV8Fields(@NonNull String[] names, @NonNull int[] values) {
+        _setV8FieldArray(names, null, values);
+    }
+    public void setV8Fields(@NonNull String[] names, @NonNull long[] values) {
+        _setV8FieldArray(names, null, values);
+    }
+    public void setV8Fields(@NonNull String[] names, @NonNull boolean[] values) {
+        _setV8FieldArray(names, null, values);
+    }
+    public void setV8Fields(@NonNull V8Key[] keys, @NonNull Object[] values) {
+        _setV8FieldArray(null, checkKeys(keys), values);
+    }
+    public void setV8Fields(@NonNull V8Key[] keys, @NonNull double[] values) {
+        _setV8FieldArray(null, checkKeys(keys), values);
+    }
+    public void setV8Fields(@NonNull V8Key[] keys, @NonNull float[] values) {
+        _setV8FieldArray(null, checkKeys(keys), values);
+    }
+    public void setV8Fields(@NonNull V8Key[] keys, @NonNull int[] values) {
+        _setV8FieldArray(null, checkKeys(keys), values);
+    }
+    public void setV8Fields(@NonNull V8Key[] keys, @NonNull long[] values) {
+        _setV8FieldArray(null, checkKeys(keys), values);
+    }
+    public void setV8Fields(@NonNull V8Key[] keys, @NonNull boolean[] values) {
+        _setV8FieldArray(null, checkKeys(keys), values);
+    }
 
     /**
      * convert a wrapped object to a number using the javascript coercion rules
@@ -215,8 +414,45 @@ abstract public class JNIV8Object extends JNIObject {
         initAutomaticDisposure();
     }
 
+    /**
+     * returns the native index of a key; keys can only be used with objects of the engine that created them
+     */
+    private int checkKey(V8Key key) {
+        if(key.getV8Engine() != _engine) {
+            throw new IllegalArgumentException("V8Key '" + key + "' belongs to a different engine");
+        }
+        return key.index;
+    }
+
+    /**
+     * returns the native indices of an array of keys
+     */
+    private int[] checkKeys(V8Key[] keys) {
+        final int[] indices = new int[keys.length];
+        for (int i = 0; i < keys.length; i++) {
+            indices[i] = checkKey(keys[i]);
+        }
+        return indices;
+    }
+
     private native boolean hasV8Field(String name, boolean ownOnly);
+    private native Object _applyV8MethodByKey(int key, int flags, int type, Class returnType, Object[] arguments);
+    private native Object _getV8FieldByKey(int key, int flags, int type, Class returnType);
+    private native void _setV8FieldByKey(int key, Object value);
+    private native boolean _hasV8FieldByKey(int key, boolean ownOnly);
     private native String[] getV8Keys(boolean ownOnly);
     private native Map<String,Object> getV8Fields(boolean ownOnly, int flags, int type, Class returnType);
+    private native Object[] _getV8FieldArray(String[] names, int[] keys, int flags, int type, Class returnType);
+    private native double[] _getV8FieldsAsDoubles(String[] names, int[] keys);
+    private native float[] _getV8FieldsAsFloats(String[] names, int[] keys);
+    private native int[] _getV8FieldsAsInts(String[] names, int[] keys);
+    private native long[] _getV8FieldsAsLongs(String[] names, int[] keys);
+    private native boolean[] _getV8FieldsAsBooleans(String[] names, int[] keys);
+    private native void _setV8FieldArray(String[] names, int[] keys, Object[] values);
+    private native void _setV8FieldArray(String[] names, int[] keys, double[] values);
+    private native void _setV8FieldArray(String[] names, int[] keys, float[] values);
+    private native void _setV8FieldArray(String[] names, int[] keys, int[] values);
+    private native void _setV8FieldArray(String[] names, int[] keys, long[] values);
+    private native void _setV8FieldArray(String[] names, int[] keys, boolean[] values);
     private native void initNativeJNIV8Object(String canonicalName, V8Engine engine, long jsObjPtr);
 }
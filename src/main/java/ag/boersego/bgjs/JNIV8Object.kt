@@ -17,6 +17,18 @@ inline fun <reified T> JNIV8Object.getV8Field(name: String, flags: Int = V8Flags
     return getV8FieldTyped(name, flags, T::class.java)
 }
 
+inline fun <reified T> JNIV8Object.applyV8Method(key: V8Key, arguments: Array<Any?>, flags: Int = V8Flags.Default): T? {
+    return applyV8MethodTyped(key, flags, T::class.java, arguments)
+}
+
+inline fun <reified T> JNIV8Object.callV8Method(key: V8Key, vararg arguments: Any?, flags: Int = V8Flags.Default): T? {
+    return callV8MethodTyped(key, flags, T::class.java, arguments)
+}
+
+inline fun <reified T> JNIV8Object.getV8Field(key: V8Key, flags: Int = V8Flags.Default) : T? {
+    return getV8FieldTyped(key, flags, T::class.java)
+}
+
 inline fun <reified T> JNIV8Object.getV8Fields(flags: Int = V8Flags.Default) : Map<String, T?> {
     return getV8FieldsTyped(flags, T::class.java)
 }
@@ -24,3 +36,11 @@ inline fun <reified T> JNIV8Object.getV8Fields(flags: Int = V8Flags.Default) : M
 inline fun <reified T> JNIV8Object.getV8OwnFields(flags: Int = V8Flags.Default) : Map<String, T?> {
     return getV8OwnFieldsTyped(flags, T::class.java)
 }
+
+inline fun <reified T> JNIV8Object.getV8Fields(names: Array<String>, flags: Int = V8Flags.Default) : Array<T?> {
+    return getV8FieldsTyped(names, flags, T::class.java)
+}
+
+inline fun <reified T> JNIV8Object.getV8Fields(keys: Array<V8Key>, flags: Int = V8Flags.Default) : Array<T?> {
+    return getV8FieldsTyped(keys, flags, T::class.java)
+}
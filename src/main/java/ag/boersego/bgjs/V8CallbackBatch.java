@@ -0,0 +1,179 @@
+package ag.boersego.bgjs;
+
+import java.nio.charset.Charset;
+import java.util.Arrays;
+
+/**
+ * V8CallbackBatch
+ * Collects callbacks that Java wants to deliver to JS (timers, ajax results, events, async call results) and submits
+ * them to the engine with a single JNI call. All records run under the same v8 locker and scopes;
+ * an exception thrown by one record does not keep the others from running.
+ *
+ * Records that would delay the next animation frame are kept in the batch and can be submitted again later.
+ * A batch is not thread safe and can be reused after submit().
+ *
+ * Copyright 2014 Kevin Read <me@kevin-read.com> and BörseGo AG (https://github.com/godmodelabs/ejecta-v8/)
+ *
+ **/
+
+public class V8CallbackBatch {
+	// record layout shared with ClientAndroid.cpp
+	private static final int TYPE_TIMEOUT = 0;
+	private static final int TYPE_AJAX = 1;
+	private static final int TYPE_BOOLEAN = 2;
+	private static final int TYPE_ASYNC_CALL = 3;
+
+	private static final int FLAG_RUN = 1;
+	private static final int FLAG_CLEANUP = 2;
+	private static final int FLAG_SUCCESS = 4;
+	private static final int FLAG_PROCESS_DATA = 8;
+	private static final int FLAG_VALUE = 16;
+
+	private static final int POINTERS_PER_RECORD = 3;
+	private static final int VALUES_PER_RECORD = 2;
+
+	private static final Charset UTF8 = Charset.forName("UTF-8");
+
+	private final V8Engine mEngine;
+	private int mCount;
+	private int[] mTypes;
+	private long[] mPointers;
+	private int[] mValues;
+	private Object[] mPayloads;
+	private final int[] mResult = new int[2];
+
+	public V8CallbackBatch(final V8Engine engine) {
+		this(engine, 16);
+	}
+
+	public V8CallbackBatch(final V8Engine engine, final int capacity) {
+		mEngine = engine;
+		final int size = Math.max(1, capacity);
+		mTypes = new int[size];
+		mPointers = new long[size * POINTERS_PER_RECORD];
+		mValues = new int[size * VALUES_PER_RECORD];
+		mPayloads = new Object[size];
+	}
+
+	/**
+	 * Add a timer callback, see ClientAndroid.timeoutCB
+	 */
+	public void addTimeout(final long jsCbPtr, final long thisObjPtr, final boolean cleanup, final boolean runCallback) {
+		add(TYPE_TIMEOUT, jsCbPtr, thisObjPtr, 0, (cleanup ? FLAG_CLEANUP : 0) | (runCallback ? FLAG_RUN : 0), 0, null);
+	}
+
+	/**
+	 * Add the result of an ajax request, see ClientAndroid.ajaxDone
+	 * @param data the response body or null
+	 */
+	public void addAjaxResult(final String data, final int responseCode, final long jsCbPtr, final long thisObj,
+							  final long errorCb, final boolean success, final boolean processData) {
+		addAjaxResult(data != null ? data.getBytes(UTF8) : null, responseCode, jsCbPtr, thisObj, errorCb, success, processData);
+	}
+
+	/**
+	 * Add the result of an ajax request
+	 * @param data the utf-8 encoded response body or null
+	 */
+	public void addAjaxResult(final byte[] data, final int responseCode, final long jsCbPtr, final long thisObj,
+							  final long errorCb, final boolean success, final boolean processData) {
+		add(TYPE_AJAX, jsCbPtr, thisObj, errorCb, (success ? FLAG_SUCCESS : 0) | (processData ? FLAG_PROCESS_DATA : 0),
+				responseCode, data);
+	}
+
+	/**
+	 * Add an event callback with a boolean argument, see ClientAndroid.runCBBoolean
+	 */
+	public void addBooleanCallback(final long cbPtr, final long thisPtr, final boolean b) {
+		add(TYPE_BOOLEAN, cbPtr, thisPtr, 0, b ? FLAG_VALUE : 0, 0, null);
+	}
+
+	/**
+	 * Add an async java call whose method returned, its promise is resolved or rejected with the result
+	 */
+	public void addAsyncJavaCall(final long callPtr) {
+		add(TYPE_ASYNC_CALL, callPtr, 0, 0, 0, 0, null);
+	}
+
+	/**
+	 * Remove the async java calls from the batch without resolving them, see ClientAndroid.dropAsyncJavaCall.
+	 * Used when the engine shuts down; all other records stay in the batch in their original order.
+	 */
+	public void dropAsyncJavaCalls() {
+		int count = 0;
+		for (int idx = 0; idx < mCount; idx++) {
+			if (mTypes[idx] == TYPE_ASYNC_CALL) {
+				ClientAndroid.dropAsyncJavaCall(mPointers[idx * POINTERS_PER_RECORD]);
+				continue;
+			}
+			if (count != idx) {
+				mTypes[count] = mTypes[idx];
+				System.arraycopy(mPointers, idx * POINTERS_PER_RECORD, mPointers, count * POINTERS_PER_RECORD, POINTERS_PER_RECORD);
+				System.arraycopy(mValues, idx * VALUES_PER_RECORD, mValues, count * VALUES_PER_RECORD, VALUES_PER_RECORD);
+				mPayloads[count] = mPayloads[idx];
+			}
+			count++;
+		}
+		Arrays.fill(mPayloads, count, mCount, null);
+		mCount = count;
+	}
+
+	public int size() {
+		return mCount;
+	}
+
+	/**
+	 * Run the collected callbacks and remove them from the batch. Callbacks deferred by the frame scheduler
+	 * stay in the batch in their original order; check size() afterwards and submit again later.
+	 * @return the number of callbacks that threw an exception
+	 * @throws RuntimeException the exception thrown by the first failed callback, after all callbacks ran
+	 */
+	public int submit() {
+		if (mCount == 0) {
+			return 0;
+		}
+		final int count = mCount;
+		mResult[0] = count;
+		mResult[1] = 0;
+		try {
+			ClientAndroid.runCallbackBatch(mEngine, count, mTypes, mPointers, mValues, mPayloads, mResult);
+		} finally {
+			removeFirst(mResult[0]);
+		}
+		return mResult[1];
+	}
+
+	/**
+	 * drop the records that ran, keeping the deferred ones in order
+	 */
+	private void removeFirst(final int done) {
+		final int remaining = mCount - done;
+		if (remaining > 0) {
+			System.arraycopy(mTypes, done, mTypes, 0, remaining);
+			System.arraycopy(mPointers, done * POINTERS_PER_RECORD, mPointers, 0, remaining * POINTERS_PER_RECORD);
+			System.arraycopy(mValues, done * VALUES_PER_RECORD, mValues, 0, remaining * VALUES_PER_RECORD);
+			System.arraycopy(mPayloads, done, mPayloads, 0, remaining);
+		}
+		Arrays.fill(mPayloads, Math.max(remaining, 0), mCount, null);
+		mCount = Math.max(remaining, 0);
+	}
+
+	private void add(final int type, final long ptr0, final long ptr1, final long ptr2, final int flags, final int value,
+					 final Object payload) {
+		if (mCount == mTypes.length) {
+			final int size = mTypes.length * 2;
+			mTypes = Arrays.copyOf(mTypes, size);
+			mPointers = Arrays.copyOf(mPointers, size * POINTERS_PER_RECORD);
+			mValues = Arrays.copyOf(mValues, size * VALUES_PER_RECORD);
+			mPayloads = Arrays.copyOf(mPayloads, size);
+		}
+		final int idx = mCount++;
+		mTypes[idx] = type;
+		mPointers[idx * POINTERS_PER_RECORD] = ptr0;
+		mPointers[idx * POINTERS_PER_RECORD + 1] = ptr1;
+		mPointers[idx * POINTERS_PER_RECORD + 2] = ptr2;
+		mValues[idx * VALUES_PER_RECORD] = flags;
+		mValues[idx * VALUES_PER_RECORD + 1] = value;
+		mPayloads[idx] = payload;
+	}
+}
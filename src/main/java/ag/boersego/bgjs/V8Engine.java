@@ -6,16 +6,21 @@ import android.content.res.Resources;
 import android.os.Handler;
 import android.os.Looper;
 import android.os.Message;
+import android.support.annotation.NonNull;
 import android.util.Log;
 import android.util.SparseArray;
 
+import java.io.File;
 import java.net.URISyntaxException;
+import java.nio.ByteBuffer;
 import java.util.ArrayList;
 import java.util.HashMap;
 import java.util.HashSet;
 import java.util.Locale;
 import java.util.TimeZone;
+import java.util.concurrent.LinkedBlockingQueue;
 import java.util.concurrent.ThreadPoolExecutor;
+import java.util.concurrent.TimeUnit;
 
 import ag.boersego.bgjs.data.AjaxRequest;
 import ag.boersego.bgjs.data.V8UrlCache;
@@ -41,13 +46,18 @@ public class V8Engine extends JNIObject implements Handler.Callback {
 	protected final boolean mIsTablet;
 	protected Handler mHandler;
 	private String scriptPath;
+	private final String[] mPreloadModules;
+	private final V8Engine mIsolateHost;
+	private final File mCodeCacheDir;
 	private AssetManager assetManager;
 	private boolean mReady;
 	private ArrayList<V8EngineHandler> mHandlers = null;
 	private final SparseArray<V8Timeout> mTimeouts = new SparseArray<V8Timeout>(50);
 	private int mLastTimeoutId = 1;
 	private final HashSet<V8Timeout> mTimeoutsToGC = new HashSet<V8Timeout>();
-	private V8Timeout mRunningTO;
+	// timers that are due, in the order of their records in mTimeoutBatch; only used on the engine thread
+	private final ArrayList<V8Timeout> mDueTimeouts = new ArrayList<>();
+	private final V8CallbackBatch mTimeoutBatch = new V8CallbackBatch(this);
 	protected final String mLocale;
 	protected final String mLang;
 	protected final String mTimeZone;
@@ -60,6 +70,15 @@ public class V8Engine extends JNIObject implements Handler.Callback {
 	private ThreadPoolExecutor mTPExecutor;
     private OkHttpClient mHttpClient;
     private final ArrayList<Runnable> mNextTickQueue = new ArrayList<>();
+	private final ArrayList<V8AjaxRequest> mFinishedAjaxRequests = new ArrayList<>();
+	// only used on the engine thread
+	private final V8CallbackBatch mAjaxBatch = new V8CallbackBatch(this);
+	private final ArrayList<Long> mFinishedAsyncCalls = new ArrayList<>();
+	// set on shutdown, guarded by mFinishedAsyncCalls; results of async calls are dropped from then on
+	private boolean mAsyncCallsClosed;
+	// only used on the engine thread
+	private final V8CallbackBatch mAsyncCallBatch = new V8CallbackBatch(this);
+	private static ThreadPoolExecutor sAsyncExecutor;
     private boolean mJobQueueActive = false;
     private final Runnable mQueueWaitRunnable = new Runnable() {
         @Override
@@ -89,11 +108,31 @@ public class V8Engine extends JNIObject implements Handler.Callback {
         }
     };
 	private boolean mPaused;
+	// guards mShutdownPending and the assignment of mHandler
+	private final Object mShutdownLock = new Object();
+	// shutdown() was called before the engine thread started
+	private boolean mShutdownPending;
 
 	public static void doDebug (boolean debug) {
         DEBUG = debug;
     }
 
+	/**
+	 * Resolve the native JNI class and method caches on a low priority background thread.
+	 * This is optional; if it is not called, the caches are resolved when the first engine is initialized.
+	 */
+	public static void prewarm() {
+		final Thread thread = new Thread(new Runnable() {
+			@Override
+			public void run() {
+				ClientAndroid.prewarm();
+			}
+		});
+		thread.setName("EjectaV8Prewarm");
+		thread.setPriority(Thread.MIN_PRIORITY);
+		thread.start();
+	}
+
 	public void unpause() {
 		mPaused = false;
         if (mHandler != null) {
@@ -178,18 +217,28 @@ public class V8Engine extends JNIObject implements Handler.Callback {
 
 		@Override
 		public void run() {
-			mRunningTO = this;
 			if (this.dead) {
-				mTimeoutsToGC.add(this);
+				synchronized (mTimeouts) {
+					mTimeoutsToGC.add(this);
+				}
 				if (!mHandler.hasMessages(MSG_CLEANUP)) {
 					mHandler.sendMessageDelayed(mHandler.obtainMessage(MSG_CLEANUP), DELAY_CLEANUP);
 				}
 				return;
 			}
-			if (DEBUG) { Log.d (TAG, "timeout ready (id " + id + ") to " + timeout + ", now calling cb " + jsCbPtr); }
-			// synchronized(BGJSPushHelper.getInstance(null)) {
-				ClientAndroid.timeoutCB(V8Engine.this, jsCbPtr, thisObjPtr, false, true);
-			// }
+			if (DEBUG) { Log.d (TAG, "timeout ready (id " + id + ") to " + timeout + ", now queueing cb " + jsCbPtr); }
+			// all timers that are due in this turn of the looper run in a single batch
+			if (mDueTimeouts.isEmpty() && !mHandler.hasMessages(MSG_TIMEOUTS)) {
+				mHandler.sendMessage(mHandler.obtainMessage(MSG_TIMEOUTS));
+			}
+			mDueTimeouts.add(this);
+			mTimeoutBatch.addTimeout(jsCbPtr, thisObjPtr, false, true);
+		}
+
+		/**
+		 * called after the callback of the timer ran (or was skipped, because the timer was cleared meanwhile)
+		 */
+		void onFired() {
 			synchronized (mTimeouts) {
 				if (this.dead) {
 					mTimeoutsToGC.add(this);
@@ -215,11 +264,35 @@ public class V8Engine extends JNIObject implements Handler.Callback {
 	}
 
 	protected V8Engine(Application application, String path) {
+		this(application, path, null);
+	}
+
+	/**
+	 * Create a new engine that requires additional modules after the main script
+	 * @param application the application used for assets and resources
+	 * @param path the main script to require on startup
+	 * @param preloadModules modules that are required right after the main script, before the engine reports ready. May be null
+	 */
+	protected V8Engine(Application application, String path, String[] preloadModules) {
+		this(application, path, preloadModules, null);
+	}
+
+	/**
+	 * Create a new engine that runs in its own context on the isolate of another engine
+	 * @param application the application used for assets and resources
+	 * @param path the main script to require on startup
+	 * @param preloadModules modules that are required right after the main script, before the engine reports ready. May be null
+	 * @param isolateHost the engine whose isolate should be shared, or null to create a new isolate
+	 */
+	protected V8Engine(Application application, String path, String[] preloadModules, V8Engine isolateHost) {
+		mPreloadModules = preloadModules;
+		mIsolateHost = isolateHost;
 		if (path != null) {
             scriptPath = path;
         }
         if (application != null) {
             assetManager = application.getAssets();
+            mCodeCacheDir = new File(application.getCacheDir(), "v8-code-cache");
             final Resources r = application.getResources();
             if (r != null) {
                 mDensity = r.getDisplayMetrics().density;
@@ -289,9 +362,24 @@ public class V8Engine extends JNIObject implements Handler.Callback {
 			e.printStackTrace();
 		}
 		Log.d(TAG, "Initializing V8Engine");
-		ClientAndroid.initialize(assetManager, this, mLocale, mLang, mTimeZone, mDensity, mIsTablet ? "tablet" : "phone", BuildConfig.DEBUG);
+		ClientAndroid.initialize(assetManager, this, mLocale, mLang, mTimeZone, mDensity, mIsTablet ? "tablet" : "phone", BuildConfig.DEBUG, mIsolateHost);
     }
 
+	/**
+	 * Create a lightweight engine that shares the isolate of this engine but has its own context, global object,
+	 * module cache and timers. Heap, compiled code, templates and class bindings are shared, so this is much cheaper
+	 * than a separate engine. JS code of both engines is never executed in parallel.
+	 * @param application the application used for assets and resources
+	 * @param path the main script the new context requires on startup
+	 * @return the new engine; use addStatusHandler to wait for it to become ready
+	 */
+	public V8Engine createContextEngine(Application application, String path) {
+		if (!mReady) {
+			throw new IllegalStateException("V8Engine must be ready before it can host other contexts");
+		}
+		return new V8Engine(application, path, null, this);
+	}
+
     public native void registerModule(JNIV8Module module);
 
 	public JNIV8Function getConstructor(Class<? extends JNIV8Object> jniv8class) {
@@ -300,11 +388,48 @@ public class V8Engine extends JNIObject implements Handler.Callback {
 	private native JNIV8Function getConstructor(String canonicalName);
 
 	public native Object parseJSON(String json);
+
+	/**
+	 * Creates a javascript value from data in the binary format of v8::ValueSerializer, e.g. a whole object graph
+	 * encoded with V8ValueCodec.encode or serialized by JNIV8Object.serialize, with a single native call.
+	 * @throws V8Exception if the data is malformed
+	 */
+	public Object deserialize(@NonNull byte[] data) {
+		return deserializeBytes(data, 0, data.length);
+	}
+
+	/**
+	 * deserializes the remaining bytes of the buffer; direct buffers are read without copying them to the java heap
+	 * @see #deserialize(byte[])
+	 */
+	public Object deserialize(@NonNull ByteBuffer data) {
+		if (data.isDirect()) {
+			return deserializeDirect(data, data.position(), data.remaining());
+		} else if (data.hasArray()) {
+			return deserializeBytes(data.array(), data.arrayOffset() + data.position(), data.remaining());
+		}
+		final byte[] copy = new byte[data.remaining()];
+		data.duplicate().get(copy);
+		return deserializeBytes(copy, 0, copy.length);
+	}
+	private native Object deserializeBytes(byte[] data, int offset, int length);
+	private native Object deserializeDirect(ByteBuffer data, int offset, int length);
 	public native Object runScript(String script, String name);
 	public native Object require(String file);
+	private native void setCodeCacheDir(String path);
 
 	public native JNIV8GenericObject getGlobalObject();
 
+	/**
+	 * Returns a handle for the specified property name that can be passed to the field and method accessors of
+	 * JNIV8Object instead of the String, to avoid converting the name on every access.
+	 * Keys are cached natively: asking for the same name twice returns a handle for the same javascript string.
+	 */
+	public V8Key getV8Key(String name) {
+		return new V8Key(this, name, createV8Key(name));
+	}
+	private native int createV8Key(String name);
+
 	private native long lock();
     private native void unlock(long lockerPtr);
 
@@ -318,12 +443,30 @@ public class V8Engine extends JNIObject implements Handler.Callback {
 		public void run() {
 
 			Looper.prepare();
-			mHandler = new Handler(V8Engine.this);
+			synchronized (mShutdownLock) {
+				if (mShutdownPending) {
+					// the isolate is never created
+					return;
+				}
+				mHandler = new Handler(V8Engine.this);
+			}
 			initializeV8(assetManager);
 
 			assetManager = null;
 
+			// compiled WebAssembly modules are cached here
+			if (mCodeCacheDir.isDirectory() || mCodeCacheDir.mkdirs()) {
+				setCodeCacheDir(mCodeCacheDir.getAbsolutePath());
+			} else {
+				Log.w(TAG, "Cannot create code cache directory " + mCodeCacheDir);
+			}
+
 			require(scriptPath);
+			if (mPreloadModules != null) {
+				for (final String module : mPreloadModules) {
+					require(module);
+				}
+			}
 
 			mHandler.sendMessageAtFrontOfQueue(mHandler.obtainMessage(MSG_READY));
 			mHandler.sendMessageDelayed(mHandler.obtainMessage(MSG_CLEANUP), DELAY_CLEANUP);
@@ -361,12 +504,15 @@ public class V8Engine extends JNIObject implements Handler.Callback {
 				return;
 			}
 			
+			// all listeners are called with a single transition into JS
+			final V8CallbackBatch batch = new V8CallbackBatch(this, eventList.size());
 			for (V8EventCB cb : eventList) {
 				if (DEBUG) {
 					Log.d (TAG, "Calling on " + event + ", " + cb.cbPtr);
 				}
-				ClientAndroid.runCBBoolean(this, cb.cbPtr, cb.thisPtr, b);
+				batch.addBooleanCallback(cb.cbPtr, cb.thisPtr, b);
 			}
+			batch.submit();
 		}
 	}
 
@@ -396,14 +542,24 @@ public class V8Engine extends JNIObject implements Handler.Callback {
                 mHandler.sendMessageDelayed(mHandler.obtainMessage(MSG_CLEANUP), DELAY_CLEANUP);
                 return true;
             case MSG_QUIT:
+                closeAsyncJavaCalls();
+                ClientAndroid.shutdownEngine(this);
                 Looper.myLooper().quit();
                 return true;
             case MSG_LOAD:
                 return true;
             case MSG_AJAX:
-                V8AjaxRequest req = (V8AjaxRequest) msg.obj;
-                if (req != null) {
-                    req.doCallBack();
+                runFinishedAjaxRequests();
+                return true;
+            case MSG_ASYNC_CALL:
+                runFinishedAsyncJavaCalls();
+                return true;
+            case MSG_TIMEOUTS:
+                runDueTimeouts();
+                return true;
+            case MSG_IDLE:
+                if (ClientAndroid.runIdleWork(this) && !mHandler.hasMessages(MSG_IDLE)) {
+                    mHandler.sendMessageDelayed(mHandler.obtainMessage(MSG_IDLE), FRAME_DEFER_DELAY);
                 }
                 return true;
             case MSG_READY:
@@ -428,10 +584,12 @@ public class V8Engine extends JNIObject implements Handler.Callback {
 			mTimeoutsToGC.clear();
 		}
 		try {
-			final int count = mTimeoutsToGC.size();
+			final int count = timeOutCopy.length;
+			final V8CallbackBatch batch = new V8CallbackBatch(this, count);
 			for (V8Timeout to : timeOutCopy) {
-				ClientAndroid.timeoutCB(this, to.jsCbPtr, to.thisObjPtr, true, false);
+				batch.addTimeout(to.jsCbPtr, to.thisObjPtr, true, false);
 			}
+			batch.submit();
 			if (DEBUG) {
 				Log.d (TAG, "Cleaned up " + count + " timeouts");
 			}
@@ -449,7 +607,8 @@ public class V8Engine extends JNIObject implements Handler.Callback {
 		return -1;
 	}
 	
-	private int setTimeoutInst(long jsCbPtr, long thisObjPtr, long timeout, boolean recurring) {
+	// called from native code for timers of this engine instance
+	int setTimeoutInst(long jsCbPtr, long thisObjPtr, long timeout, boolean recurring) {
 		synchronized(mTimeouts) {
 			int id = mLastTimeoutId++;
 			V8Timeout to = new V8Timeout(jsCbPtr, thisObjPtr, timeout, recurring, id);
@@ -468,7 +627,12 @@ public class V8Engine extends JNIObject implements Handler.Callback {
 		}
 	}
 	
-	void removeTimeoutInst(int id) {
+	/**
+	 * called from native code for timers of this engine instance
+	 * @return the callback pointer of the removed timer, or 0 if there was none. Native code marks the callback as
+	 * cancelled, so that it is skipped if its record is already waiting in the timer batch.
+	 */
+	long removeTimeoutInst(int id) {
 		synchronized (mTimeouts) {
 			V8Timeout to = mTimeouts.get(id);
 			if (to != null) {
@@ -478,17 +642,20 @@ public class V8Engine extends JNIObject implements Handler.Callback {
 					Log.d (TAG, "Removed timeout (clearTimeout) " + id);
 				}
 				mTimeouts.remove(id);
-				
-				if (mRunningTO != to) {
+
+				// queued timers are collected once their record was processed
+				if (!mDueTimeouts.contains(to)) {
 					mTimeoutsToGC.add(to);
 				}
 				if (!mHandler.hasMessages(MSG_CLEANUP)) {
 					mHandler.sendMessageDelayed(mHandler.obtainMessage(MSG_CLEANUP), DELAY_CLEANUP);
 				}
+				return to.jsCbPtr;
 			} else {
 				Log.i (TAG, "Couldn't remove timeout (clearTimeout) " + id);
 			}
 		}
+		return 0;
 	}
 
 	public void setHttpClient(final OkHttpClient client) {
@@ -534,9 +701,7 @@ public class V8Engine extends JNIObject implements Handler.Callback {
 					}
 					mReq.run();
                     mReq.runCallback();
-					V8Engine engine = V8Engine.getInstance();
-					engine.mHandler.sendMessage(engine.mHandler
-							.obtainMessage(MSG_AJAX, V8AjaxRequest.this));
+					onAjaxRequestFinished(V8AjaxRequest.this);
 				}
 			};
 			if (mTPExecutor != null) {
@@ -556,6 +721,10 @@ public class V8Engine extends JNIObject implements Handler.Callback {
 			ClientAndroid.ajaxDone(V8Engine.this, mData, mCode, mCbPtr, mThisObj, mErrorCb, mSuccess, mProcessData);
 		}
 
+		void addToBatch(final V8CallbackBatch batch) {
+			batch.addAjaxResult(mData, mCode, mCbPtr, mThisObj, mErrorCb, mSuccess, mProcessData);
+		}
+
 		public void success(String data, int code, AjaxRequest r) {
 			mSuccess = true;
 			mData = data;
@@ -569,17 +738,198 @@ public class V8Engine extends JNIObject implements Handler.Callback {
 		}
 	}
 
+	/**
+	 * Requests that finish while the engine thread is busy are collected and delivered to JS together
+	 */
+	private void onAjaxRequestFinished(final V8AjaxRequest req) {
+		final boolean first;
+		synchronized (mFinishedAjaxRequests) {
+			first = mFinishedAjaxRequests.isEmpty();
+			mFinishedAjaxRequests.add(req);
+		}
+		if (first) {
+			mHandler.sendMessage(mHandler.obtainMessage(MSG_AJAX));
+		}
+	}
+
+	private void runFinishedAjaxRequests() {
+		// results deferred by an earlier run are still in the batch and go first
+		synchronized (mFinishedAjaxRequests) {
+			for (V8AjaxRequest req : mFinishedAjaxRequests) {
+				req.addToBatch(mAjaxBatch);
+			}
+			mFinishedAjaxRequests.clear();
+		}
+		if (DEBUG) {
+			Log.d(TAG, "Delivering " + mAjaxBatch.size() + " ajax results");
+		}
+		try {
+			mAjaxBatch.submit();
+		} finally {
+			if (mAjaxBatch.size() > 0 && !mHandler.hasMessages(MSG_AJAX)) {
+				mHandler.sendMessageDelayed(mHandler.obtainMessage(MSG_AJAX), FRAME_DEFER_DELAY);
+			}
+		}
+	}
+
+	/**
+	 * Called from native code when JS invokes a java method annotated with @V8Function(async = true).
+	 * The method runs on the thread pool executor, the promise returned to JS is settled on the engine thread.
+	 */
+	void runAsyncJavaCall(final long callPtr) {
+		final Runnable runnable = new Runnable() {
+			@Override
+			public void run() {
+				ClientAndroid.runAsyncJavaCall(callPtr);
+				onAsyncJavaCallFinished(callPtr);
+			}
+		};
+		if (mTPExecutor != null) {
+			mTPExecutor.execute(runnable);
+		} else {
+			getDefaultAsyncExecutor().execute(runnable);
+		}
+	}
+
+	private static synchronized ThreadPoolExecutor getDefaultAsyncExecutor() {
+		if (sAsyncExecutor == null) {
+			sAsyncExecutor = new ThreadPoolExecutor(ASYNC_POOL_SIZE, ASYNC_POOL_SIZE, 30, TimeUnit.SECONDS,
+					new LinkedBlockingQueue<Runnable>());
+			sAsyncExecutor.allowCoreThreadTimeOut(true);
+		}
+		return sAsyncExecutor;
+	}
+
+	/**
+	 * Run the callbacks of all due timers in one batch. Timers deferred by the frame scheduler stay queued.
+	 */
+	private void runDueTimeouts() {
+		final int count = mTimeoutBatch.size();
+		try {
+			mTimeoutBatch.submit();
+		} finally {
+			final int ran = count - mTimeoutBatch.size();
+			for (int i = 0; i < ran; i++) {
+				mDueTimeouts.get(i).onFired();
+			}
+			mDueTimeouts.subList(0, ran).clear();
+			if (!mDueTimeouts.isEmpty() && !mHandler.hasMessages(MSG_TIMEOUTS)) {
+				mHandler.sendMessageDelayed(mHandler.obtainMessage(MSG_TIMEOUTS), FRAME_DEFER_DELAY);
+			}
+		}
+	}
+
+	private void onAsyncJavaCallFinished(final long callPtr) {
+		final boolean first;
+		final boolean closed;
+		synchronized (mFinishedAsyncCalls) {
+			closed = mAsyncCallsClosed;
+			first = !closed && mFinishedAsyncCalls.isEmpty();
+			if (!closed) {
+				mFinishedAsyncCalls.add(callPtr);
+			}
+		}
+		if (closed) {
+			// the engine thread is gone, nobody would resolve the call; the v8 locker is not taken under the monitor
+			ClientAndroid.dropAsyncJavaCall(callPtr);
+		} else if (first) {
+			mHandler.sendMessage(mHandler.obtainMessage(MSG_ASYNC_CALL));
+		}
+	}
+
+	private void runFinishedAsyncJavaCalls() {
+		synchronized (mFinishedAsyncCalls) {
+			for (Long callPtr : mFinishedAsyncCalls) {
+				mAsyncCallBatch.addAsyncJavaCall(callPtr);
+			}
+			mFinishedAsyncCalls.clear();
+		}
+		if (DEBUG) {
+			Log.d(TAG, "Resolving " + mAsyncCallBatch.size() + " async java calls");
+		}
+		try {
+			mAsyncCallBatch.submit();
+		} finally {
+			if (mAsyncCallBatch.size() > 0 && !mHandler.hasMessages(MSG_ASYNC_CALL)) {
+				mHandler.sendMessageDelayed(mHandler.obtainMessage(MSG_ASYNC_CALL), FRAME_DEFER_DELAY);
+			}
+		}
+	}
+
+	/**
+	 * Drop the results of async java calls that were not delivered yet; calls that are still running are dropped when they return.
+	 * Called on the engine thread before its looper quits, while the isolate is still alive.
+	 */
+	private void closeAsyncJavaCalls() {
+		final Long[] finished;
+		synchronized (mFinishedAsyncCalls) {
+			mAsyncCallsClosed = true;
+			finished = mFinishedAsyncCalls.toArray(new Long[mFinishedAsyncCalls.size()]);
+			mFinishedAsyncCalls.clear();
+		}
+		for (Long callPtr : finished) {
+			ClientAndroid.dropAsyncJavaCall(callPtr);
+		}
+		mAsyncCallBatch.dropAsyncJavaCalls();
+	}
+
+	/**
+	 * Called from native code when the gc released java references of this isolate while none were waiting.
+	 * They are otherwise only released after JS ran, so an idle engine would keep them alive indefinitely.
+	 */
+	void requestIdleWork() {
+		final Handler handler = mHandler;
+		if (handler != null && !handler.hasMessages(MSG_IDLE)) {
+			handler.sendMessage(handler.obtainMessage(MSG_IDLE));
+		}
+	}
+
+	/**
+	 * Set the time per animation frame that timers and network callbacks may use before they are deferred
+	 * to the next frame. Only applies while frames are being rendered.
+	 */
+	public void setFrameBudget(final double budgetMs) {
+		ClientAndroid.setFrameBudget(this, budgetMs);
+	}
+
+	/**
+	 * @return the frame scheduler accounting of this engine
+	 */
+	public V8FrameStats getFrameStats() {
+		final double[] data = new double[V8FrameStats.SIZE];
+		ClientAndroid.getFrameStats(this, data);
+		return new V8FrameStats(data);
+	}
+
 	public static void doAjaxRequest(String url, long jsCb, long thisObj, long errorCb,
 			String data, String method, boolean processData) {
-		V8AjaxRequest req = mInstance.new V8AjaxRequest(url, jsCb, thisObj, errorCb, data, method, processData);
+		mInstance.doAjaxRequestInst(url, jsCb, thisObj, errorCb, data, method, processData);
+	}
+
+	// called from native code for requests made by this engine instance
+	void doAjaxRequestInst(String url, long jsCb, long thisObj, long errorCb,
+			String data, String method, boolean processData) {
+		V8AjaxRequest req = new V8AjaxRequest(url, jsCb, thisObj, errorCb, data, method, processData);
 		if (DEBUG) {
 			Log.d(TAG, "Preparing to do ajax request on thread "
 					+ Thread.currentThread().getId());
 		}
 	}
 
+	/**
+	 * Stop the engine thread and release the JS context. The isolate is disposed once the engine and all of its
+	 * wrappers were garbage collected. If the engine thread has not started yet, it ends as soon as it starts.
+	 */
 	public void shutdown() {
-		mHandler.sendEmptyMessage(MSG_QUIT);
+		final Handler handler;
+		synchronized (mShutdownLock) {
+			handler = mHandler;
+			if (handler == null) {
+				mShutdownPending = true;
+				return;
+			}
+		}
+		handler.sendEmptyMessage(MSG_QUIT);
 	}
 
 	// public void loadURL(String URL)
@@ -588,10 +938,17 @@ public class V8Engine extends JNIObject implements Handler.Callback {
 	private static final int MSG_LOAD = 3;
 	private static final int MSG_AJAX = 4;
 	private static final int MSG_READY = 5;
+	private static final int MSG_ASYNC_CALL = 6;
+	private static final int MSG_IDLE = 7;
+	private static final int MSG_TIMEOUTS = 8;
 
 
 	public static final int TICK_SLEEP = 250;
 	private static final int DELAY_CLEANUP = 10 * 1000;
+	// how long work deferred by the frame scheduler waits before it is tried again
+	private static final long FRAME_DEFER_DELAY = 4;
+	// threads used for async java calls when no thread pool executor was set
+	private static final int ASYNC_POOL_SIZE = 4;
 
 
 }
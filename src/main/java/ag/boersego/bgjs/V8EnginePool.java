@@ -0,0 +1,294 @@
+package ag.boersego.bgjs;
+
+import android.app.Application;
+import android.os.SystemClock;
+import android.util.Log;
+
+import java.util.ArrayDeque;
+import java.util.IdentityHashMap;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * V8EnginePool
+ * Keeps a number of fully initialized engines ready so that screens do not have to wait for
+ * isolate creation, context bootstrap and the initial require graph.
+ *
+ * Engines are warmed up one after another on a background thread. acquire() hands out a ready
+ * engine in constant time and schedules a replacement; if the pool is empty a cold engine is created.
+ *
+ * Copyright 2014 Kevin Read <me@kevin-read.com> and BörseGo AG (https://github.com/godmodelabs/ejecta-v8/)
+ *
+ **/
+
+public class V8EnginePool {
+	private static final String TAG = "V8EnginePool";
+	private static boolean DEBUG = false && BuildConfig.DEBUG;
+
+	/**
+	 * What happens to an engine that is handed back to the pool
+	 */
+	public enum ReleasePolicy {
+		/**
+		 * the engine is put back into the pool if there is room and it has not exceeded its maximum number of uses.
+		 * JS state of the previous user is kept, so only use this if screens clean up after themselves
+		 */
+		RECYCLE,
+		/**
+		 * the engine is always shut down and a fresh one is warmed up instead
+		 */
+		DISCARD
+	}
+
+	/**
+	 * Snapshot of the pool metrics
+	 */
+	public static class Stats {
+		public final long hits;
+		public final long misses;
+		public final long recycled;
+		public final long discarded;
+		public final long warmedUp;
+		public final long totalWarmupMs;
+		public final long lastWarmupMs;
+		public final int idle;
+
+		Stats(long hits, long misses, long recycled, long discarded, long warmedUp, long totalWarmupMs,
+			  long lastWarmupMs, int idle) {
+			this.hits = hits;
+			this.misses = misses;
+			this.recycled = recycled;
+			this.discarded = discarded;
+			this.warmedUp = warmedUp;
+			this.totalWarmupMs = totalWarmupMs;
+			this.lastWarmupMs = lastWarmupMs;
+			this.idle = idle;
+		}
+
+		public long getAverageWarmupMs() {
+			return warmedUp > 0 ? totalWarmupMs / warmedUp : 0;
+		}
+
+		@Override
+		public String toString() {
+			return "V8EnginePool.Stats{hits=" + hits + ", misses=" + misses + ", recycled=" + recycled +
+					", discarded=" + discarded + ", warmedUp=" + warmedUp + ", avgWarmupMs=" + getAverageWarmupMs() +
+					", lastWarmupMs=" + lastWarmupMs + ", idle=" + idle + "}";
+		}
+	}
+
+	private static final long WARMUP_TIMEOUT_MS = 30 * 1000;
+
+	private final Application mApplication;
+	private final String mScriptPath;
+	private final String[] mPreloadModules;
+	private final int mSize;
+	private final ReleasePolicy mPolicy;
+	private final int mMaxUses;
+
+	private final ArrayDeque<V8Engine> mIdle;
+	private final IdentityHashMap<V8Engine, Integer> mUseCount = new IdentityHashMap<>();
+	private final ExecutorService mWarmupExecutor;
+	private int mPendingWarmups;
+	private boolean mShutdown;
+
+	private long mHits, mMisses, mRecycled, mDiscarded, mWarmedUp, mTotalWarmupMs, mLastWarmupMs;
+
+	/**
+	 * Create a new pool and start warming up engines in the background
+	 * @param application the application used for assets and resources
+	 * @param scriptPath the main script every engine requires on startup
+	 * @param preloadModules additional modules to require before an engine is considered warm. May be null
+	 * @param size number of engines to keep ready
+	 * @param policy what to do with engines that are released
+	 * @param maxUses number of times an engine may be handed out before it is discarded; only relevant for RECYCLE
+	 */
+	public V8EnginePool(final Application application, final String scriptPath, final String[] preloadModules,
+						final int size, final ReleasePolicy policy, final int maxUses) {
+		if (application == null || scriptPath == null) {
+			throw new RuntimeException("V8EnginePool needs an application and a script path");
+		}
+		if (size < 1) {
+			throw new IllegalArgumentException("V8EnginePool size must be at least 1");
+		}
+		mApplication = application;
+		mScriptPath = scriptPath;
+		mPreloadModules = preloadModules;
+		mSize = size;
+		mPolicy = policy;
+		mMaxUses = Math.max(1, maxUses);
+		mIdle = new ArrayDeque<>(size);
+
+		mWarmupExecutor = Executors.newSingleThreadExecutor(new ThreadFactory() {
+			@Override
+			public Thread newThread(Runnable r) {
+				final Thread thread = new Thread(r);
+				thread.setName("EjectaV8EngineWarmup");
+				thread.setPriority(Thread.MIN_PRIORITY);
+				return thread;
+			}
+		});
+
+		fill();
+	}
+
+	public static void doDebug(boolean debug) {
+		DEBUG = debug;
+	}
+
+	/**
+	 * Get an engine from the pool. If a warm engine is available it is returned immediately,
+	 * otherwise a new engine is created that will signal readiness through addStatusHandler as usual.
+	 * Either way a replacement is warmed up in the background.
+	 * @return an engine that is owned by the caller until it is passed to release()
+	 */
+	public V8Engine acquire() {
+		V8Engine engine;
+		synchronized (this) {
+			if (mShutdown) {
+				throw new IllegalStateException("V8EnginePool has been shut down");
+			}
+			engine = mIdle.pollFirst();
+			if (engine != null) {
+				mHits++;
+			} else {
+				mMisses++;
+			}
+		}
+
+		if (engine == null) {
+			if (DEBUG) {
+				Log.d(TAG, "Pool empty, creating cold engine");
+			}
+			engine = new V8Engine(mApplication, mScriptPath, mPreloadModules);
+		}
+
+		synchronized (this) {
+			final Integer uses = mUseCount.get(engine);
+			mUseCount.put(engine, uses == null ? 1 : uses + 1);
+		}
+
+		fill();
+		return engine;
+	}
+
+	/**
+	 * Hand an engine back to the pool. Depending on the release policy it is kept for reuse or shut down.
+	 * The caller must not use the engine afterwards.
+	 * @param engine an engine obtained from acquire()
+	 */
+	public void release(final V8Engine engine) {
+		if (engine == null) {
+			return;
+		}
+		boolean keep = false;
+		synchronized (this) {
+			final Integer uses = mUseCount.get(engine);
+			if (!mShutdown && mPolicy == ReleasePolicy.RECYCLE && uses != null && uses < mMaxUses
+					&& mIdle.size() + mPendingWarmups < mSize) {
+				mIdle.addLast(engine);
+				mRecycled++;
+				keep = true;
+			} else {
+				mUseCount.remove(engine);
+				mDiscarded++;
+			}
+		}
+
+		if (!keep) {
+			if (DEBUG) {
+				Log.d(TAG, "Discarding engine " + engine);
+			}
+			engine.shutdown();
+			fill();
+		}
+	}
+
+	/**
+	 * Shut down all idle engines and stop warming up new ones. Engines that are currently acquired
+	 * are shut down when they are released.
+	 */
+	public void shutdown() {
+		final V8Engine[] idle;
+		synchronized (this) {
+			mShutdown = true;
+			idle = mIdle.toArray(new V8Engine[mIdle.size()]);
+			mIdle.clear();
+			for (V8Engine engine : idle) {
+				mUseCount.remove(engine);
+			}
+		}
+		mWarmupExecutor.shutdownNow();
+		for (V8Engine engine : idle) {
+			engine.shutdown();
+		}
+	}
+
+	/**
+	 * @return a snapshot of the pool metrics
+	 */
+	public synchronized Stats getStats() {
+		return new Stats(mHits, mMisses, mRecycled, mDiscarded, mWarmedUp, mTotalWarmupMs, mLastWarmupMs, mIdle.size());
+	}
+
+	/**
+	 * schedule as many warm-ups as are needed to bring the pool back to its target size
+	 */
+	private void fill() {
+		synchronized (this) {
+			while (!mShutdown && mIdle.size() + mPendingWarmups < mSize) {
+				mPendingWarmups++;
+				mWarmupExecutor.execute(mWarmupRunnable);
+			}
+		}
+	}
+
+	private final Runnable mWarmupRunnable = new Runnable() {
+		@Override
+		public void run() {
+			final long start = SystemClock.elapsedRealtime();
+			V8Engine engine = null;
+			boolean ready = false;
+			try {
+				engine = new V8Engine(mApplication, mScriptPath, mPreloadModules);
+
+				// warm-ups run one at a time so they do not compete with each other for the CPU
+				final CountDownLatch latch = new CountDownLatch(1);
+				engine.addStatusHandler(new V8Engine.V8EngineHandler() {
+					@Override
+					public void onReady() {
+						latch.countDown();
+					}
+				});
+				ready = latch.await(WARMUP_TIMEOUT_MS, TimeUnit.MILLISECONDS);
+			} catch (InterruptedException e) {
+				Thread.currentThread().interrupt();
+			} catch (Exception e) {
+				Log.e(TAG, "Cannot warm up engine", e);
+			}
+
+			final long duration = SystemClock.elapsedRealtime() - start;
+			boolean keep = false;
+			synchronized (V8EnginePool.this) {
+				mPendingWarmups--;
+				if (ready && !mShutdown) {
+					mIdle.addLast(engine);
+					mWarmedUp++;
+					mTotalWarmupMs += duration;
+					mLastWarmupMs = duration;
+					keep = true;
+				}
+			}
+
+			if (DEBUG) {
+				Log.d(TAG, "Engine warm-up " + (keep ? "finished" : "failed") + " after " + duration + "ms");
+			}
+			if (!keep && engine != null) {
+				engine.shutdown();
+			}
+		}
+	};
+}
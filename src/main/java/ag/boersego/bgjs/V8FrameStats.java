@@ -0,0 +1,107 @@
+package ag.boersego.bgjs;
+
+/**
+ * V8FrameStats
+ * Snapshot of the frame scheduler accounting of an engine: how much time was spent on each class of work
+ * and how often work was deferred to keep animation frames on time.
+ * Also reports the queue of java references that the garbage collector released and that are freed in batches
+ * as idle work, and the native memory held by canvas resources.
+ *
+ * Copyright 2014 Kevin Read <me@kevin-read.com> and BörseGo AG (https://github.com/godmodelabs/ejecta-v8/)
+ *
+ **/
+
+public class V8FrameStats {
+	/**
+	 * Classes of work, in the order used by the native scheduler
+	 */
+	public static final int INPUT = 0;
+	public static final int ANIMATION_FRAME = 1;
+	public static final int MICROTASK = 2;
+	public static final int TIMER = 3;
+	public static final int NETWORK = 4;
+	public static final int IDLE = 5;
+	public static final int NUM_CLASSES = 6;
+
+	private static final int FINALIZATION_OFFSET = 2 + NUM_CLASSES * 4;
+	private static final int MEMORY_OFFSET = FINALIZATION_OFFSET + 4;
+	static final int SIZE = MEMORY_OFFSET + 3;
+
+	/**
+	 * number of frames started so far
+	 */
+	public final long frames;
+	/**
+	 * estimated interval between two frames
+	 */
+	public final double frameIntervalMs;
+	/**
+	 * time spent per class of work during the last completed frame
+	 */
+	public final double[] lastFrameMs = new double[NUM_CLASSES];
+	/**
+	 * number of deferrals per class of work during the last completed frame
+	 */
+	public final int[] lastFrameDeferred = new int[NUM_CLASSES];
+	/**
+	 * time spent per class of work over all completed frames
+	 */
+	public final double[] totalMs = new double[NUM_CLASSES];
+	/**
+	 * number of deferrals per class of work over all completed frames
+	 */
+	public final long[] totalDeferred = new long[NUM_CLASSES];
+	/**
+	 * number of references currently waiting to be released
+	 */
+	public final int finalizationQueueDepth;
+	/**
+	 * highest number of references that were waiting at the same time
+	 */
+	public final int finalizationQueuePeak;
+	/**
+	 * number of references queued / released since the engine was created
+	 */
+	public final long finalizationsEnqueued;
+	public final long finalizationsReleased;
+	/**
+	 * bytes currently held by textures, image data and fonts of the canvases of this engine
+	 * these are reported to the garbage collector of its isolate as external memory
+	 */
+	public final long textureBytes;
+	public final long imageDataBytes;
+	public final long fontBytes;
+
+	V8FrameStats(final double[] data) {
+		frames = (long) data[0];
+		frameIntervalMs = data[1];
+		for (int i = 0; i < NUM_CLASSES; i++) {
+			lastFrameMs[i] = data[2 + i];
+			lastFrameDeferred[i] = (int) data[2 + NUM_CLASSES + i];
+			totalMs[i] = data[2 + NUM_CLASSES * 2 + i];
+			totalDeferred[i] = (long) data[2 + NUM_CLASSES * 3 + i];
+		}
+		finalizationQueueDepth = (int) data[FINALIZATION_OFFSET];
+		finalizationQueuePeak = (int) data[FINALIZATION_OFFSET + 1];
+		finalizationsEnqueued = (long) data[FINALIZATION_OFFSET + 2];
+		finalizationsReleased = (long) data[FINALIZATION_OFFSET + 3];
+		textureBytes = (long) data[MEMORY_OFFSET];
+		imageDataBytes = (long) data[MEMORY_OFFSET + 1];
+		fontBytes = (long) data[MEMORY_OFFSET + 2];
+	}
+
+	@Override
+	public String toString() {
+		final StringBuilder sb = new StringBuilder("V8FrameStats{frames=").append(frames)
+				.append(", intervalMs=").append(frameIntervalMs);
+		final String[] names = {"input", "raf", "microtask", "timer", "network", "idle"};
+		for (int i = 0; i < NUM_CLASSES; i++) {
+			sb.append(", ").append(names[i]).append("=").append(lastFrameMs[i]).append("ms/")
+					.append(lastFrameDeferred[i]).append(" deferred");
+		}
+		sb.append(", finalizationQueue=").append(finalizationQueueDepth).append("/").append(finalizationQueuePeak).append(" peak")
+				.append(", textures=").append(textureBytes).append("b, imageData=").append(imageDataBytes)
+				.append("b, fonts=").append(fontBytes).append("b");
+		return sb.append("}").toString();
+	}
+}
@@ -0,0 +1,36 @@
+package ag.boersego.bgjs;
+
+import android.support.annotation.NonNull;
+
+/**
+ * A property name that was converted to an internalized javascript string once and can be used for any number of
+ * field accesses and method calls afterwards.
+ *
+ * Use it instead of a String when the same field is accessed in a hot loop, e.g. reading "open", "close" and "time"
+ * from thousands of quote objects. Keys are created with V8Engine.getV8Key and can only be used with objects of the
+ * engine that created them. They stay valid for the lifetime of the engine.
+ */
+final public class V8Key {
+    private final V8Engine engine;
+    private final String name;
+    final int index;
+
+    V8Key(@NonNull V8Engine engine, @NonNull String name, int index) {
+        this.engine = engine;
+        this.name = name;
+        this.index = index;
+    }
+
+    public @NonNull V8Engine getV8Engine() {
+        return engine;
+    }
+
+    public @NonNull String getName() {
+        return name;
+    }
+
+    @Override
+    public String toString() {
+        return name;
+    }
+}
@@ -55,6 +55,7 @@ abstract public class V8TextureView extends TextureView implements TextureView.S
     private int[] mEglVersion;
     private float mClearRed, mClearGreen, mClearBlue, mClearAlpha;
     private boolean mClearColorSet;
+    private V8Engine mEngine;
 
     /**
 	 * Create a new V8TextureView instance
@@ -77,6 +78,22 @@ abstract public class V8TextureView extends TextureView implements TextureView.S
         DEBUG = debug;
     }
 
+	/**
+	 * Render this view with a specific engine, e.g. one acquired from a {@link V8EnginePool}.
+	 * Must be called before the surface is created. If never called, the default engine is used.
+	 * @param engine the engine to render with
+	 */
+	public void setEngine(final V8Engine engine) {
+		mEngine = engine;
+	}
+
+	/**
+	 * @return the engine this view renders with
+	 */
+	public V8Engine getEngine() {
+		return mEngine != null ? mEngine : V8Engine.getInstance();
+	}
+
     abstract public void onGLCreated (long jsId);
 
     abstract public void onGLRecreated (long jsId);
@@ -169,7 +186,7 @@ abstract public class V8TextureView extends TextureView implements TextureView.S
 							+ (mTouches[0].y - mTouches[1].y) * (mTouches[0].y - mTouches[1].y));
 				}
 				mNumTouches = count;
-				V8Engine engine = V8Engine.getInstance();
+				V8Engine engine = getEngine();
 				if (engine == null || mRenderThread == null) {
 					return false;
 				}
@@ -208,7 +225,7 @@ abstract public class V8TextureView extends TextureView implements TextureView.S
 					}
 					
 					if (touchDirty) {
-						ClientAndroid.setTouchPosition(V8Engine.getInstance(), mRenderThread.mJSId, (int)mTouches[id].x, (int)mTouches[id].y);
+						ClientAndroid.setTouchPosition(getEngine(), mRenderThread.mJSId, (int)mTouches[id].x, (int)mTouches[id].y);
 					}
 				}
 			}
@@ -288,7 +305,7 @@ abstract public class V8TextureView extends TextureView implements TextureView.S
 					+ scale);
 		}
 		// Call JNI function that calls V8
-		ClientAndroid.sendTouchEvent(V8Engine.getInstance(), mRenderThread.mJSId, type, x, y,
+		ClientAndroid.sendTouchEvent(getEngine(), mRenderThread.mJSId, type, x, y,
 				(float) scale);
 	}
 
@@ -550,7 +567,7 @@ abstract public class V8TextureView extends TextureView implements TextureView.S
      * @return pointer to JNI object
      */
     protected long createGL () {
-        return ClientAndroid.createGL(V8Engine.getInstance(), this, mScaling, false, getMeasuredWidth(), getMeasuredHeight());
+        return ClientAndroid.createGL(getEngine(), this, mScaling, false, getMeasuredWidth(), getMeasuredHeight());
     }
 
 	/**
@@ -734,7 +751,7 @@ abstract public class V8TextureView extends TextureView implements TextureView.S
                     GLES10.glClearColor(mClearRed, mClearGreen, mClearBlue, mClearAlpha);
                 }
 
-				final boolean didDraw = ClientAndroid.step(V8Engine.getInstance(), mJSId);
+				final boolean didDraw = ClientAndroid.step(getEngine(), mJSId);
 
                 /* if (DEBUG) {
                     Log.d(TAG, "Draw for JSID " + String.format("0x%8s", Long.toHexString(mJSId)).replace(' ', '0') + ", TV " + V8TextureView.this);
@@ -803,7 +820,7 @@ abstract public class V8TextureView extends TextureView implements TextureView.S
 			}
 
 			if (mJSId != 0) {
-				ClientAndroid.close(V8Engine.getInstance(), mJSId);
+				ClientAndroid.close(getEngine(), mJSId);
 			}
 
 			finishGL();
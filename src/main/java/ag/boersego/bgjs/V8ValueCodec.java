@@ -0,0 +1,557 @@
+package ag.boersego.bgjs;
+
+import android.support.annotation.NonNull;
+import android.support.annotation.Nullable;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.Charset;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.Date;
+import java.util.IdentityHashMap;
+import java.util.LinkedHashMap;
+import java.util.LinkedHashSet;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+
+/**
+ * Converts java values to and from the binary format of v8::ValueSerializer, the format javascript uses for
+ * structured cloning.
+ *
+ * A whole object graph moves between java and javascript as a single byte array instead of one JNI call per field:
+ * - java to javascript: V8Engine.deserialize(V8ValueCodec.encode(value)) or JNIV8Object.setV8FieldsDeep
+ * - javascript to java: V8ValueCodec.decode(object.serialize()) or JNIV8Object.getV8FieldsDeep
+ *
+ * Supported java types are null, JNIV8Undefined, Boolean, Number, Character, String, Map (a plain javascript object),
+ * List and Object[] (arrays) and byte[] (ArrayBuffer). Objects referenced more than once, including cycles, keep their
+ * identity.
+ *
+ * Decoding returns plain java values that are independent of the engine: numbers are returned as Double, objects as
+ * LinkedHashMap, arrays as ArrayList, Map and Set as LinkedHashMap and LinkedHashSet, Date as Date, ArrayBuffers and
+ * typed arrays as byte[] holding their memory, and undefined (including array holes) as JNIV8Undefined.
+ */
+final public class V8ValueCodec {
+    // version written by the encoder: one-byte strings, holes separated from undefined
+    private static final int VERSION = 11;
+    // highest version the decoder understands
+    private static final int MAX_VERSION = 13;
+
+    private static final byte TAG_VERSION = (byte) 0xFF;
+    private static final byte TAG_PADDING = '\0';
+    private static final byte TAG_VERIFY_OBJECT_COUNT = '?';
+    private static final byte TAG_THE_HOLE = '-';
+    private static final byte TAG_UNDEFINED = '_';
+    private static final byte TAG_NULL = '0';
+    private static final byte TAG_TRUE = 'T';
+    private static final byte TAG_FALSE = 'F';
+    private static final byte TAG_INT32 = 'I';
+    private static final byte TAG_UINT32 = 'U';
+    private static final byte TAG_DOUBLE = 'N';
+    private static final byte TAG_UTF8_STRING = 'S';
+    private static final byte TAG_ONE_BYTE_STRING = '"';
+    private static final byte TAG_TWO_BYTE_STRING = 'c';
+    private static final byte TAG_OBJECT_REFERENCE = '^';
+    private static final byte TAG_BEGIN_JS_OBJECT = 'o';
+    private static final byte TAG_END_JS_OBJECT = '{';
+    private static final byte TAG_BEGIN_SPARSE_JS_ARRAY = 'a';
+    private static final byte TAG_END_SPARSE_JS_ARRAY = '@';
+    private static final byte TAG_BEGIN_DENSE_JS_ARRAY = 'A';
+    private static final byte TAG_END_DENSE_JS_ARRAY = '$';
+    private static final byte TAG_DATE = 'D';
+    private static final byte TAG_TRUE_OBJECT = 'y';
+    private static final byte TAG_FALSE_OBJECT = 'x';
+    private static final byte TAG_NUMBER_OBJECT = 'n';
+    private static final byte TAG_STRING_OBJECT = 's';
+    private static final byte TAG_BEGIN_JS_MAP = ';';
+    private static final byte TAG_END_JS_MAP = ':';
+    private static final byte TAG_BEGIN_JS_SET = '\'';
+    private static final byte TAG_END_JS_SET = ',';
+    private static final byte TAG_ARRAY_BUFFER = 'B';
+    private static final byte TAG_ARRAY_BUFFER_VIEW = 'V';
+
+    // sparse arrays are expanded to lists; longer ones are most likely not meant to be converted
+    private static final int MAX_SPARSE_ARRAY_LENGTH = 1 << 24;
+
+    private static final Charset UTF8 = Charset.forName("UTF-8");
+
+    private V8ValueCodec() {}
+
+    /**
+     * serializes a java value
+     * @throws IllegalArgumentException if the value contains an unsupported type
+     */
+    public static @NonNull byte[] encode(@Nullable Object value) {
+        final Encoder encoder = new Encoder();
+        encoder.writeByte(TAG_VERSION);
+        encoder.writeVarint(VERSION);
+        encoder.writeValue(value);
+        return encoder.toByteArray();
+    }
+
+    /**
+     * deserializes a value that was serialized by javascript or by encode
+     * @throws IllegalArgumentException if the data is malformed or contains values that have no java representation
+     */
+    public static @Nullable Object decode(@NonNull byte[] data) {
+        return decode(ByteBuffer.wrap(data));
+    }
+
+    /**
+     * deserializes the remaining bytes of a buffer; the position of the buffer is not changed
+     * @see #decode(byte[])
+     */
+    public static @Nullable Object decode(@NonNull ByteBuffer data) {
+        final Decoder decoder = new Decoder(data.slice().order(ByteOrder.LITTLE_ENDIAN));
+        try {
+            return decoder.readRoot();
+        } catch (java.nio.BufferUnderflowException | IndexOutOfBoundsException e) {
+            throw new IllegalArgumentException("Serialized data is truncated", e);
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // encoding
+    private static final class Encoder {
+        private byte[] buffer = new byte[256];
+        private int length = 0;
+        private final IdentityHashMap<Object, Integer> ids = new IdentityHashMap<>();
+
+        private void ensure(int count) {
+            if (length + count > buffer.length) {
+                byte[] newBuffer = new byte[Math.max(buffer.length * 2, length + count)];
+                System.arraycopy(buffer, 0, newBuffer, 0, length);
+                buffer = newBuffer;
+            }
+        }
+
+        byte[] toByteArray() {
+            final byte[] result = new byte[length];
+            System.arraycopy(buffer, 0, result, 0, length);
+            return result;
+        }
+
+        void writeByte(byte b) {
+            ensure(1);
+            buffer[length++] = b;
+        }
+
+        void writeVarint(long value) {
+            ensure(10);
+            do {
+                byte b = (byte) (value & 0x7F);
+                value >>>= 7;
+                if (value != 0) b |= 0x80;
+                buffer[length++] = b;
+            } while (value != 0);
+        }
+
+        void writeDouble(double value) {
+            ensure(8);
+            long bits = Double.doubleToRawLongBits(value);
+            for (int i = 0; i < 8; i++) {
+                buffer[length++] = (byte) (bits >>> (i * 8));
+            }
+        }
+
+        void writeString(String value) {
+            final int count = value.length();
+            boolean oneByte = true;
+            for (int i = 0; i < count; i++) {
+                if (value.charAt(i) > 0xFF) {
+                    oneByte = false;
+                    break;
+                }
+            }
+            if (oneByte) {
+                writeByte(TAG_ONE_BYTE_STRING);
+                writeVarint(count);
+                ensure(count);
+                for (int i = 0; i < count; i++) {
+                    buffer[length++] = (byte) value.charAt(i);
+                }
+            } else {
+                writeByte(TAG_TWO_BYTE_STRING);
+                writeVarint(count * 2);
+                ensure(count * 2);
+                for (int i = 0; i < count; i++) {
+                    final char c = value.charAt(i);
+                    buffer[length++] = (byte) c;
+                    buffer[length++] = (byte) (c >>> 8);
+                }
+            }
+        }
+
+        /**
+         * objects get ids in the order they are written; returns false if the object was written before
+         */
+        private boolean writeReference(Object value) {
+            final Integer id = ids.get(value);
+            if (id != null) {
+                writeByte(TAG_OBJECT_REFERENCE);
+                writeVarint(id);
+                return false;
+            }
+            ids.put(value, ids.size());
+            return true;
+        }
+
+        void writeValue(Object value) {
+            if (value == null) {
+                writeByte(TAG_NULL);
+            } else if (value instanceof String) {
+                writeString((String) value);
+            } else if (value instanceof Boolean) {
+                writeByte((Boolean) value ? TAG_TRUE : TAG_FALSE);
+            } else if (value instanceof Integer || value instanceof Short || value instanceof Byte) {
+                final int i = ((Number) value).intValue();
+                writeByte(TAG_INT32);
+                writeVarint(((i << 1) ^ (i >> 31)) & 0xFFFFFFFFL);
+            } else if (value instanceof Number) {
+                writeByte(TAG_DOUBLE);
+                writeDouble(((Number) value).doubleValue());
+            } else if (value instanceof Character) {
+                writeString(value.toString());
+            } else if (value instanceof JNIV8Undefined) {
+                writeByte(TAG_UNDEFINED);
+            } else if (value instanceof Map) {
+                if (!writeReference(value)) return;
+                final Map<?, ?> map = (Map<?, ?>) value;
+                writeByte(TAG_BEGIN_JS_OBJECT);
+                for (Map.Entry<?, ?> entry : map.entrySet()) {
+                    writeString(String.valueOf(entry.getKey()));
+                    writeValue(entry.getValue());
+                }
+                writeByte(TAG_END_JS_OBJECT);
+                writeVarint(map.size());
+            } else if (value instanceof List) {
+                if (!writeReference(value)) return;
+                final List<?> list = (List<?>) value;
+                final int count = list.size();
+                writeByte(TAG_BEGIN_DENSE_JS_ARRAY);
+                writeVarint(count);
+                for (Object element : list) {
+                    writeValue(element);
+                }
+                writeByte(TAG_END_DENSE_JS_ARRAY);
+                writeVarint(0);
+                writeVarint(count);
+            } else if (value instanceof Object[]) {
+                writeArray((Object[]) value);
+            } else if (value instanceof byte[]) {
+                if (!writeReference(value)) return;
+                final byte[] bytes = (byte[]) value;
+                writeByte(TAG_ARRAY_BUFFER);
+                writeVarint(bytes.length);
+                ensure(bytes.length);
+                System.arraycopy(bytes, 0, buffer, length, bytes.length);
+                length += bytes.length;
+            } else {
+                throw new IllegalArgumentException("Type '" + value.getClass().getCanonicalName() + "' can not be serialized");
+            }
+        }
+
+        private void writeArray(Object[] array) {
+            if (!writeReference(array)) return;
+            writeByte(TAG_BEGIN_DENSE_JS_ARRAY);
+            writeVarint(array.length);
+            for (Object element : array) {
+                writeValue(element);
+            }
+            writeByte(TAG_END_DENSE_JS_ARRAY);
+            writeVarint(0);
+            writeVarint(array.length);
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // decoding
+    private static final class Decoder {
+        private final ByteBuffer buffer;
+        private final ArrayList<Object> objects = new ArrayList<>();
+        private int version;
+
+        Decoder(ByteBuffer buffer) {
+            this.buffer = buffer;
+        }
+
+        Object readRoot() {
+            if (buffer.get() != TAG_VERSION) {
+                throw new IllegalArgumentException("Serialized data has no version header");
+            }
+            version = (int) readVarint();
+            if (version > MAX_VERSION) {
+                throw new IllegalArgumentException("Unsupported serialization version " + version);
+            }
+            return readValue();
+        }
+
+        private long readVarint() {
+            long value = 0;
+            int shift = 0;
+            byte b;
+            do {
+                if (shift >= 64) {
+                    throw new IllegalArgumentException("Malformed varint");
+                }
+                b = buffer.get();
+                value |= (long) (b & 0x7F) << shift;
+                shift += 7;
+            } while ((b & 0x80) != 0);
+            return value;
+        }
+
+        private int readLength() {
+            final long value = readVarint();
+            if (value > buffer.remaining()) {
+                throw new IllegalArgumentException("Serialized data is truncated");
+            }
+            return (int) value;
+        }
+
+        private byte readTag() {
+            byte tag;
+            do {
+                tag = buffer.get();
+            } while (tag == TAG_PADDING);
+            return tag;
+        }
+
+        private byte peekTag() {
+            int position = buffer.position();
+            while (buffer.get(position) == TAG_PADDING) {
+                position++;
+            }
+            return buffer.get(position);
+        }
+
+        private void consumeTag(byte expected) {
+            if (readTag() != expected) {
+                throw new IllegalArgumentException("Malformed serialized data");
+            }
+        }
+
+        private int addObject(Object object) {
+            objects.add(object);
+            return objects.size() - 1;
+        }
+
+        private String readOneByteString() {
+            final int count = readLength();
+            final char[] chars = new char[count];
+            for (int i = 0; i < count; i++) {
+                chars[i] = (char) (buffer.get() & 0xFF);
+            }
+            return new String(chars);
+        }
+
+        private String readTwoByteString() {
+            final int byteLength = readLength();
+            if ((byteLength & 1) != 0) {
+                throw new IllegalArgumentException("Malformed two-byte string");
+            }
+            final char[] chars = new char[byteLength / 2];
+            for (int i = 0; i < chars.length; i++) {
+                chars[i] = buffer.getChar();
+            }
+            return new String(chars);
+        }
+
+        private String readUtf8String() {
+            final byte[] bytes = new byte[readLength()];
+            buffer.get(bytes);
+            return new String(bytes, UTF8);
+        }
+
+        /**
+         * property keys are strings or array indices
+         */
+        private String readKey() {
+            final Object key = readValue();
+            if (key instanceof Double) {
+                final double d = (Double) key;
+                if (d == Math.rint(d) && !Double.isInfinite(d)) {
+                    return Long.toString((long) d);
+                }
+            }
+            return String.valueOf(key);
+        }
+
+        Object readValue() {
+            final byte tag = readTag();
+            switch (tag) {
+                case TAG_VERIFY_OBJECT_COUNT:
+                    readVarint();
+                    return readValue();
+                case TAG_UNDEFINED:
+                case TAG_THE_HOLE:
+                    return JNIV8Undefined.GetInstance();
+                case TAG_NULL:
+                    return null;
+                case TAG_TRUE:
+                    return Boolean.TRUE;
+                case TAG_FALSE:
+                    return Boolean.FALSE;
+                case TAG_INT32: {
+                    final int zigzag = (int) readVarint();
+                    return (double) ((zigzag >>> 1) ^ -(zigzag & 1));
+                }
+                case TAG_UINT32:
+                    return (double) (readVarint() & 0xFFFFFFFFL);
+                case TAG_DOUBLE:
+                    return buffer.getDouble();
+                case TAG_UTF8_STRING:
+                    return readUtf8String();
+                case TAG_ONE_BYTE_STRING:
+                    return readOneByteString();
+                case TAG_TWO_BYTE_STRING:
+                    return readTwoByteString();
+                case TAG_OBJECT_REFERENCE: {
+                    final long id = readVarint();
+                    if (id >= objects.size()) {
+                        throw new IllegalArgumentException("Invalid object reference " + id);
+                    }
+                    return objects.get((int) id);
+                }
+                case TAG_BEGIN_JS_OBJECT:
+                    return readObject();
+                case TAG_BEGIN_DENSE_JS_ARRAY:
+                    return readDenseArray();
+                case TAG_BEGIN_SPARSE_JS_ARRAY:
+                    return readSparseArray();
+                case TAG_DATE: {
+                    final Date date = new Date((long) buffer.getDouble());
+                    addObject(date);
+                    return date;
+                }
+                case TAG_TRUE_OBJECT:
+                    addObject(Boolean.TRUE);
+                    return Boolean.TRUE;
+                case TAG_FALSE_OBJECT:
+                    addObject(Boolean.FALSE);
+                    return Boolean.FALSE;
+                case TAG_NUMBER_OBJECT: {
+                    final Double number = buffer.getDouble();
+                    addObject(number);
+                    return number;
+                }
+                case TAG_STRING_OBJECT: {
+                    // the ids of wrapper objects are assigned before their content is read
+                    final int id = addObject(null);
+                    final Object string = version < 12 ? readUtf8String() : readValue();
+                    objects.set(id, string);
+                    return string;
+                }
+                case TAG_BEGIN_JS_MAP:
+                    return readMap();
+                case TAG_BEGIN_JS_SET:
+                    return readSet();
+                case TAG_ARRAY_BUFFER:
+                    return readArrayBuffer();
+                default:
+                    throw new IllegalArgumentException("Unsupported serialization tag '" + (char) tag + "'");
+            }
+        }
+
+        private Map<String, Object> readObject() {
+            final LinkedHashMap<String, Object> map = new LinkedHashMap<>();
+            addObject(map);
+            while (peekTag() != TAG_END_JS_OBJECT) {
+                final String key = readKey();
+                map.put(key, readValue());
+            }
+            consumeTag(TAG_END_JS_OBJECT);
+            readVarint();
+            return map;
+        }
+
+        private List<Object> readDenseArray() {
+            final int count = readLength();
+            final ArrayList<Object> list = new ArrayList<>(count);
+            addObject(list);
+            for (int i = 0; i < count; i++) {
+                list.add(readValue());
+            }
+            // named properties of arrays have no java representation
+            while (peekTag() != TAG_END_DENSE_JS_ARRAY) {
+                readKey();
+                readValue();
+            }
+            consumeTag(TAG_END_DENSE_JS_ARRAY);
+            readVarint();
+            readVarint();
+            return list;
+        }
+
+        private List<Object> readSparseArray() {
+            final long count = readVarint();
+            if (count > MAX_SPARSE_ARRAY_LENGTH) {
+                throw new IllegalArgumentException("Sparse array of length " + count + " is too long to be converted");
+            }
+            final ArrayList<Object> list = new ArrayList<>(Collections.nCopies((int) count, (Object) JNIV8Undefined.GetInstance()));
+            addObject(list);
+            while (peekTag() != TAG_END_SPARSE_JS_ARRAY) {
+                final String key = readKey();
+                final Object value = readValue();
+                try {
+                    final long index = Long.parseLong(key);
+                    if (index >= 0 && index < count) {
+                        list.set((int) index, value);
+                    }
+                } catch (NumberFormatException e) {
+                    // named property
+                }
+            }
+            consumeTag(TAG_END_SPARSE_JS_ARRAY);
+            readVarint();
+            readVarint();
+            return list;
+        }
+
+        private Map<Object, Object> readMap() {
+            final LinkedHashMap<Object, Object> map = new LinkedHashMap<>();
+            addObject(map);
+            while (peekTag() != TAG_END_JS_MAP) {
+                final Object key = readValue();
+                map.put(key, readValue());
+            }
+            consumeTag(TAG_END_JS_MAP);
+            readVarint();
+            return map;
+        }
+
+        private Set<Object> readSet() {
+            final LinkedHashSet<Object> set = new LinkedHashSet<>();
+            addObject(set);
+            while (peekTag() != TAG_END_JS_SET) {
+                set.add(readValue());
+            }
+            consumeTag(TAG_END_JS_SET);
+            readVarint();
+            return set;
+        }
+
+        private byte[] readArrayBuffer() {
+            final byte[] bytes = new byte[readLength()];
+            buffer.get(bytes);
+            addObject(bytes);
+
+            // typed arrays and DataViews are written as their buffer followed by the view
+            if (buffer.hasRemaining() && peekTag() == TAG_ARRAY_BUFFER_VIEW) {
+                consumeTag(TAG_ARRAY_BUFFER_VIEW);
+                buffer.get(); // view type
+                final long viewOffset = readVarint();
+                final long viewLength = readVarint();
+                if (viewOffset + viewLength > bytes.length) {
+                    throw new IllegalArgumentException("Malformed ArrayBuffer view");
+                }
+                final byte[] view = new byte[(int) viewLength];
+                System.arraycopy(bytes, (int) viewOffset, view, 0, view.length);
+                addObject(view);
+                return view;
+            }
+            return bytes;
+        }
+    }
+}
@@ -163,6 +163,19 @@ public final class V8AnnotationProcessor extends AbstractProcessor {
                 property = methodName;
             }
             boolean isStatic = e.getModifiers().contains(Modifier.STATIC);
+            boolean isAsync = e.getAnnotation(V8Function.class).async();
+
+            // the jni signature is resolved here so that the runtime does not have to assemble it
+            StringBuilder signature = new StringBuilder("(");
+            if (functionHolder.params != null) {
+                for (final AnnotatedFunctionParamHolder paramHolder : functionHolder.params) {
+                    signature.append(paramHolder.type);
+                }
+            } else {
+                signature.append("[Ljava/lang/Object;");
+            }
+            signature.append(")").append(functionHolder.returnType);
+
             builder.append("\t\t\t").append(index++ == 0 ? "" : ",")
                     .append("new V8FunctionInfo(\"")
                     .append(property)
@@ -170,8 +183,12 @@ public final class V8AnnotationProcessor extends AbstractProcessor {
                     .append(methodName)
                     .append("\", \"")
                     .append(functionHolder.returnType)
+                    .append("\", \"")
+                    .append(signature)
                     .append("\", ")
-                    .append(isStatic ? "true" : "false");
+                    .append(isStatic ? "true" : "false")
+                    .append(", ")
+                    .append(isAsync ? "true" : "false");
 
             if(functionHolder.params != null) {
                 builder.append(", new V8FunctionInfo.V8FunctionArgumentInfo[] {");
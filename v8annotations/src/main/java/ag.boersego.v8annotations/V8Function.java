@@ -10,4 +10,11 @@ import java.lang.annotation.Target;
 @Target(ElementType.METHOD)
 public @interface V8Function {
     String property() default "";
+
+    /**
+     * run the method on a background executor instead of the JS thread
+     * the JS function returns a Promise that is resolved with the return value or rejected with the thrown exception
+     * arguments are converted on the JS thread before the call; the method must not expect to run on the engine thread
+     */
+    boolean async() default false;
 }
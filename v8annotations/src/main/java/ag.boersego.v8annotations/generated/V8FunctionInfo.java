@@ -8,7 +8,10 @@ public class V8FunctionInfo {
     public String method;
     public String property;
     public boolean isStatic;
+    public boolean isAsync;
     public String returnType;
+    // jni signature of the method; null for bindings generated by older versions of the annotation processor
+    public String signature;
     public V8FunctionArgumentInfo[] arguments;
 
     public V8FunctionInfo(String property, String method, String returnType, boolean isStatic, V8FunctionArgumentInfo[] args) {
@@ -19,6 +22,16 @@ public class V8FunctionInfo {
         this.arguments = args;
     }
 
+    public V8FunctionInfo(String property, String method, String returnType, boolean isStatic, boolean isAsync, V8FunctionArgumentInfo[] args) {
+        this(property, method, returnType, isStatic, args);
+        this.isAsync = isAsync;
+    }
+
+    public V8FunctionInfo(String property, String method, String returnType, String signature, boolean isStatic, boolean isAsync, V8FunctionArgumentInfo[] args) {
+        this(property, method, returnType, isStatic, isAsync, args);
+        this.signature = signature;
+    }
+
     public static class V8FunctionArgumentInfo {
         public String type;
         public boolean isNullable;